@@ -1,7 +1,32 @@
 ﻿#include "AttachablePart.h"
+#include "RobotAbuse.h"
+#include "AttachmentJournal.h"
 #include "AttachmentPoint.h"
+#include "RobotAttachmentState.h"
+#include "RobotEventBus.h"
+#include "RobotFleetRenderer.h"
+#include "RobotHighlight.h"
 #include "Components/StaticMeshComponent.h"
-#include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
+#define LOCTEXT_NAMESPACE "AttachablePart"
+
+static TAutoConsoleVariable<bool> CVarRobotPhysicsDrop(
+    TEXT("robot.Physics.Drop"),
+    true,
+    TEXT("Dropped parts fall and settle under physics instead of staying where they were let go."));
+
+static TAutoConsoleVariable<float> CVarRobotPhysicsMaxFallTime(
+    TEXT("robot.Physics.MaxFallTime"),
+    5.0f,
+    TEXT("Seconds a dropped part may simulate before it is made kinematic even if it has not gone to sleep."));
+
+static TAutoConsoleVariable<float> CVarRobotPhysicsSleepCheckInterval(
+    TEXT("robot.Physics.SleepCheckInterval"),
+    0.2f,
+    TEXT("Seconds between checks whether a falling part's body went to sleep, in case the sleep event is not delivered."));
 
 AAttachablePart::AAttachablePart()
 {
@@ -13,7 +38,22 @@ AAttachablePart::AAttachablePart()
     MeshComponent->SetSimulatePhysics(false);
     MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
 
+    // Parts only simulate between a drop and coming to rest. A high sleep threshold and some damping
+    // let a pile of dropped parts go to sleep quickly, and the sleep event makes them kinematic again
+    FBodyInstance* Body = MeshComponent->GetBodyInstance();
+    Body->SleepFamily = ESleepFamily::Custom;
+    Body->CustomSleepThresholdMultiplier = 4.0f;
+    Body->LinearDamping = 0.2f;
+    Body->AngularDamping = 1.0f;
+    Body->bGenerateWakeEvents = true;
+
     CurrentState = EPartState::DETACHED;
+
+    // Multi-user sessions: parts must be net-addressable, their state replicates through ARobotAttachmentState.
+    // Relevant to whoever holds them, with their robot when attached and by distance when loose, see RecordPart
+    bReplicates = true;
+    bNetUseOwnerRelevancy = true;
+    SetReplicatingMovement(false);
 }
 
 void AAttachablePart::BeginPlay()
@@ -24,35 +64,50 @@ void AAttachablePart::BeginPlay()
     
     // Set initial emissive
     SetEmissive(NormalEmissive);
+
+    MeshComponent->OnComponentSleep.AddDynamic(this, &AAttachablePart::HandleBodySleep);
+
+    // Parts prewarmed into the pool join the registry when they are handed out
+    if (bPooled)
+    {
+        return;
+    }
+
+    if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+    {
+        Registry->RegisterPart(this);
+    }
+
+    // Initial arms are attached before our BeginPlay, they could not be instanced yet
+    TryDemoteToFleet();
 }
 
-//TODO Would like to add a separate component to handle highlight and make it more flexible
-void AAttachablePart::SetupMaterials()
+void AAttachablePart::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    DynamicMaterials.Empty();
-    
-    // Get all mesh components in this actor (including children)
-    TArray<UStaticMeshComponent*> MeshComponents;
-    GetComponents<UStaticMeshComponent>(MeshComponents);
-    
-    // Create dynamic material instances for each mesh
-    for (UStaticMeshComponent* Mesh : MeshComponents)
+    PromoteFromFleet();
+    StopFalling();
+
+    if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
     {
-        if (Mesh)
+        Registry->UnregisterPart(this);
+    }
+
+    if (HasAuthority())
+    {
+        if (ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld()))
         {
-            // For each material slot on this mesh
-            for (int32 i = 0; i < Mesh->GetNumMaterials(); i++)
-            {
-                UMaterialInterface* BaseMat = Mesh->GetMaterial(i);
-                if (BaseMat)
-                {
-                    UMaterialInstanceDynamic* DynMat = UMaterialInstanceDynamic::Create(BaseMat, this);
-                    Mesh->SetMaterial(i, DynMat);
-                    DynamicMaterials.Add(DynMat);
-                }
-            }
+            NetState->RemovePart(this);
         }
     }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AAttachablePart::SetupMaterials()
+{
+    // Highlighting goes through custom primitive data, the meshes keep their shared materials
+    RobotHighlight::CollectMeshes(this, EmissiveParameterName, HighlightMeshes);
+    CurrentEmissive = -1.0f;
 }
 
 void AAttachablePart::OnHoverBegin_Implementation()
@@ -69,10 +124,15 @@ void AAttachablePart::OnHoverEnd_Implementation()
     {
         SetEmissive(NormalEmissive);
     }
+
+    TryDemoteToFleet();
 }
 
 void AAttachablePart::OnClicked_Implementation()
 {
+    // Taking an arm off and picking it up undo together, with the drop or attach that follows
+    FAttachmentJournalScope JournalStep(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()));
+
     // When clicked, pick ourselves up
     if (CurrentState == EPartState::DETACHED)
     {
@@ -95,18 +155,21 @@ bool AAttachablePart::TryAttachTo_Implementation(UAttachmentPoint* Point)
     // Validate inputs
     if (!Point)
     {
-        UE_LOG(LogTemp, Warning, TEXT("TryAttachTo called with null point"));
+        UE_LOG(LogRobotAbuse, Warning, TEXT("TryAttachTo called with null point"));
         return false;
     }
     
     // Check if this part can attach to this point (type compatibility)
     if (!Point->CanAcceptPart(this))
     {
-        UE_LOG(LogTemp, Warning, TEXT("%s cannot attach to %s - wrong type"), 
+        UE_LOG(LogRobotAbuse, Warning, TEXT("%s cannot attach to %s - wrong type"), 
                *GetName(), *Point->GetName());
         return false;
     }
     
+    // Moving between sockets is one undo step
+    FAttachmentJournalScope JournalStep(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()));
+
     // Detach from current point if attached elsewhere
     if (CurrentAttachmentPoint)
     {
@@ -117,7 +180,7 @@ bool AAttachablePart::TryAttachTo_Implementation(UAttachmentPoint* Point)
     Point->AttachPart(this);      // Tell point it has a part
     AttachToPoint(Point);          // Attach ourselves to the point
     
-    UE_LOG(LogTemp, Log, TEXT("Successfully attached %s to %s"), 
+    UE_LOG(LogRobotAbuse, Verbose, TEXT("Successfully attached %s to %s"), 
            *GetName(), *Point->GetName());
     
     return true;
@@ -125,31 +188,218 @@ bool AAttachablePart::TryAttachTo_Implementation(UAttachmentPoint* Point)
 
 void AAttachablePart::PickUp()
 {
+    const FAttachmentJournalState Before(this);
+
+    PromoteFromFleet();
+    StopFalling();
     CurrentState = EPartState::HELD;
+    SetHeldMovement(true);
     SetEmissive(HighlightEmissive);
+    RecordNetState();
+    RecordJournal(EAttachmentJournalOp::PickUp, Before);
+    PostStateChanged();
 }
 
 void AAttachablePart::Drop()
 {
+    LetGo();
+    StartFalling();
+}
+
+void AAttachablePart::PlaceAt(const FVector& Location)
+{
+    // Restores put a part back where it was lying, it came to rest there already and does not fall again
+    StopFalling();
+    SetActorLocation(Location, false, nullptr, ETeleportType::ResetPhysics);
+
+    if (IsHeld())
+    {
+        LetGo();
+    }
+}
+
+void AAttachablePart::LetGo()
+{
+    const FAttachmentJournalState Before(this);
+
     CurrentState = EPartState::DETACHED;
+    SetHeldMovement(false);
     SetEmissive(NormalEmissive);
+    RecordNetState();
+    RecordJournal(EAttachmentJournalOp::Drop, Before);
+    PostStateChanged();
+}
+
+void AAttachablePart::StartFalling()
+{
+    if (bFalling || bPooled || !HasAuthority() || !CVarRobotPhysicsDrop.GetValueOnGameThread())
+    {
+        return;
+    }
+
+    UWorld* World = GetWorld();
+    if (!World || !World->GetPhysicsScene() || !MeshComponent->IsPhysicsStateCreated())
+    {
+        return;
+    }
+
+    MeshComponent->SetSimulatePhysics(true);
+
+    // Meshes without collision have no body to simulate
+    if (!MeshComponent->IsSimulatingPhysics())
+    {
+        return;
+    }
+
+    bFalling = true;
+    FallStartTime = World->GetTimeSeconds();
+    INC_DWORD_STAT(STAT_RobotFallingParts);
+    ROBOT_CSV_COUNT(Drops);
+
+    World->GetTimerManager().SetTimer(FallCheckHandle, FTimerDelegate::CreateUObject(this, &AAttachablePart::CheckFall),
+        FMath::Max(CVarRobotPhysicsSleepCheckInterval.GetValueOnGameThread(), 0.01f), true);
+}
+
+void AAttachablePart::CheckFall()
+{
+    // The sleep event is dispatched from the physics results, with bTickPhysicsAsync it is not guaranteed
+    // to reach us, so the body is polled as well. A part that never comes to rest, e.g. off the edge of
+    // the floor, is stopped anyway
+    const UWorld* World = GetWorld();
+    if (!MeshComponent->RigidBodyIsAwake() || !World
+        || World->GetTimeSeconds() - FallStartTime >= CVarRobotPhysicsMaxFallTime.GetValueOnGameThread())
+    {
+        SettleAfterFall();
+    }
+}
+
+void AAttachablePart::StopFalling()
+{
+    if (!bFalling)
+    {
+        return;
+    }
+
+    bFalling = false;
+    DEC_DWORD_STAT(STAT_RobotFallingParts);
+
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearTimer(FallCheckHandle);
+    }
+
+    MeshComponent->SetSimulatePhysics(false);
+}
+
+void AAttachablePart::SettleAfterFall()
+{
+    if (!bFalling)
+    {
+        return;
+    }
+
+    StopFalling();
+
+    // Where it came to rest is the loose location clients should see, and the one undo and redo put it back to
+    RecordNetState();
+    if (HasAuthority())
+    {
+        if (UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()))
+        {
+            Journal->AmendRest(this);
+        }
+    }
+}
+
+void AAttachablePart::HandleBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+    SettleAfterFall();
+}
+
+void AAttachablePart::RecordNetState()
+{
+    // Only the server writes session state, clients get theirs replicated. Standalone games have none
+    if (HasAuthority())
+    {
+        if (ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld()))
+        {
+            NetState->RecordPart(this);
+        }
+    }
+}
+
+void AAttachablePart::RecordJournal(EAttachmentJournalOp Op, const FAttachmentJournalState& Before)
+{
+    // History is kept where the change is authoritative, an undo on the server replicates like any other change
+    if (HasAuthority())
+    {
+        if (UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()))
+        {
+            Journal->Record(Op, this, Before);
+        }
+    }
+}
+
+void AAttachablePart::PostStateChanged()
+{
+    // Socket moves reach the bus through the registry, pickups and drops do not
+    if (URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(GetWorld()))
+    {
+        EventBus->Post(ERobotEventType::StateChanged, this);
+    }
+}
+
+void AAttachablePart::SetHeldMovement(bool bHeld)
+{
+    // Nothing listens for part overlaps, so a held part skips the overlap update on every drag move
+    if (bHeld)
+    {
+        bOverlapsBeforeHeld = MeshComponent->GetGenerateOverlapEvents();
+        MeshComponent->SetGenerateOverlapEvents(false);
+    }
+    else if (bOverlapsBeforeHeld)
+    {
+        MeshComponent->SetGenerateOverlapEvents(true);
+        bOverlapsBeforeHeld = false;
+    }
 }
 
 void AAttachablePart::AttachToPoint(UAttachmentPoint* Point)
 {
+    ROBOT_TRACE_SCOPE("RobotAbuse::Attach");
+    ROBOT_CSV_COUNT(Attaches);
+
+    const FAttachmentJournalState Before(this);
+
+    // A simulating root would not follow the socket
+    StopFalling();
+
     CurrentAttachmentPoint = Point;
     CurrentState = EPartState::ATTACHED;
+    SetHeldMovement(false);
     
-    // Snap to attachment point location
-    AttachToComponent(Point, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
-    SetActorLocation(Point->GetComponentLocation());
+    // Snap to attachment point location. The snap already places us on the point, and the scoped
+    // update folds the attach into a single transform/overlap update for the whole part
+    {
+        FScopedMovementUpdate ScopedMovement(GetRootComponent(), EScopedUpdate::DeferredUpdates);
+        AttachToComponent(Point, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+    }
     
     // Turn off highlight
     SetEmissive(NormalEmissive);
+    RecordNetState();
+    RecordJournal(EAttachmentJournalOp::Attach, Before);
+
+    TryDemoteToFleet();
 }
 
 void AAttachablePart::DetachFromPoint()
 {
+    ROBOT_TRACE_SCOPE("RobotAbuse::Detach");
+
+    const FAttachmentJournalState Before(this);
+
+    PromoteFromFleet();
     DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
     
     if (CurrentAttachmentPoint)
@@ -159,27 +409,143 @@ void AAttachablePart::DetachFromPoint()
     }
     
     CurrentState = EPartState::DETACHED;
+    RecordNetState();
+    RecordJournal(EAttachmentJournalOp::Detach, Before);
+}
+
+
+const FText& AAttachablePart::GetStateDisplayText(EPartState State)
+{
+    static const FText Attached = LOCTEXT("StateAttached", "Attached");
+    static const FText Held = LOCTEXT("StateHeld", "Being Dragged");
+    static const FText Detached = LOCTEXT("StateDetached", "Detached");
+
+    switch (State)
+    {
+    case EPartState::ATTACHED: return Attached;
+    case EPartState::HELD: return Held;
+    default: return Detached;
+    }
 }
 
+FPartCategoryMask AAttachablePart::GetCategoryMask() const
+{
+    if (Categories.Num() == 0)
+    {
+        return RobotPartCategories::PartMaskFromArmType(ArmType);
+    }
+
+    return CategoryCache.Get(Categories);
+}
 
 void AAttachablePart::UpdateDragPosition_Implementation(const FVector& WorldPosition)
 {
     //Added offset to handle offset on mesh but did not get a chance to configure well
     if (CurrentState == EPartState::HELD)
     {
-        SetActorLocation(WorldPosition + HeldOffset);
+        // Plain teleport of the root: no sweep, no physics velocity, and overlaps are off while held
+        MeshComponent->SetWorldLocation(WorldPosition + HeldOffset, false, nullptr, ETeleportType::TeleportPhysics);
     }
 }
 
 void AAttachablePart::SetEmissive(float Value)
 {
-    // Set emissive on all materials
-    for (UMaterialInstanceDynamic* Mat : DynamicMaterials)
+    if (Value == CurrentEmissive)
+    {
+        return;
+    }
+
+    ROBOT_TRACE_SCOPE("RobotAbuse::SetEmissive");
+
+    CurrentEmissive = Value;
+    RobotHighlight::SetEmissive(HighlightMeshes, EmissiveDataIndex, Value);
+
+    if (bInstancedByFleet)
+    {
+        if (URobotFleetRenderer* Fleet = UWorld::GetSubsystem<URobotFleetRenderer>(GetWorld()))
+        {
+            Fleet->SetInstanceEmissive(this, Value);
+        }
+    }
+}
+
+void AAttachablePart::TryDemoteToFleet()
+{
+    if (IsAttached() && !bInstancedByFleet && URobotFleetRenderer::IsFleetModeEnabled())
+    {
+        if (URobotFleetRenderer* Fleet = UWorld::GetSubsystem<URobotFleetRenderer>(GetWorld()))
+        {
+            Fleet->Demote(this);
+        }
+    }
+}
+
+void AAttachablePart::PromoteFromFleet()
+{
+    if (bInstancedByFleet)
     {
-        if (Mat)
+        if (URobotFleetRenderer* Fleet = UWorld::GetSubsystem<URobotFleetRenderer>(GetWorld()))
         {
-            Mat->SetScalarParameterValue(EmissiveParameterName, Value);
+            Fleet->Promote(this);
         }
     }
 }
 
+void AAttachablePart::DeactivateForPool()
+{
+    if (bPooled)
+    {
+        return;
+    }
+
+    // Leave the socket and the fleet so nothing points at a parked part. Parking is not something to undo
+    if (CurrentAttachmentPoint)
+    {
+        FAttachmentJournalSuppressScope NoJournal(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()));
+        DetachFromPoint();
+    }
+    PromoteFromFleet();
+    StopFalling();
+
+    CurrentState = EPartState::DETACHED;
+    SetHeldMovement(false);
+    SetEmissive(NormalEmissive);
+
+    if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+    {
+        Registry->UnregisterPart(this);
+    }
+
+    SetActorHiddenInGame(true);
+    SetActorEnableCollision(false);
+    SetActorTickEnabled(false);
+    bPooled = true;
+
+    // Lists of parts drop a parked one
+    PostStateChanged();
+}
+
+void AAttachablePart::ReactivateFromPool(const FTransform& Transform)
+{
+    if (!bPooled)
+    {
+        return;
+    }
+
+    bPooled = false;
+    SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+    SetActorHiddenInGame(false);
+    SetActorEnableCollision(true);
+    SetActorTickEnabled(true);
+
+    if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+    {
+        Registry->RegisterPart(this);
+    }
+
+    // Movement does not replicate, clients pick the new location up from the session state
+    RecordNetState();
+    PostStateChanged();
+}
+
+#undef LOCTEXT_NAMESPACE
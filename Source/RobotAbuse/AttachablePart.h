@@ -1,13 +1,18 @@
 ﻿#pragma once
 
+#include "AttachmentRegistry.h"
 #include "IAttachable.h"
 #include "IClickable.h"
 #include "IDraggable.h"
 #include "IHoverable.h"
+#include "PartCategories.h"
+#include "RobotHighlight.h"
 #include "GameFramework/Actor.h"
 #include "AttachablePart.generated.h"
 
 class UAttachmentPoint;
+enum class EAttachmentJournalOp : uint8;
+struct FAttachmentJournalState;
 
 UENUM(BlueprintType)
 enum class EPartState : uint8
@@ -34,6 +39,7 @@ public:
     AAttachablePart();
 
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     // IInteractable
     virtual void OnHoverBegin_Implementation() override;
@@ -54,6 +60,9 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Interaction")
     void Drop();
 
+    // Lets go of the part at Location without a physics drop, for restoring a loose part
+    void PlaceAt(const FVector& Location);
+
     UFUNCTION(BlueprintCallable, Category = "Interaction")
     void AttachToPoint(UAttachmentPoint* Point);
 
@@ -66,21 +75,56 @@ public:
 
     UFUNCTION(BlueprintPure, Category = "State")
     UAttachmentPoint* GetAttachmentPoint() const { return CurrentAttachmentPoint; }
+
+    // Localized state name for UI, shared by every part
+    UFUNCTION(BlueprintPure, Category = "Part State")
+    FText GetStateText() const { return GetStateDisplayText(CurrentState); }
+
+    static const FText& GetStateDisplayText(EPartState State);
     
     UFUNCTION(BlueprintCallable, Category = "Attachment")
     void DetachFromPoint();
     
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arm Type")
     EArmType ArmType = EArmType::Universal;
+
+    // What the part is, names from [RobotAbuse.PartCategories]. Replaces ArmType when set, list Left/Right here too if they matter
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arm Type")
+    TArray<FName> Categories;
+
+    FPartCategoryMask GetCategoryMask() const;
     
     UPROPERTY(BlueprintReadOnly, Category = "State")
     EPartState CurrentState;
 
+    // Slot in the world's UAttachmentRegistry, maintained by the registry
+    FAttachmentHandle RegistryHandle;
+
+    // True while URobotFleetRenderer draws this part as an instance, maintained by the renderer
+    bool bInstancedByFleet = false;
+
+    UStaticMeshComponent* GetMeshComponent() const { return MeshComponent; }
+    int32 GetNumHighlightMeshes() const { return HighlightMeshes.Num(); }
+    bool UsesHighlightFallback() const { return HighlightMeshes.FallbackMaterials.Num() > 0; }
+    float GetCurrentEmissive() const { return FMath::Max(CurrentEmissive, NormalEmissive); }
+
+    // Fleet mode: hand the part to the instanced renderer while it is attached and idle
+    void TryDemoteToFleet();
+    void PromoteFromFleet();
+
+    // Pooling: URobotPartPool parks released parts here instead of destroying them
+    void DeactivateForPool();
+    void ReactivateFromPool(const FTransform& Transform);
+    bool IsPooled() const { return bPooled; }
+
+    // Dropped and simulating until the body sleeps, see robot.Physics.Drop
+    bool IsFalling() const { return bFalling; }
+
 protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     UStaticMeshComponent* MeshComponent;
     
-    // This function is used by the UI to get correct text based on state
+    // Used by WBP_ArmStatus. Builds a new string every call, native UI uses GetStateText
     UFUNCTION(BlueprintCallable, Category = "Part State")
     FString GetStateAsString() const
     {
@@ -96,7 +140,11 @@ protected:
     UPROPERTY(BlueprintReadOnly, Category = "State")
     UAttachmentPoint* CurrentAttachmentPoint;
 
-    // Visual config
+    // Visual config - custom primitive data slot the robot material reads its emissive strength from
+    UPROPERTY(EditAnywhere, Category = "Visual")
+    int32 EmissiveDataIndex = 0;
+
+    // Scalar parameter set through a dynamic material instance on materials not yet reading the slot above
     UPROPERTY(EditAnywhere, Category = "Visual")
     FName EmissiveParameterName = "EmissiveStrength";
     
@@ -114,8 +162,39 @@ protected:
 
 private:
     UPROPERTY()
-    TArray<UMaterialInstanceDynamic*> DynamicMaterials;
+    FRobotHighlightMeshes HighlightMeshes;
+
+    // Last value written, so repeated hover events cost nothing
+    float CurrentEmissive = -1.0f;
+
+    // Parked in URobotPartPool: hidden, no collision, not in the registry
+    bool bPooled = false;
+
+    // Resolved Categories, looked up again only when the names change
+    mutable FPartCategoryCache CategoryCache;
+
+    // Overlap generation to restore once the part is let go
+    bool bOverlapsBeforeHeld = false;
+
+    // Simulating after a drop, kinematic again once it sleeps or the fall times out
+    bool bFalling = false;
+    double FallStartTime = 0.0;
+    FTimerHandle FallCheckHandle;
 
     void SetEmissive(float Value);
+    void SetHeldMovement(bool bHeld);
+    void LetGo();
+    void RecordNetState();
+    void RecordJournal(EAttachmentJournalOp Op, const FAttachmentJournalState& Before);
+    void PostStateChanged();
     void SetupMaterials();
+
+    // Physics drop, server only. Clients get the resting place through the session state
+    void StartFalling();
+    void StopFalling();
+    void CheckFall();
+    void SettleAfterFall();
+
+    UFUNCTION()
+    void HandleBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
 };
@@ -0,0 +1,534 @@
+#include "AttachmentJournal.h"
+#include "RobotAbuse.h"
+#include "AttachmentPoint.h"
+#include "AttachmentRegistry.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static TAutoConsoleVariable<int32> CVarRobotJournalCapacity(
+	TEXT("robot.Journal.Capacity"),
+	4096,
+	TEXT("Attach, detach, pickup and drop records kept for undo. Read when a world starts, 0 disables the journal."));
+
+static void RunJournalCommand(const TArray<FString>& Args, UWorld* World, bool bRedo)
+{
+	UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(World);
+	if (!Journal)
+	{
+		return;
+	}
+
+	const int32 NumSteps = Args.IsValidIndex(0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1;
+	const double Start = FPlatformTime::Seconds();
+	const int32 NumReplayed = bRedo ? Journal->Redo(NumSteps) : Journal->Undo(NumSteps);
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("Journal: %s %d of %d steps in %.2f ms"),
+		bRedo ? TEXT("redid") : TEXT("undid"), NumReplayed, NumSteps, (FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdRobotJournalUndo(
+	TEXT("robot.Journal.Undo"),
+	TEXT("Undo part changes on the server or in a standalone game. Args: [Steps=1]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunJournalCommand(Args, World, false);
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs CmdRobotJournalRedo(
+	TEXT("robot.Journal.Redo"),
+	TEXT("Redo undone part changes. Args: [Steps=1]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunJournalCommand(Args, World, true);
+	}));
+
+static FAutoConsoleCommandWithWorld CmdRobotJournalClear(
+	TEXT("robot.Journal.Clear"),
+	TEXT("Forget the undo history of the current world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(World))
+		{
+			Journal->Clear();
+		}
+	}));
+
+FAttachmentJournalState::FAttachmentJournalState(const AAttachablePart* Part)
+	: Point(Part->GetAttachmentPoint())
+	, Location(Part->GetActorLocation())
+	, State(Part->CurrentState)
+{
+}
+
+static bool operator==(const FAttachmentJournalState& A, const FAttachmentJournalState& B)
+{
+	return A.State == B.State && A.Point == B.Point && A.Location == B.Location;
+}
+
+void UAttachmentJournal::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// The only allocations the journal makes, every record after this reuses a slot
+	Records.SetNum(FMath::Max(CVarRobotJournalCapacity.GetValueOnGameThread(), 0));
+	RecordInstigators.SetNum(Records.Num());
+}
+
+bool UAttachmentJournal::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAttachmentJournal::Record(EAttachmentJournalOp Op, AAttachablePart* Part, const FAttachmentJournalState& Before)
+{
+	if (bReplaying || SuppressDepth > 0 || Records.Num() == 0 || !Part)
+	{
+		return;
+	}
+
+	const FAttachmentJournalState After(Part);
+	if (After == Before)
+	{
+		return;
+	}
+
+	uint32 Step = ScopeStep;
+	bool bContinuesStep = false;
+	if (FOpenStep* Open = StepDepth > 0 ? FindOpenStep(ScopeStep) : &GetOpenStep(Part, Before))
+	{
+		Step = Open->Step;
+		bContinuesStep = Open->bRecorded;
+		Open->bRecorded = true;
+
+		if (Op == EAttachmentJournalOp::PickUp && Open->Held.Num() < MaxHeldInStep)
+		{
+			Open->Held.AddUnique(Part);
+		}
+	}
+
+	// A new change replaces whatever could have been redone
+	const FObjectKey InstigatorKey(Instigator);
+	DropRedoable();
+	if (NumUndoneBy > 0)
+	{
+		DropUndoneBy(InstigatorKey);
+	}
+
+	// Full: overwrite the oldest record
+	if (NumRecords == Records.Num())
+	{
+		NumUndoneBy -= GetRecord(0).bUndone ? 1 : 0;
+		Head = (Head + 1) % Records.Num();
+		--NumRecords;
+	}
+
+	FAttachmentJournalRecord& Entry = GetRecord(NumRecords);
+	Entry.Part = Part;
+	Entry.Before = Before;
+	Entry.After = After;
+	Entry.Step = Step;
+	Entry.Op = Op;
+	Entry.bUndone = false;
+	GetRecordInstigator(NumRecords) = InstigatorKey;
+
+	++NumRecords;
+	NumDone = NumRecords;
+
+	if (bContinuesStep)
+	{
+		GatherStep(Step);
+	}
+}
+
+void UAttachmentJournal::AmendRest(const AAttachablePart* Part)
+{
+	if (bReplaying || SuppressDepth > 0 || !Part)
+	{
+		return;
+	}
+
+	// Only the part's newest done record can be the one it fell after, older ones are left as they are
+	for (int32 Index = NumDone - 1; Index >= 0; --Index)
+	{
+		FAttachmentJournalRecord& Entry = GetRecord(Index);
+		if (Entry.Part == Part)
+		{
+			if (Entry.After.State == EPartState::DETACHED)
+			{
+				Entry.After.Location = FVector3f(Part->GetActorLocation());
+			}
+			return;
+		}
+	}
+}
+
+void UAttachmentJournal::BeginStep()
+{
+	// An outer scope or a part still in the instigator's hand keeps the step going, otherwise this is a new one
+	if (StepDepth == 0)
+	{
+		ScopeStep = GetOpenStep(nullptr, FAttachmentJournalState()).Step;
+	}
+	++StepDepth;
+}
+
+void UAttachmentJournal::EndStep()
+{
+	StepDepth = FMath::Max(StepDepth - 1, 0);
+}
+
+const UObject* UAttachmentJournal::SetInstigator(const UObject* InInstigator)
+{
+	const UObject* Previous = Instigator;
+	Instigator = InInstigator;
+	return Previous;
+}
+
+UAttachmentJournal::FOpenStep& UAttachmentJournal::GetOpenStep(const AAttachablePart* Part, const FAttachmentJournalState& Before)
+{
+	const FObjectKey Key(Instigator);
+	FOpenStep* Open = OpenSteps.FindByPredicate([&Key](const FOpenStep& Step) { return Step.Instigator == Key; });
+
+	if (Open)
+	{
+		// Letting go of a part picked up in this step ends the step, it does not start a new one
+		const bool bEndsHold = Part && Before.State == EPartState::HELD && Open->Held.Contains(Part);
+
+		Open->Held.RemoveAll([](const TWeakObjectPtr<AAttachablePart>& HeldPart)
+		{
+			return !HeldPart.IsValid() || !HeldPart->IsHeld();
+		});
+
+		if (bEndsHold || Open->Held.Num() > 0)
+		{
+			return *Open;
+		}
+	}
+	else
+	{
+		// Forget the instigator that started longest ago, its step just does not continue
+		if (OpenSteps.Num() == MaxOpenSteps)
+		{
+			OpenSteps.RemoveAt(0);
+		}
+		Open = &OpenSteps.AddDefaulted_GetRef();
+		Open->Instigator = Key;
+	}
+
+	Open->Step = ++LastStep;
+	Open->bRecorded = false;
+	Open->Held.Reset();
+	return *Open;
+}
+
+UAttachmentJournal::FOpenStep* UAttachmentJournal::FindOpenStep(uint32 Step)
+{
+	return OpenSteps.FindByPredicate([Step](const FOpenStep& Open) { return Open.Step == Step; });
+}
+
+void UAttachmentJournal::CloseStep()
+{
+	OpenSteps.Reset();
+}
+
+void UAttachmentJournal::GatherStep(uint32 Step)
+{
+	const int32 Newest = NumRecords - 1;
+	if (Newest < 1 || GetRecord(Newest - 1).Step == Step)
+	{
+		return;
+	}
+
+	// The step's earlier records sit in one block behind other instigators' records
+	int32 Last = Newest - 1;
+	while (Last >= 0 && GetRecord(Last).Step != Step)
+	{
+		--Last;
+	}
+	if (Last < 0)
+	{
+		return;
+	}
+
+	int32 First = Last;
+	while (First > 0 && GetRecord(First - 1).Step == Step)
+	{
+		--First;
+	}
+
+	// Rotate the block past the others in place, recording still never allocates
+	ReverseRecords(First, Last);
+	ReverseRecords(Last + 1, Newest - 1);
+	ReverseRecords(First, Newest - 1);
+}
+
+void UAttachmentJournal::ReverseRecords(int32 First, int32 Last)
+{
+	while (First < Last)
+	{
+		Swap(GetRecordInstigator(First), GetRecordInstigator(Last));
+		Swap(GetRecord(First++), GetRecord(Last--));
+	}
+}
+
+void UAttachmentJournal::DropRedoable()
+{
+	for (int32 Index = NumDone; Index < NumRecords; ++Index)
+	{
+		NumUndoneBy -= GetRecord(Index).bUndone ? 1 : 0;
+	}
+	NumRecords = NumDone;
+}
+
+void UAttachmentJournal::DropUndoneBy(const FObjectKey& Key)
+{
+	for (int32 Index = 0; Index < NumRecords && NumUndoneBy > 0; ++Index)
+	{
+		FAttachmentJournalRecord& Entry = GetRecord(Index);
+		if (Entry.bUndone && GetRecordInstigator(Index) == Key)
+		{
+			// Left in place as a dropped record, removing it would move the rest of the ring
+			Entry = FAttachmentJournalRecord();
+			--NumUndoneBy;
+		}
+	}
+}
+
+int32 UAttachmentJournal::Undo(int32 NumSteps)
+{
+	if (bReplaying || NumDone == 0)
+	{
+		return 0;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::JournalUndo");
+
+	CloseStep();
+	TGuardValue<bool> ReplayGuard(bReplaying, true);
+
+	// Every registry change below goes out as one notification when the scope closes
+	FAttachmentBatchScope BatchScope(UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()));
+
+	int32 NumUndone = 0;
+	while (NumUndone < NumSteps && NumDone > 0)
+	{
+		// Steps their instigator undid already stay undone, and dropped records are nothing to replay
+		if (IsSkipped(GetRecord(NumDone - 1)))
+		{
+			--NumDone;
+			continue;
+		}
+
+		const uint32 Step = GetRecord(NumDone - 1).Step;
+		while (NumDone > 0 && GetRecord(NumDone - 1).Step == Step)
+		{
+			--NumDone;
+			const FAttachmentJournalRecord& Entry = GetRecord(NumDone);
+			AAttachablePart* Part = Entry.Part.Get();
+			if (Part && !Part->IsPooled())
+			{
+				ApplyState(Part, Entry.Before);
+			}
+		}
+		++NumUndone;
+	}
+
+	return NumUndone;
+}
+
+int32 UAttachmentJournal::Redo(int32 NumSteps)
+{
+	if (bReplaying || NumDone == NumRecords)
+	{
+		return 0;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::JournalRedo");
+
+	CloseStep();
+	TGuardValue<bool> ReplayGuard(bReplaying, true);
+	FAttachmentBatchScope BatchScope(UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()));
+
+	int32 NumRedone = 0;
+	while (NumRedone < NumSteps && NumDone < NumRecords)
+	{
+		if (IsSkipped(GetRecord(NumDone)))
+		{
+			++NumDone;
+			continue;
+		}
+
+		const uint32 Step = GetRecord(NumDone).Step;
+		while (NumDone < NumRecords && GetRecord(NumDone).Step == Step)
+		{
+			const FAttachmentJournalRecord& Entry = GetRecord(NumDone);
+			AAttachablePart* Part = Entry.Part.Get();
+			if (Part && !Part->IsPooled())
+			{
+				ApplyState(Part, Entry.After);
+			}
+			++NumDone;
+		}
+		++NumRedone;
+	}
+
+	return NumRedone;
+}
+
+int32 UAttachmentJournal::UndoBy(const UObject* ByInstigator, int32 NumSteps)
+{
+	if (bReplaying || NumDone == 0)
+	{
+		return 0;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::JournalUndo");
+
+	// Only this instigator's step in progress ends, everyone else keeps dragging
+	const FObjectKey Key(ByInstigator);
+	OpenSteps.RemoveAll([&Key](const FOpenStep& Open) { return Open.Instigator == Key; });
+
+	TGuardValue<bool> ReplayGuard(bReplaying, true);
+	FAttachmentBatchScope BatchScope(UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()));
+
+	int32 NumUndone = 0;
+	int32 Index = NumDone - 1;
+	while (NumUndone < NumSteps)
+	{
+		// Newest step of the instigator still done, its records sit next to each other
+		while (Index >= 0 && (IsSkipped(GetRecord(Index)) || GetRecordInstigator(Index) != Key))
+		{
+			--Index;
+		}
+		if (Index < 0)
+		{
+			break;
+		}
+
+		const uint32 Step = GetRecord(Index).Step;
+		while (Index >= 0 && GetRecord(Index).Step == Step)
+		{
+			FAttachmentJournalRecord& Entry = GetRecord(Index);
+			AAttachablePart* Part = Entry.Part.Get();
+			if (Part && !Part->IsPooled())
+			{
+				ApplyState(Part, Entry.Before);
+			}
+			Entry.bUndone = true;
+			++NumUndoneBy;
+			--Index;
+		}
+		++NumUndone;
+	}
+
+	return NumUndone;
+}
+
+int32 UAttachmentJournal::RedoBy(const UObject* ByInstigator, int32 NumSteps)
+{
+	if (bReplaying || NumUndoneBy == 0)
+	{
+		return 0;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::JournalRedo");
+
+	const FObjectKey Key(ByInstigator);
+	OpenSteps.RemoveAll([&Key](const FOpenStep& Open) { return Open.Instigator == Key; });
+
+	TGuardValue<bool> ReplayGuard(bReplaying, true);
+	FAttachmentBatchScope BatchScope(UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()));
+
+	int32 NumRedone = 0;
+	while (NumRedone < NumSteps)
+	{
+		// The instigator's undone steps are the newest of its records, the oldest of them was undone last
+		int32 First = INDEX_NONE;
+		for (int32 Index = NumDone - 1; Index >= 0; --Index)
+		{
+			const FAttachmentJournalRecord& Entry = GetRecord(Index);
+			if (Entry.Step == 0 || GetRecordInstigator(Index) != Key)
+			{
+				continue;
+			}
+			if (!Entry.bUndone)
+			{
+				break;
+			}
+			First = Index;
+		}
+		if (First == INDEX_NONE)
+		{
+			break;
+		}
+
+		const uint32 Step = GetRecord(First).Step;
+		for (int32 Index = First; Index < NumDone && GetRecord(Index).Step == Step; ++Index)
+		{
+			FAttachmentJournalRecord& Entry = GetRecord(Index);
+			AAttachablePart* Part = Entry.Part.Get();
+			if (Part && !Part->IsPooled())
+			{
+				ApplyState(Part, Entry.After);
+			}
+			Entry.bUndone = false;
+			--NumUndoneBy;
+		}
+		++NumRedone;
+	}
+
+	return NumRedone;
+}
+
+void UAttachmentJournal::Clear()
+{
+	for (FAttachmentJournalRecord& Entry : Records)
+	{
+		Entry = FAttachmentJournalRecord();
+	}
+	for (FObjectKey& Key : RecordInstigators)
+	{
+		Key = FObjectKey();
+	}
+
+	Head = 0;
+	NumRecords = 0;
+	NumDone = 0;
+	NumUndoneBy = 0;
+	CloseStep();
+}
+
+void UAttachmentJournal::ApplyState(AAttachablePart* Part, const FAttachmentJournalState& State)
+{
+	UAttachmentPoint* Point = State.Point.Get();
+	if (State.State == EPartState::ATTACHED && Point)
+	{
+		if (Part->GetAttachmentPoint() == Point)
+		{
+			return;
+		}
+
+		// Something that was not journaled took the socket since, leave both where they are
+		if (Point->AttachedPart && Point->AttachedPart != Part)
+		{
+			UE_LOG(LogRobotAbuse, Verbose, TEXT("Journal: %s is taken, %s stays where it is"), *Point->GetName(), *Part->GetName());
+			return;
+		}
+
+		if (Part->GetAttachmentPoint())
+		{
+			Part->DetachFromPoint();
+		}
+		Point->AttachPart(Part);
+		Part->AttachToPoint(Point);
+		return;
+	}
+
+	// Held and loose parts both end up lying where they were
+	if (Part->GetAttachmentPoint())
+	{
+		Part->DetachFromPoint();
+	}
+	Part->PlaceAt(FVector(State.Location));
+}
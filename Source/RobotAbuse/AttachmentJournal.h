@@ -0,0 +1,243 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttachablePart.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "AttachmentJournal.generated.h"
+
+class UAttachmentPoint;
+
+enum class EAttachmentJournalOp : uint8
+{
+	Attach,
+	Detach,
+	PickUp,
+	Drop
+};
+
+/** Where a part was and what it was doing, on one side of a journaled op */
+struct FAttachmentJournalState
+{
+	FAttachmentJournalState() = default;
+	explicit FAttachmentJournalState(const AAttachablePart* Part);
+
+	TWeakObjectPtr<UAttachmentPoint> Point;
+	FVector3f Location = FVector3f::ZeroVector;
+	EPartState State = EPartState::DETACHED;
+};
+
+/** One state change of one part. Fixed size, weak pointers are an object index and serial */
+struct FAttachmentJournalRecord
+{
+	TWeakObjectPtr<AAttachablePart> Part;
+	FAttachmentJournalState Before;
+	FAttachmentJournalState After;
+
+	/** Records sharing a step are undone and redone together. 0 marks a dropped record every replay skips */
+	uint32 Step = 0;
+	EAttachmentJournalOp Op = EAttachmentJournalOp::Attach;
+
+	/** Undone by its instigator on its own, see UndoBy, while the records around it stay done */
+	bool bUndone = false;
+};
+
+static_assert(sizeof(FAttachmentJournalRecord) <= 64, "Journal records should stay within a cache line");
+
+/**
+ * Undo/redo history of every attach, detach, pickup and drop in the world.
+ * Records live in a ring preallocated when the world starts, see robot.Journal.Capacity: recording
+ * never allocates, and once the ring is full the oldest records are overwritten. Records are grouped
+ * into steps. Everything between a pickup and the drop or attach that ends it is one step, and so is
+ * everything inside an FAttachmentJournalScope, so a whole drag or a whole batch undoes at once.
+ * Each instigator (see FAttachmentJournalInstigatorScope) has its own open step, so two players
+ * dragging at once do not share one, and a step's records are kept next to each other in the ring.
+ * Pool and Mass proxy changes are bookkeeping, not player actions, and are not recorded at all.
+ * Undo and Redo walk the whole world's history, for the console. UndoBy and RedoBy only replay one
+ * instigator's steps and leave everyone else's alone, for players undoing their own changes.
+ * Replays go through the parts themselves with a single registry notification, held parts are
+ * never restored as held since nobody is dragging them afterwards, and loose parts are put back
+ * where they came to rest without falling again. Only the server and standalone games record,
+ * clients get the result of a replay replicated.
+ */
+UCLASS()
+class ROBOTABUSE_API UAttachmentJournal : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	/** Called by the part after it changed. Ignored while replaying */
+	void Record(EAttachmentJournalOp Op, AAttachablePart* Part, const FAttachmentJournalState& Before);
+
+	/** Called by a dropped part once it came to rest, its drop was recorded where it was let go */
+	void AmendRest(const AAttachablePart* Part);
+
+	/** Group everything recorded until the matching EndStep into one step. Nests */
+	void BeginStep();
+	void EndStep();
+
+	/** Who the changes recorded from now on belong to, nullptr for the world itself. Returns the previous one */
+	const UObject* SetInstigator(const UObject* InInstigator);
+
+	/** Nothing is recorded between these, see FAttachmentJournalSuppressScope */
+	void BeginSuppress() { ++SuppressDepth; }
+	void EndSuppress() { SuppressDepth = FMath::Max(SuppressDepth - 1, 0); }
+
+	/** Step back or forward through the history. Returns the number of steps replayed */
+	int32 Undo(int32 NumSteps = 1);
+	int32 Redo(int32 NumSteps = 1);
+
+	/** Same for the steps of one instigator only, the ones it undid are skipped by Undo and Redo */
+	int32 UndoBy(const UObject* ByInstigator, int32 NumSteps = 1);
+	int32 RedoBy(const UObject* ByInstigator, int32 NumSteps = 1);
+
+	bool CanUndo() const { return NumDone > 0; }
+	bool CanRedo() const { return NumDone < NumRecords; }
+	bool IsReplaying() const { return bReplaying; }
+
+	void Clear();
+
+	int32 GetCapacity() const { return Records.Num(); }
+	int32 GetNumRecords() const { return NumRecords; }
+	SIZE_T GetAllocatedSize() const { return Records.GetAllocatedSize() + RecordInstigators.GetAllocatedSize(); }
+
+private:
+	FAttachmentJournalRecord& GetRecord(int32 Index) { return Records[(Head + Index) % Records.Num()]; }
+	FObjectKey& GetRecordInstigator(int32 Index) { return RecordInstigators[(Head + Index) % Records.Num()]; }
+
+	static bool IsSkipped(const FAttachmentJournalRecord& Entry) { return Entry.Step == 0 || Entry.bUndone; }
+
+	// A new change by Key replaces the steps it undid, like a new change replaces the world's redo history
+	void DropUndoneBy(const FObjectKey& Key);
+	void DropRedoable();
+
+	struct FOpenStep;
+
+	// Open step of the current instigator a change belongs to: the one in progress, or a new one
+	FOpenStep& GetOpenStep(const AAttachablePart* Part, const FAttachmentJournalState& Before);
+	FOpenStep* FindOpenStep(uint32 Step);
+	void CloseStep();
+
+	// Another instigator recorded since Step's last record: move Step's earlier records up to its newest one
+	void GatherStep(uint32 Step);
+	void ReverseRecords(int32 First, int32 Last);
+
+	static void ApplyState(AAttachablePart* Part, const FAttachmentJournalState& State);
+
+	// Ring of Records.Num() slots, the oldest record at Head. Who made each record is kept next to
+	// it rather than in it, so a record stays one cache line
+	TArray<FAttachmentJournalRecord> Records;
+	TArray<FObjectKey> RecordInstigators;
+	int32 Head = 0;
+	int32 NumRecords = 0;
+
+	// Records before this are done, the rest can be redone
+	int32 NumDone = 0;
+
+	// Records with bUndone set, so recording only looks for them when there are any
+	int32 NumUndoneBy = 0;
+
+	uint32 LastStep = 0;
+	uint32 ScopeStep = 0;
+	int32 StepDepth = 0;
+	int32 SuppressDepth = 0;
+	bool bReplaying = false;
+
+	// Set by FAttachmentJournalInstigatorScope for the length of one action
+	const UObject* Instigator = nullptr;
+
+	// An instigator's step in progress, it stays open while one of the parts picked up in it is held
+	static constexpr int32 MaxHeldInStep = 8;
+	struct FOpenStep
+	{
+		FObjectKey Instigator;
+		uint32 Step = 0;
+		bool bRecorded = false;
+		TArray<TWeakObjectPtr<AAttachablePart>, TInlineAllocator<MaxHeldInStep>> Held;
+	};
+
+	static constexpr int32 MaxOpenSteps = 8;
+	TArray<FOpenStep, TInlineAllocator<MaxOpenSteps>> OpenSteps;
+};
+
+/** Everything recorded while the scope is open undoes as one step */
+struct FAttachmentJournalScope
+{
+	explicit FAttachmentJournalScope(UAttachmentJournal* InJournal)
+		: Journal(InJournal)
+	{
+		if (Journal)
+		{
+			Journal->BeginStep();
+		}
+	}
+
+	~FAttachmentJournalScope()
+	{
+		if (Journal)
+		{
+			Journal->EndStep();
+		}
+	}
+
+	UE_NONCOPYABLE(FAttachmentJournalScope);
+
+private:
+	UAttachmentJournal* Journal;
+};
+
+/** Everything recorded while the scope is open belongs to Instigator, usually the pawn acting */
+struct FAttachmentJournalInstigatorScope
+{
+	FAttachmentJournalInstigatorScope(UAttachmentJournal* InJournal, const UObject* Instigator)
+		: Journal(InJournal)
+		, Previous(InJournal ? InJournal->SetInstigator(Instigator) : nullptr)
+	{
+	}
+
+	~FAttachmentJournalInstigatorScope()
+	{
+		if (Journal)
+		{
+			Journal->SetInstigator(Previous);
+		}
+	}
+
+	UE_NONCOPYABLE(FAttachmentJournalInstigatorScope);
+
+private:
+	UAttachmentJournal* Journal;
+	const UObject* Previous;
+};
+
+/** Changes made while the scope is open are not recorded, for pooling and other bookkeeping */
+struct FAttachmentJournalSuppressScope
+{
+	explicit FAttachmentJournalSuppressScope(UAttachmentJournal* InJournal)
+		: Journal(InJournal)
+	{
+		if (Journal)
+		{
+			Journal->BeginSuppress();
+		}
+	}
+
+	~FAttachmentJournalSuppressScope()
+	{
+		if (Journal)
+		{
+			Journal->EndSuppress();
+		}
+	}
+
+	UE_NONCOPYABLE(FAttachmentJournalSuppressScope);
+
+private:
+	UAttachmentJournal* Journal;
+};
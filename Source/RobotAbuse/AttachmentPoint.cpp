@@ -1,8 +1,12 @@
 #include "AttachmentPoint.h"
+#include "RobotAbuse.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/ChildActorComponent.h"
-#include "Materials/MaterialInstanceDynamic.h"
 #include "AttachablePart.h"
+#include "AttachmentPointSubsystem.h"
+#include "AttachmentRegistry.h"
+#include "RobotMassSubsystem.h"
+#include "Engine/World.h"
 
 UAttachmentPoint::UAttachmentPoint()
 {
@@ -14,7 +18,11 @@ void UAttachmentPoint::OnRegister()
 {
 	//OnRegister allows us to see if the connection is found outside of runtime
     Super::OnRegister();
-    FindAttachmentVisual();
+
+    if (!AttachmentVisual)
+    {
+       FindAttachmentVisual();
+    }
 }
 
 void UAttachmentPoint::BeginPlay()
@@ -28,6 +36,40 @@ void UAttachmentPoint::BeginPlay()
 
     RegisterInitialPart();
     SetupVisual();
+
+    if (UAttachmentPointSubsystem* Subsystem = UWorld::GetSubsystem<UAttachmentPointSubsystem>(GetWorld()))
+    {
+       Subsystem->RegisterPoint(this);
+    }
+
+    if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+    {
+       Registry->RegisterSocket(this);
+    }
+}
+
+void UAttachmentPoint::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UAttachmentPointSubsystem* Subsystem = UWorld::GetSubsystem<UAttachmentPointSubsystem>(GetWorld()))
+    {
+       Subsystem->UnregisterPoint(this);
+    }
+
+    if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+    {
+       Registry->UnregisterSocket(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void UAttachmentPoint::NotifyAvailabilityChanged()
+{
+    // Keep the spatial index in sync so snapping only ever sees empty sockets
+    if (UAttachmentPointSubsystem* Subsystem = UWorld::GetSubsystem<UAttachmentPointSubsystem>(GetWorld()))
+    {
+       Subsystem->UpdatePoint(this);
+    }
 }
 
 void UAttachmentPoint::FindAttachmentVisual()
@@ -42,20 +84,29 @@ void UAttachmentPoint::FindAttachmentVisual()
        if (UStaticMeshComponent* MeshComp = Cast<UStaticMeshComponent>(Child))
        {
           AttachmentVisual = MeshComp;
-          UE_LOG(LogTemp, Log, TEXT("Found attachment visual: %s"), *MeshComp->GetName());
+          UE_LOG(LogRobotAbuse, Verbose, TEXT("Found attachment visual: %s"), *MeshComp->GetName());
           break;
        }
     }
 
     if (!AttachmentVisual)
     {
-       UE_LOG(LogTemp, Warning, TEXT("AttachmentPoint %s has no StaticMeshComponent child for visualization"),
+       UE_LOG(LogRobotAbuse, Warning, TEXT("AttachmentPoint %s has no StaticMeshComponent child for visualization"),
               *GetName());
     }
 }
 
 void UAttachmentPoint::RegisterInitialPart()
 {
+    // Robots spawned from a URobotDefinition name their part up front
+    if (InitialPart)
+    {
+       AttachedPart = InitialPart;
+       InitialPart->AttachToPoint(this);
+       InitialPart = nullptr;
+       return;
+    }
+
 	// NOTE: Currently searches for arm in child comps. 
 	// A more robust approach would use a named component or UPROPERTY reference.
     TArray<USceneComponent*> Children;
@@ -77,7 +128,7 @@ void UAttachmentPoint::RegisterInitialPart()
                 // Tell the part it's attached
                 Part->AttachToPoint(this);
                     
-                UE_LOG(LogTemp, Log, TEXT("Registered initial arm %s at attachment point %s"), 
+                UE_LOG(LogRobotAbuse, Verbose, TEXT("Registered initial arm %s at attachment point %s"), 
                    *Part->GetName(), *GetName());
                     
                 break;
@@ -94,8 +145,11 @@ void UAttachmentPoint::SetupVisual()
        // Hide visual if we have an attached part, show if empty
        bool bShouldShow = IsAvailable();
        AttachmentVisual->SetVisibility(bShouldShow);
+
+       RobotHighlight::CollectMesh(AttachmentVisual, this, EmissiveParameterName, VisualHighlight);
+       RobotHighlight::SetEmissive(VisualHighlight, EmissiveDataIndex, NormalIntensity);
        
-       UE_LOG(LogTemp, Log, TEXT("AttachmentPoint %s visual visibility: %s (IsAvailable: %s)"), 
+       UE_LOG(LogRobotAbuse, Verbose, TEXT("AttachmentPoint %s visual visibility: %s (IsAvailable: %s)"), 
           *GetName(), 
           bShouldShow ? TEXT("TRUE") : TEXT("FALSE"),
           IsAvailable() ? TEXT("TRUE") : TEXT("FALSE"));
@@ -106,45 +160,109 @@ void UAttachmentPoint::AttachPart(AAttachablePart* Part)
 {
 	if (!CanAcceptPart(Part))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Cannot attach %s to %s - incompatible arm type"), 
+		UE_LOG(LogRobotAbuse, Warning, TEXT("Cannot attach %s to %s - incompatible arm type"), 
 			   *Part->GetName(), *GetName());
 		return;
 	}
 
 	AttachedPart = Part;
 	ShowAttachmentVisual(false);
+	NotifyAvailabilityChanged();
+
+	if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+	{
+		Registry->Link(Part, this);
+	}
     
-	UE_LOG(LogTemp, Log, TEXT("Part %s attached to %s"), *Part->GetName(), *GetName());
+	UE_LOG(LogRobotAbuse, Verbose, TEXT("Part %s attached to %s"), *Part->GetName(), *GetName());
 }
 
 void UAttachmentPoint::DetachPart()
 {
     if (AttachedPart)
     {
-       UE_LOG(LogTemp, Log, TEXT("Part %s detached from %s"), *AttachedPart->GetName(), *GetName());
+       UE_LOG(LogRobotAbuse, Verbose, TEXT("Part %s detached from %s"), *AttachedPart->GetName(), *GetName());
+
+       if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+       {
+          Registry->Unlink(AttachedPart);
+       }
 
        AttachedPart = nullptr;
 
        ShowAttachmentVisual(true);
        SetHighlighted(false);
+       NotifyAvailabilityChanged();
+    }
+}
+
+UAttachmentPoint* UAttachmentPoint::FindByName(const AActor* Owner, FName PointName)
+{
+    if (!Owner || PointName.IsNone())
+    {
+        return nullptr;
+    }
+
+    TInlineComponentArray<UAttachmentPoint*> Points(Owner);
+    for (UAttachmentPoint* Point : Points)
+    {
+        if (Point->GetFName() == PointName)
+        {
+            return Point;
+        }
     }
+    return nullptr;
 }
 
 bool UAttachmentPoint::CanAcceptPart(AAttachablePart* Part) const
 {
-	if (!Part || !IsAvailable())
+	return IsAvailable() && IsCompatibleWith(Part);
+}
+
+bool UAttachmentPoint::IsCompatibleWith(const AAttachablePart* Part) const
+{
+	return Part && RobotPartCategories::AreCompatible(GetAcceptedMask(), Part->GetCategoryMask());
+}
+
+FPartCategoryMask UAttachmentPoint::GetAcceptedMask() const
+{
+	if (AcceptedCategories.Num() == 0)
 	{
-		return false;
+		return RobotPartCategories::SocketMaskFromArmType(AcceptedArmType);
 	}
-    
-	// Universal parts fit anywhere, universal sockets accept anything
-	if (AcceptedArmType == EArmType::Universal || Part->ArmType == EArmType::Universal)
+
+	return AcceptedCache.Get(AcceptedCategories);
+}
+
+void UAttachmentPoint::SetAcceptedArmType(EArmType Type)
+{
+	AcceptedArmType = Type;
+	NotifyAcceptedMaskChanged();
+}
+
+void UAttachmentPoint::SetAcceptedCategories(const TArray<FName>& Names)
+{
+	AcceptedCategories = Names;
+	NotifyAcceptedMaskChanged();
+}
+
+void UAttachmentPoint::NotifyAcceptedMaskChanged()
+{
+	if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
 	{
-		return true;
+		Registry->RefreshSocketMask(this);
+	}
+
+	if (URobotMassSubsystem* Mass = UWorld::GetSubsystem<URobotMassSubsystem>(GetWorld()))
+	{
+		Mass->RefreshSocketMask(this);
 	}
-    
-	// Otherwise, types must match
-	return AcceptedArmType == Part->ArmType;
+}
+
+bool UAttachmentPoint::AreArmTypesCompatible(EArmType SocketType, EArmType PartType)
+{
+	// A Universal socket accepts both sides and a Universal part is an arm for either
+	return RobotPartCategories::AreCompatible(RobotPartCategories::SocketMaskFromArmType(SocketType), RobotPartCategories::PartMaskFromArmType(PartType));
 }
 
 void UAttachmentPoint::ShowAttachmentVisual(bool bShow)
@@ -152,7 +270,7 @@ void UAttachmentPoint::ShowAttachmentVisual(bool bShow)
     if (AttachmentVisual)
     {
        AttachmentVisual->SetVisibility(bShow);
-       UE_LOG(LogTemp, Log, TEXT("AttachmentPoint %s visual set to: %s"), 
+       UE_LOG(LogRobotAbuse, VeryVerbose, TEXT("AttachmentPoint %s visual set to: %s"), 
           *GetName(), 
           bShow ? TEXT("VISIBLE") : TEXT("HIDDEN"));
     }
@@ -160,10 +278,10 @@ void UAttachmentPoint::ShowAttachmentVisual(bool bShow)
 
 void UAttachmentPoint::SetHighlighted(bool bHighlight)
 {
-    if (VisualMaterial)
+    if (AttachmentVisual)
     {
        float TargetIntensity = bHighlight ? HighlightIntensity : NormalIntensity;
-       VisualMaterial->SetScalarParameterValue(EmissiveParameterName, TargetIntensity);
+       RobotHighlight::SetEmissive(VisualHighlight, EmissiveDataIndex, TargetIntensity);
     }
 }
 
@@ -172,7 +290,7 @@ void UAttachmentPoint::OnHoverBegin_Implementation()
     if (IsAvailable())
     {
        SetHighlighted(true);
-       UE_LOG(LogTemp, Log, TEXT("Hovering attachment point: %s"), *GetName());
+       UE_LOG(LogRobotAbuse, VeryVerbose, TEXT("Hovering attachment point: %s"), *GetName());
     }
 }
 
@@ -15,10 +15,16 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void OnRegister() override; // Called when component is registered in editor
 
 public:
-    // Material parameters
+    // Custom primitive data slot the visual's material reads its emissive intensity from.
+    // Kept apart from the robot's own slot 0 so torso highlighting does not light up the socket.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Attachment|Material")
+    int32 EmissiveDataIndex = 1;
+
+    // Scalar parameter set through a dynamic material instance while the visual's material does not read the slot above
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Attachment|Material")
     FName EmissiveParameterName = "EmissiveIntensity";
 
@@ -32,9 +38,16 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Attachment|Setup")
     UChildActorComponent* InitialAttachedArmComponent;
 
+    // Part to attach when play begins, set by code that spawns the robot. Skips the child actor search
+    UPROPERTY(Transient)
+    AAttachablePart* InitialPart = nullptr;
+
     UPROPERTY(BlueprintReadOnly, Category = "Attachment")
     AAttachablePart* AttachedPart;
 
+    // Slot in the world's UAttachmentRegistry, maintained by the registry
+    FAttachmentHandle RegistryHandle;
+
     // Check if available for attachment
     UFUNCTION(BlueprintPure, Category = "Attachment")
     bool IsAvailable() const { return AttachedPart == nullptr; }
@@ -53,13 +66,38 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Attachment")
     void SetHighlighted(bool bHighlight);
     
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Attachment")
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetAcceptedArmType, Category = "Attachment")
     EArmType AcceptedArmType = EArmType::Universal;
 
+    // Part categories this socket takes, names from [RobotAbuse.PartCategories]. Replaces AcceptedArmType when set
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetAcceptedCategories, Category = "Attachment")
+    TArray<FName> AcceptedCategories;
+
+    // Change what the socket takes once it is in play, the registry and Mass keep their own copy of the mask
+    UFUNCTION(BlueprintSetter)
+    void SetAcceptedArmType(EArmType Type);
+
+    UFUNCTION(BlueprintSetter)
+    void SetAcceptedCategories(const TArray<FName>& Names);
+
+    FPartCategoryMask GetAcceptedMask() const;
+
     // Helper function
     UFUNCTION(BlueprintCallable, Category = "Attachment")
     bool CanAcceptPart(AAttachablePart* Part) const;
 
+    // Type check only, ignores whether the socket is currently occupied
+    bool IsCompatibleWith(const AAttachablePart* Part) const;
+
+    // The arm side rule, shared with code that has no UObjects to hand
+    static bool AreArmTypesCompatible(EArmType SocketType, EArmType PartType);
+
+    // Use Visual as the clickable sphere instead of searching the children for it
+    void SetAttachmentVisual(UStaticMeshComponent* Visual) { AttachmentVisual = Visual; }
+
+    // Socket of Owner with the given component name, how replication and snapshots refer to sockets
+    static UAttachmentPoint* FindByName(const AActor* Owner, FName PointName);
+
     // IInteractable interface
     virtual void OnHoverBegin_Implementation() override;
     virtual void OnHoverEnd_Implementation() override;
@@ -70,9 +108,13 @@ private:
     UStaticMeshComponent* AttachmentVisual;
 
     UPROPERTY()
-    UMaterialInstanceDynamic* VisualMaterial;
+    FRobotHighlightMeshes VisualHighlight;
+
+    mutable FPartCategoryCache AcceptedCache;
 
     void FindAttachmentVisual();
+    void NotifyAcceptedMaskChanged();
     void SetupVisual();
     void RegisterInitialPart();
+    void NotifyAvailabilityChanged();
 };
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "AttachmentPointSubsystem.h"
+#include "AttachmentPoint.h"
+#include "AttachablePart.h"
+
+void UAttachmentPointSubsystem::Deinitialize()
+{
+	for (UAttachmentPoint* Point : RegisteredPoints)
+	{
+		if (IsValid(Point))
+		{
+			Point->TransformUpdated.RemoveAll(this);
+		}
+	}
+
+	RegisteredPoints.Empty();
+	PointCells.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+// ===== Registration =====
+
+void UAttachmentPointSubsystem::RegisterPoint(UAttachmentPoint* Point)
+{
+	if (!Point)
+	{
+		return;
+	}
+
+	bool bAlreadyRegistered = false;
+	RegisteredPoints.Add(Point, &bAlreadyRegistered);
+
+	if (!bAlreadyRegistered)
+	{
+		// Sockets ride along with their robot, so follow transform changes to keep the grid correct
+		Point->TransformUpdated.AddUObject(this, &UAttachmentPointSubsystem::OnPointTransformUpdated);
+	}
+
+	UpdatePoint(Point);
+}
+
+void UAttachmentPointSubsystem::UnregisterPoint(UAttachmentPoint* Point)
+{
+	if (!Point || RegisteredPoints.Remove(Point) == 0)
+	{
+		return;
+	}
+
+	Point->TransformUpdated.RemoveAll(this);
+
+	if (const FIntVector* Cell = PointCells.Find(Point))
+	{
+		RemoveFromCell(Point, *Cell);
+		PointCells.Remove(Point);
+	}
+}
+
+void UAttachmentPointSubsystem::UpdatePoint(UAttachmentPoint* Point)
+{
+	if (!Point || !RegisteredPoints.Contains(Point))
+	{
+		return;
+	}
+
+	const FIntVector* CurrentCell = PointCells.Find(Point);
+
+	// Only empty sockets are indexed, occupied ones can never be a snap target
+	if (!Point->IsAvailable())
+	{
+		if (CurrentCell)
+		{
+			RemoveFromCell(Point, *CurrentCell);
+			PointCells.Remove(Point);
+		}
+		return;
+	}
+
+	const FIntVector NewCell = GetCell(Point->GetComponentLocation());
+
+	if (CurrentCell)
+	{
+		if (*CurrentCell == NewCell)
+		{
+			return;
+		}
+		RemoveFromCell(Point, *CurrentCell);
+	}
+
+	AddToCell(Point, NewCell);
+	PointCells.Add(Point, NewCell);
+}
+
+void UAttachmentPointSubsystem::OnPointTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport)
+{
+	UAttachmentPoint* Point = static_cast<UAttachmentPoint*>(Component);
+
+	// Occupied points are not in the grid, they get placed again when they become available
+	if (PointCells.Contains(Point))
+	{
+		UpdatePoint(Point);
+	}
+}
+
+// ===== Queries =====
+
+UAttachmentPoint* UAttachmentPointSubsystem::FindNearestCompatiblePoint(AAttachablePart* Part, const FVector& Location, float Radius) const
+{
+	if (!Part || Radius <= 0.0f)
+	{
+		return nullptr;
+	}
+
+	const FIntVector Min = GetCell(Location - FVector(Radius));
+	const FIntVector Max = GetCell(Location + FVector(Radius));
+
+	UAttachmentPoint* BestPoint = nullptr;
+	float BestDistSq = FMath::Square(Radius);
+
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			for (int32 Z = Min.Z; Z <= Max.Z; Z++)
+			{
+				const auto* Cell = Cells.Find(FIntVector(X, Y, Z));
+				if (!Cell)
+				{
+					continue;
+				}
+
+				for (UAttachmentPoint* Point : *Cell)
+				{
+					const float DistSq = FVector::DistSquared(Location, Point->GetComponentLocation());
+
+					// Distance first, the compatibility check is the more expensive test
+					if (DistSq <= BestDistSq && Point->CanAcceptPart(Part))
+					{
+						BestDistSq = DistSq;
+						BestPoint = Point;
+					}
+				}
+			}
+		}
+	}
+
+	return BestPoint;
+}
+
+void UAttachmentPointSubsystem::GatherPointsInRadius(const FVector& Location, float Radius, TArray<UAttachmentPoint*>& OutPoints) const
+{
+	if (Radius <= 0.0f)
+	{
+		return;
+	}
+
+	const FIntVector Min = GetCell(Location - FVector(Radius));
+	const FIntVector Max = GetCell(Location + FVector(Radius));
+	const float RadiusSq = FMath::Square(Radius);
+
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			for (int32 Z = Min.Z; Z <= Max.Z; Z++)
+			{
+				if (const auto* Cell = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					for (UAttachmentPoint* Point : *Cell)
+					{
+						if (FVector::DistSquared(Location, Point->GetComponentLocation()) <= RadiusSq)
+						{
+							OutPoints.Add(Point);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+// ===== Grid Helpers =====
+
+FIntVector UAttachmentPointSubsystem::GetCell(const FVector& Location) const
+{
+	const float InvCellSize = 1.0f / FMath::Max(CellSize, 1.0f);
+	return FIntVector(
+		FMath::FloorToInt(Location.X * InvCellSize),
+		FMath::FloorToInt(Location.Y * InvCellSize),
+		FMath::FloorToInt(Location.Z * InvCellSize));
+}
+
+void UAttachmentPointSubsystem::AddToCell(UAttachmentPoint* Point, const FIntVector& Cell)
+{
+	Cells.FindOrAdd(Cell).Add(Point);
+}
+
+void UAttachmentPointSubsystem::RemoveFromCell(UAttachmentPoint* Point, const FIntVector& Cell)
+{
+	if (auto* Points = Cells.Find(Cell))
+	{
+		Points->RemoveSingleSwap(Point);
+		if (Points->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AttachmentPointSubsystem.generated.h"
+
+class AAttachablePart;
+class UAttachmentPoint;
+class USceneComponent;
+
+/**
+ * Spatial index of every available attachment point in the world.
+ * Points live in a uniform hash grid and are moved between cells incrementally
+ * when they are attached, detached or moved, so socket lookups never scan all actors.
+ */
+UCLASS()
+class ROBOTABUSE_API UAttachmentPointSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// ===== Registration =====
+
+	/** Start tracking a point. Called by the point itself in BeginPlay */
+	void RegisterPoint(UAttachmentPoint* Point);
+
+	/** Stop tracking a point. Called by the point itself in EndPlay */
+	void UnregisterPoint(UAttachmentPoint* Point);
+
+	/** Re-evaluate a point after its availability changed (attach/detach) */
+	void UpdatePoint(UAttachmentPoint* Point);
+
+	// ===== Queries =====
+
+	/**
+	 * Find the closest available point within Radius of Location that accepts Part
+	 * @return The best point, or nullptr if nothing compatible is in range
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Attachment")
+	UAttachmentPoint* FindNearestCompatiblePoint(AAttachablePart* Part, const FVector& Location, float Radius) const;
+
+	/** Collect every available point within Radius of Location, unsorted */
+	void GatherPointsInRadius(const FVector& Location, float Radius, TArray<UAttachmentPoint*>& OutPoints) const;
+
+	int32 GetNumIndexedPoints() const { return PointCells.Num(); }
+
+	/** Edge length of a grid cell, roughly the typical snap radius */
+	UPROPERTY(EditAnywhere, Category = "Attachment")
+	float CellSize = 100.0f;
+
+private:
+	FIntVector GetCell(const FVector& Location) const;
+
+	void AddToCell(UAttachmentPoint* Point, const FIntVector& Cell);
+	void RemoveFromCell(UAttachmentPoint* Point, const FIntVector& Cell);
+
+	void OnPointTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport);
+
+	// Cell -> available points inside it
+	TMap<FIntVector, TArray<UAttachmentPoint*, TInlineAllocator<4>>> Cells;
+
+	// Available point -> the cell it currently sits in
+	TMap<UAttachmentPoint*, FIntVector> PointCells;
+
+	// Every point registered, available or not
+	TSet<UAttachmentPoint*> RegisteredPoints;
+};
@@ -0,0 +1,468 @@
+#include "AttachmentRegistry.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+
+void UAttachmentRegistry::Deinitialize()
+{
+	for (FSocketRecord& Socket : Sockets)
+	{
+		if (Socket.Point)
+		{
+			Socket.Point->RegistryHandle.Reset();
+		}
+	}
+
+	for (FPartRecord& Part : Parts)
+	{
+		if (Part.Part)
+		{
+			Part.Part->RegistryHandle.Reset();
+		}
+	}
+
+	Robots.Empty();
+	Sockets.Empty();
+	CandidateMasks.Empty();
+	Parts.Empty();
+	FreeRobots.Empty();
+	FreeSockets.Empty();
+	FreeParts.Empty();
+	RobotIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+// ===== Registration =====
+
+void UAttachmentRegistry::RegisterSocket(UAttachmentPoint* Point)
+{
+	if (!Point || FindSocket(Point) != INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 Index = FreeSockets.Num() > 0 ? FreeSockets.Pop(EAllowShrinking::No) : Sockets.AddDefaulted();
+	CandidateMasks.SetNumZeroed(Sockets.Num(), EAllowShrinking::No);
+
+	FSocketRecord& Socket = Sockets[Index];
+	Socket.Point = Point;
+	Socket.Part = INDEX_NONE;
+	Socket.Serial = NextSerial++;
+	Socket.AcceptedMask = Point->GetAcceptedMask();
+	Socket.Robot = FindOrAddRobot(Point->GetOwner());
+
+	if (Socket.Robot != INDEX_NONE)
+	{
+		Robots[Socket.Robot].Sockets.Add(Index);
+	}
+
+	Point->RegistryHandle = { Index, Socket.Serial };
+	RefreshCandidate(Index);
+
+	// Initial parts are attached before the socket registers
+	if (Point->AttachedPart)
+	{
+		Link(Point->AttachedPart, Point);
+	}
+}
+
+void UAttachmentRegistry::UnregisterSocket(UAttachmentPoint* Point)
+{
+	const int32 Index = FindSocket(Point);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	FSocketRecord& Socket = Sockets[Index];
+	if (Socket.Part != INDEX_NONE)
+	{
+		const int32 PartIndex = Socket.Part;
+		ClearLink(PartIndex);
+		RecordChange(Parts[PartIndex].Part, Index, INDEX_NONE);
+	}
+
+	RemoveSocketFromRobot(Index);
+
+	Sockets[Index] = FSocketRecord();
+	RefreshCandidate(Index);
+	FreeSockets.Add(Index);
+	Point->RegistryHandle.Reset();
+
+	FlushChanges();
+}
+
+void UAttachmentRegistry::RegisterPart(AAttachablePart* Part)
+{
+	if (!Part || FindPart(Part) != INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 Index = FreeParts.Num() > 0 ? FreeParts.Pop(EAllowShrinking::No) : Parts.AddDefaulted();
+
+	FPartRecord& Record = Parts[Index];
+	Record.Part = Part;
+	Record.Socket = INDEX_NONE;
+	Record.Serial = NextSerial++;
+
+	Part->RegistryHandle = { Index, Record.Serial };
+}
+
+void UAttachmentRegistry::UnregisterPart(AAttachablePart* Part)
+{
+	const int32 Index = FindPart(Part);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	Unlink(Part);
+
+	Parts[Index] = FPartRecord();
+	FreeParts.Add(Index);
+	Part->RegistryHandle.Reset();
+}
+
+void UAttachmentRegistry::Link(AAttachablePart* Part, UAttachmentPoint* Point)
+{
+	if (!Part || !Point)
+	{
+		return;
+	}
+
+	RegisterPart(Part);
+	RegisterSocket(Point);
+
+	const int32 PartIndex = FindPart(Part);
+	const int32 SocketIndex = FindSocket(Point);
+
+	if (Parts[PartIndex].Socket == SocketIndex)
+	{
+		return;
+	}
+
+	const int32 OldSocket = ClearLink(PartIndex);
+
+	// A socket holds one part, whatever was there before is no longer in it
+	const int32 PreviousPart = Sockets[SocketIndex].Part;
+	if (PreviousPart != INDEX_NONE)
+	{
+		ClearLink(PreviousPart);
+		RecordChange(Parts[PreviousPart].Part, SocketIndex, INDEX_NONE);
+	}
+
+	Parts[PartIndex].Socket = SocketIndex;
+	Sockets[SocketIndex].Part = PartIndex;
+	RefreshCandidate(SocketIndex);
+
+	RecordChange(Part, OldSocket, SocketIndex);
+	FlushChanges();
+}
+
+void UAttachmentRegistry::Unlink(AAttachablePart* Part)
+{
+	const int32 PartIndex = FindPart(Part);
+	if (PartIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 OldSocket = ClearLink(PartIndex);
+	if (OldSocket != INDEX_NONE)
+	{
+		RecordChange(Part, OldSocket, INDEX_NONE);
+		FlushChanges();
+	}
+}
+
+// ===== Change Notification =====
+
+void UAttachmentRegistry::EndBatch()
+{
+	check(BatchDepth > 0);
+	--BatchDepth;
+	FlushChanges();
+}
+
+void UAttachmentRegistry::RecordChange(AAttachablePart* Part, int32 OldSocket, int32 NewSocket)
+{
+	FAttachmentChange& Change = PendingChanges.AddDefaulted_GetRef();
+	Change.Part = Part;
+	Change.OldSocket = OldSocket != INDEX_NONE ? Sockets[OldSocket].Point : nullptr;
+	Change.NewSocket = NewSocket != INDEX_NONE ? Sockets[NewSocket].Point : nullptr;
+}
+
+void UAttachmentRegistry::FlushChanges()
+{
+	// Listeners may attach or detach in response, those changes go out in the next round of this loop
+	if (BatchDepth > 0 || bDispatching)
+	{
+		return;
+	}
+
+	TGuardValue<bool> DispatchGuard(bDispatching, true);
+
+	while (PendingChanges.Num() > 0)
+	{
+		// Swap buffers so both keep their capacity between batches
+		Swap(PendingChanges, DispatchingChanges);
+		OnAttachmentsChanged.Broadcast(DispatchingChanges);
+		DispatchingChanges.Reset();
+	}
+}
+
+// ===== Queries =====
+
+AAttachablePart* UAttachmentRegistry::GetPartInSocket(const UAttachmentPoint* Point) const
+{
+	const int32 SocketIndex = FindSocket(Point);
+	if (SocketIndex == INDEX_NONE || Sockets[SocketIndex].Part == INDEX_NONE)
+	{
+		return nullptr;
+	}
+	return Parts[Sockets[SocketIndex].Part].Part;
+}
+
+UAttachmentPoint* UAttachmentRegistry::GetSocketOfPart(const AAttachablePart* Part) const
+{
+	const int32 PartIndex = FindPart(Part);
+	if (PartIndex == INDEX_NONE || Parts[PartIndex].Socket == INDEX_NONE)
+	{
+		return nullptr;
+	}
+	return Sockets[Parts[PartIndex].Socket].Point;
+}
+
+AActor* UAttachmentRegistry::GetRobotOfPart(const AAttachablePart* Part) const
+{
+	const int32 PartIndex = FindPart(Part);
+	if (PartIndex == INDEX_NONE || Parts[PartIndex].Socket == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	const int32 RobotIndex = Sockets[Parts[PartIndex].Socket].Robot;
+	return RobotIndex != INDEX_NONE ? Robots[RobotIndex].Robot : nullptr;
+}
+
+int32 UAttachmentRegistry::GetPartsOfRobot(const AActor* Robot, TArray<AAttachablePart*>& OutParts) const
+{
+	const int32 NumBefore = OutParts.Num();
+	ForEachPartOfRobot(Robot, [&OutParts](AAttachablePart* Part, UAttachmentPoint*)
+	{
+		OutParts.Add(Part);
+	});
+	return OutParts.Num() - NumBefore;
+}
+
+// ===== Compatibility Filtering =====
+
+int32 UAttachmentRegistry::GatherCompatibleSockets(FPartCategoryMask PartMask, TArray<UAttachmentPoint*>& OutSockets) const
+{
+	// An empty mask fits nothing, and would pass every column below
+	if (PartMask == 0)
+	{
+		return 0;
+	}
+
+	const int32 NumBefore = OutSockets.Num();
+	const int32 NumSockets = CandidateMasks.Num();
+	const FPartCategoryMask* Masks = CandidateMasks.GetData();
+
+	// 64 sockets at a time: the inner loop has no branches so it vectorizes, then only the hits are visited
+	for (int32 Base = 0; Base < NumSockets; Base += 64)
+	{
+		const int32 Count = FMath::Min(64, NumSockets - Base);
+
+		uint64 Hits = 0;
+		for (int32 i = 0; i < Count; i++)
+		{
+			Hits |= uint64((Masks[Base + i] & PartMask) == 0) << i;
+		}
+
+		while (Hits)
+		{
+			const int32 Bit = static_cast<int32>(FMath::CountTrailingZeros64(Hits));
+			OutSockets.Add(Sockets[Base + Bit].Point);
+			Hits &= Hits - 1;
+		}
+	}
+
+	return OutSockets.Num() - NumBefore;
+}
+
+int32 UAttachmentRegistry::GatherCompatibleSocketsOfRobot(const AActor* Robot, FPartCategoryMask PartMask, TArray<UAttachmentPoint*>& OutSockets) const
+{
+	const int32 NumBefore = OutSockets.Num();
+
+	if (const int32* RobotIndex = RobotIndices.Find(Robot))
+	{
+		for (int32 SocketIndex : Robots[*RobotIndex].Sockets)
+		{
+			if (IsCandidate(SocketIndex, PartMask))
+			{
+				OutSockets.Add(Sockets[SocketIndex].Point);
+			}
+		}
+	}
+
+	return OutSockets.Num() - NumBefore;
+}
+
+int32 UAttachmentRegistry::FilterCompatibleSockets(FPartCategoryMask PartMask, TConstArrayView<UAttachmentPoint*> Candidates, TArray<UAttachmentPoint*>& OutSockets) const
+{
+	const int32 NumBefore = OutSockets.Num();
+
+	for (UAttachmentPoint* Point : Candidates)
+	{
+		const int32 SocketIndex = FindSocket(Point);
+		if (SocketIndex != INDEX_NONE && IsCandidate(SocketIndex, PartMask))
+		{
+			OutSockets.Add(Point);
+		}
+	}
+
+	return OutSockets.Num() - NumBefore;
+}
+
+bool UAttachmentRegistry::Validate() const
+{
+	bool bValid = true;
+
+	for (const FSocketRecord& Socket : Sockets)
+	{
+		if (!Socket.Point)
+		{
+			continue;
+		}
+
+		AAttachablePart* TablePart = Socket.Part != INDEX_NONE ? Parts[Socket.Part].Part : nullptr;
+		if (TablePart != Socket.Point->AttachedPart)
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("AttachmentRegistry: socket %s holds %s but the registry has %s"),
+				*Socket.Point->GetName(), *GetNameSafe(Socket.Point->AttachedPart), *GetNameSafe(TablePart));
+			bValid = false;
+		}
+	}
+
+	for (const FPartRecord& Part : Parts)
+	{
+		if (!Part.Part)
+		{
+			continue;
+		}
+
+		UAttachmentPoint* TableSocket = Part.Socket != INDEX_NONE ? Sockets[Part.Socket].Point : nullptr;
+		if (TableSocket != Part.Part->GetAttachmentPoint())
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("AttachmentRegistry: part %s is in %s but the registry has %s"),
+				*Part.Part->GetName(), *GetNameSafe(Part.Part->GetAttachmentPoint()), *GetNameSafe(TableSocket));
+			bValid = false;
+		}
+	}
+
+	return bValid;
+}
+
+// ===== Table Helpers =====
+
+int32 UAttachmentRegistry::FindSocket(const UAttachmentPoint* Point) const
+{
+	if (!Point)
+	{
+		return INDEX_NONE;
+	}
+
+	const FAttachmentHandle& Handle = Point->RegistryHandle;
+	if (Sockets.IsValidIndex(Handle.Index) && Sockets[Handle.Index].Serial == Handle.Serial && Sockets[Handle.Index].Point == Point)
+	{
+		return Handle.Index;
+	}
+	return INDEX_NONE;
+}
+
+int32 UAttachmentRegistry::FindPart(const AAttachablePart* Part) const
+{
+	if (!Part)
+	{
+		return INDEX_NONE;
+	}
+
+	const FAttachmentHandle& Handle = Part->RegistryHandle;
+	if (Parts.IsValidIndex(Handle.Index) && Parts[Handle.Index].Serial == Handle.Serial && Parts[Handle.Index].Part == Part)
+	{
+		return Handle.Index;
+	}
+	return INDEX_NONE;
+}
+
+int32 UAttachmentRegistry::FindOrAddRobot(AActor* Robot)
+{
+	if (!Robot)
+	{
+		return INDEX_NONE;
+	}
+
+	if (const int32* Existing = RobotIndices.Find(Robot))
+	{
+		return *Existing;
+	}
+
+	const int32 Index = FreeRobots.Num() > 0 ? FreeRobots.Pop(EAllowShrinking::No) : Robots.AddDefaulted();
+	Robots[Index].Robot = Robot;
+	Robots[Index].Sockets.Reset();
+	RobotIndices.Add(Robot, Index);
+	return Index;
+}
+
+void UAttachmentRegistry::RemoveSocketFromRobot(int32 SocketIndex)
+{
+	const int32 RobotIndex = Sockets[SocketIndex].Robot;
+	if (RobotIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FRobotRecord& Robot = Robots[RobotIndex];
+	Robot.Sockets.RemoveSingleSwap(SocketIndex, EAllowShrinking::No);
+
+	// Last socket gone, the robot slot can be reused
+	if (Robot.Sockets.Num() == 0)
+	{
+		RobotIndices.Remove(Robot.Robot);
+		Robot.Robot = nullptr;
+		FreeRobots.Add(RobotIndex);
+	}
+}
+
+int32 UAttachmentRegistry::ClearLink(int32 PartIndex)
+{
+	const int32 SocketIndex = Parts[PartIndex].Socket;
+	if (SocketIndex != INDEX_NONE)
+	{
+		Sockets[SocketIndex].Part = INDEX_NONE;
+		Parts[PartIndex].Socket = INDEX_NONE;
+		RefreshCandidate(SocketIndex);
+	}
+	return SocketIndex;
+}
+
+void UAttachmentRegistry::RefreshCandidate(int32 SocketIndex)
+{
+	const FSocketRecord& Socket = Sockets[SocketIndex];
+	CandidateMasks[SocketIndex] = Socket.Point && Socket.Part == INDEX_NONE
+		? ~Socket.AcceptedMask
+		: ~FPartCategoryMask(0);
+}
+
+void UAttachmentRegistry::RefreshSocketMask(UAttachmentPoint* Point)
+{
+	const int32 Index = FindSocket(Point);
+	if (Index != INDEX_NONE)
+	{
+		Sockets[Index].AcceptedMask = Point->GetAcceptedMask();
+		RefreshCandidate(Index);
+	}
+}
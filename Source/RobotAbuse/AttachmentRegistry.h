@@ -0,0 +1,210 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PartCategories.h"
+#include "AttachmentRegistry.generated.h"
+
+class AAttachablePart;
+class UAttachmentPoint;
+
+/** Stable reference to a slot in one of the registry tables. The serial guards against reuse of a freed slot */
+struct FAttachmentHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Reset() { Index = INDEX_NONE; Serial = 0; }
+
+	friend bool operator==(const FAttachmentHandle& A, const FAttachmentHandle& B) { return A.Index == B.Index && A.Serial == B.Serial; }
+	friend bool operator!=(const FAttachmentHandle& A, const FAttachmentHandle& B) { return !(A == B); }
+};
+
+/** One part moving in or out of a socket, as recorded by the registry */
+struct FAttachmentChange
+{
+	AAttachablePart* Part = nullptr;
+	UAttachmentPoint* OldSocket = nullptr;
+	UAttachmentPoint* NewSocket = nullptr;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAttachmentsChanged, TConstArrayView<FAttachmentChange>);
+
+/**
+ * World-level source of truth for which part sits in which socket of which robot.
+ * Robots, sockets and parts live in flat arrays with free lists and link to each other by index,
+ * so both directions are O(1) and iterating the parts of a robot never walks the scene graph.
+ * Sockets and parts keep their handle, the robot is the actor that owns the socket.
+ */
+UCLASS()
+class ROBOTABUSE_API UAttachmentRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// ===== Registration =====
+
+	void RegisterSocket(UAttachmentPoint* Point);
+	void UnregisterSocket(UAttachmentPoint* Point);
+
+	void RegisterPart(AAttachablePart* Part);
+	void UnregisterPart(AAttachablePart* Part);
+
+	/** Record that Part now sits in Point. Either side is registered on demand */
+	void Link(AAttachablePart* Part, UAttachmentPoint* Point);
+
+	/** Record that Part left whatever socket it was in */
+	void Unlink(AAttachablePart* Part);
+
+	/** Read Point's accepted mask again after its arm type or categories changed */
+	void RefreshSocketMask(UAttachmentPoint* Point);
+
+	// ===== Change Notification =====
+
+	/** Fired once per change, or once per batch with every change made inside it */
+	FOnAttachmentsChanged OnAttachmentsChanged;
+
+	/** Hold change notifications until the matching EndBatch. Batches nest */
+	void BeginBatch() { ++BatchDepth; }
+	void EndBatch();
+
+	bool IsInBatch() const { return BatchDepth > 0; }
+
+	// ===== Queries =====
+
+	AAttachablePart* GetPartInSocket(const UAttachmentPoint* Point) const;
+	UAttachmentPoint* GetSocketOfPart(const AAttachablePart* Part) const;
+	AActor* GetRobotOfPart(const AAttachablePart* Part) const;
+
+	/** Collect the parts currently attached to any socket of Robot */
+	int32 GetPartsOfRobot(const AActor* Robot, TArray<AAttachablePart*>& OutParts) const;
+
+	/** Call Func(AAttachablePart*, UAttachmentPoint*) for every occupied socket of Robot */
+	template <typename FuncType>
+	void ForEachPartOfRobot(const AActor* Robot, FuncType&& Func) const
+	{
+		if (const int32* RobotIndex = RobotIndices.Find(Robot))
+		{
+			for (int32 SocketIndex : Robots[*RobotIndex].Sockets)
+			{
+				const FSocketRecord& Socket = Sockets[SocketIndex];
+				if (Socket.Part != INDEX_NONE)
+				{
+					Func(Parts[Socket.Part].Part, Socket.Point);
+				}
+			}
+		}
+	}
+
+	// ===== Compatibility Filtering =====
+
+	/** Every registered empty socket that accepts PartMask, from one pass over the packed mask column */
+	int32 GatherCompatibleSockets(FPartCategoryMask PartMask, TArray<UAttachmentPoint*>& OutSockets) const;
+
+	/** Empty sockets of Robot that accept PartMask */
+	int32 GatherCompatibleSocketsOfRobot(const AActor* Robot, FPartCategoryMask PartMask, TArray<UAttachmentPoint*>& OutSockets) const;
+
+	/** Keep the Candidates that are empty and accept PartMask, e.g. the result of a spatial query */
+	int32 FilterCompatibleSockets(FPartCategoryMask PartMask, TConstArrayView<UAttachmentPoint*> Candidates, TArray<UAttachmentPoint*>& OutSockets) const;
+
+	/** Cross-check the tables against the pointers the objects hold. Returns false and logs on mismatch */
+	bool Validate() const;
+
+	int32 GetNumSockets() const { return Sockets.Num() - FreeSockets.Num(); }
+	int32 GetNumParts() const { return Parts.Num() - FreeParts.Num(); }
+
+private:
+	struct FRobotRecord
+	{
+		AActor* Robot = nullptr;
+		TArray<int32, TInlineAllocator<4>> Sockets;
+	};
+
+	struct FSocketRecord
+	{
+		UAttachmentPoint* Point = nullptr;
+		int32 Robot = INDEX_NONE;
+		int32 Part = INDEX_NONE;
+		uint32 Serial = 0;
+		FPartCategoryMask AcceptedMask = 0;
+	};
+
+	struct FPartRecord
+	{
+		AAttachablePart* Part = nullptr;
+		int32 Socket = INDEX_NONE;
+		uint32 Serial = 0;
+	};
+
+	int32 FindSocket(const UAttachmentPoint* Point) const;
+	int32 FindPart(const AAttachablePart* Part) const;
+
+	int32 FindOrAddRobot(AActor* Robot);
+	void RemoveSocketFromRobot(int32 SocketIndex);
+
+	// Clears both sides of a part's link, returns the socket it was in
+	int32 ClearLink(int32 PartIndex);
+
+	// Rewrite a socket's entry in CandidateMasks after its registration or occupancy changed
+	void RefreshCandidate(int32 SocketIndex);
+
+	bool IsCandidate(int32 SocketIndex, FPartCategoryMask PartMask) const
+	{
+		return PartMask != 0 && (PartMask & CandidateMasks[SocketIndex]) == 0;
+	}
+
+	void RecordChange(AAttachablePart* Part, int32 OldSocket, int32 NewSocket);
+	void FlushChanges();
+
+	TArray<FRobotRecord> Robots;
+	TArray<FSocketRecord> Sockets;
+	TArray<FPartRecord> Parts;
+
+	// Parallel to Sockets: the categories every empty socket rejects, all bits for occupied or freed slots.
+	// A part fits where it shares no bit with the column, queries add the reserved bit so even a part
+	// that needs nothing misses unavailable sockets. Filtering is a branch-free AND over this one column
+	TArray<FPartCategoryMask> CandidateMasks;
+
+	TArray<int32> FreeRobots;
+	TArray<int32> FreeSockets;
+	TArray<int32> FreeParts;
+
+	TMap<const AActor*, int32> RobotIndices;
+
+	uint32 NextSerial = 1;
+
+	// Changes waiting for the end of the current batch, and the buffer being dispatched right now
+	TArray<FAttachmentChange> PendingChanges;
+	TArray<FAttachmentChange> DispatchingChanges;
+	int32 BatchDepth = 0;
+	bool bDispatching = false;
+};
+
+/** Coalesces every registry change made in this scope into one notification */
+struct FAttachmentBatchScope
+{
+	explicit FAttachmentBatchScope(UAttachmentRegistry* InRegistry)
+		: Registry(InRegistry)
+	{
+		if (Registry)
+		{
+			Registry->BeginBatch();
+		}
+	}
+
+	~FAttachmentBatchScope()
+	{
+		if (Registry)
+		{
+			Registry->EndBatch();
+		}
+	}
+
+	UE_NONCOPYABLE(FAttachmentBatchScope);
+
+private:
+	UAttachmentRegistry* Registry;
+};
@@ -0,0 +1,1262 @@
+#include "Misc/AutomationTest.h"
+#include "AttachablePart.h"
+#include "AttachmentJournal.h"
+#include "AttachmentPoint.h"
+#include "AttachmentRegistry.h"
+#include "DragAssist.h"
+#include "InteractionTarget.h"
+#include "RobotAssembly.h"
+#include "RobotAssetPreloader.h"
+#include "RobotDefinitions.h"
+#include "RobotLoadDriver.h"
+#include "RobotEventBus.h"
+#include "RobotMassSubsystem.h"
+#include "RobotSnapshot.h"
+#include "RobotSpectatorPawn.h"
+#include "RobotStatusPanel.h"
+#include "RobotStressLayout.h"
+#include "RobotStressSpawner.h"
+#include "RobotTestWorld.h"
+#include "RobotTorso.h"
+#include "Algo/AnyOf.h"
+#include "EngineUtils.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Framework/Application/SlateApplication.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FInterfaceDispatchBenchmark,
+    "RobotAbuse.Performance.InterfaceDispatch",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FInterfaceDispatchBenchmark::RunTest(const FString& Parameters)
+{
+    constexpr int32 NumCalls = 100000;
+
+    AAttachablePart* Part = NewObject<AAttachablePart>();
+
+    FInteractionTarget Target;
+    Target.Set(Part);
+
+    TestTrue(TEXT("AAttachablePart hover should dispatch natively"),
+             EnumHasAllFlags(FInteractionClassInfo::Get(Part->GetClass()).NativeCapabilities, EInteractionCapability::Hoverable));
+
+    // Reflected path, as the pawn used to call it every hover/drag update
+    const double ReflectedStart = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumCalls; i++)
+    {
+        if (Part->Implements<UHoverable>())
+        {
+            IHoverable::Execute_OnHoverEnd(Part);
+        }
+    }
+    const double ReflectedSeconds = FPlatformTime::Seconds() - ReflectedStart;
+
+    // Cached capability + native interface pointer
+    const double NativeStart = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumCalls; i++)
+    {
+        if (Target.Has(EInteractionCapability::Hoverable))
+        {
+            Target.OnHoverEnd();
+        }
+    }
+    const double NativeSeconds = FPlatformTime::Seconds() - NativeStart;
+
+    AddInfo(FString::Printf(TEXT("Reflected dispatch: %.1f ns/call"), ReflectedSeconds * 1.0e9 / NumCalls));
+    AddInfo(FString::Printf(TEXT("Native dispatch: %.1f ns/call"), NativeSeconds * 1.0e9 / NumCalls));
+
+    return true;
+}
+
+// ===== Compatibility Filter =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FCompatibilityFilterBenchmark,
+    "RobotAbuse.Performance.CompatibilityFilter",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FCompatibilityFilterBenchmark::RunTest(const FString& Parameters)
+{
+    constexpr int32 NumSockets = 10000;
+    constexpr int32 NumQueries = 200;
+
+    UAttachmentRegistry* Registry = NewObject<UAttachmentRegistry>();
+    TArray<UAttachmentPoint*> Sockets;
+
+    for (int32 i = 0; i < NumSockets; i++)
+    {
+        UAttachmentPoint* Socket = NewObject<UAttachmentPoint>();
+        Socket->AcceptedArmType = static_cast<EArmType>(i % 3);
+        Registry->RegisterSocket(Socket);
+        Sockets.Add(Socket);
+    }
+
+    AAttachablePart* Part = NewObject<AAttachablePart>();
+    Part->ArmType = EArmType::Left;
+
+    TArray<UAttachmentPoint*> Compatible;
+    Compatible.Reserve(NumSockets);
+
+    // One CanAcceptPart call per socket, as a caller without the registry would do it
+    const double PerSocketStart = FPlatformTime::Seconds();
+    for (int32 Query = 0; Query < NumQueries; Query++)
+    {
+        Compatible.Reset();
+        for (UAttachmentPoint* Socket : Sockets)
+        {
+            if (Socket->CanAcceptPart(Part))
+            {
+                Compatible.Add(Socket);
+            }
+        }
+    }
+    const double PerSocketSeconds = FPlatformTime::Seconds() - PerSocketStart;
+    const int32 PerSocketCount = Compatible.Num();
+
+    // Packed mask column
+    const double PackedStart = FPlatformTime::Seconds();
+    for (int32 Query = 0; Query < NumQueries; Query++)
+    {
+        Compatible.Reset();
+        Registry->GatherCompatibleSockets(Part->GetCategoryMask(), Compatible);
+    }
+    const double PackedSeconds = FPlatformTime::Seconds() - PackedStart;
+
+    TestEqual(TEXT("Both paths should find the same sockets"), Compatible.Num(), PerSocketCount);
+
+    AddInfo(FString::Printf(TEXT("Per-socket check: %.1f us per %d sockets"), PerSocketSeconds * 1.0e6 / NumQueries, NumSockets));
+    AddInfo(FString::Printf(TEXT("Packed mask filter: %.1f us per %d sockets"), PackedSeconds * 1.0e6 / NumQueries, NumSockets));
+
+    return true;
+}
+
+// ===== Drag Assist =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FDragAssistBenchmark,
+    "RobotAbuse.Performance.DragAssist",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FDragAssistBenchmark::RunTest(const FString& Parameters)
+{
+    constexpr int32 NumSockets = 500;
+    constexpr int32 NumFrames = 1000;
+
+    FDragAssistSettings Settings;
+    Settings.Radius = 500.0f;
+    Settings.MaxAngleDegrees = 90.0f;
+
+    // Hundreds of sockets in range, the one straight under the cursor must win
+    FRandomStream Random(42);
+    TArray<FVector> Locations;
+    for (int32 i = 0; i < NumSockets; i++)
+    {
+        Locations.Add(Random.VRand() * Random.FRandRange(50.0f, 400.0f));
+    }
+    Locations[NumSockets / 2] = FVector(0.0f, 0.0f, -10.0f);
+
+    FDragAssistView View;
+    View.RayOrigin = FVector(0.0f, 0.0f, 1000.0f);
+    View.RayDirection = FVector::DownVector;
+
+    const FVector PartLocation = FVector::ZeroVector;
+
+    TestEqual(TEXT("Socket under the cursor next to the part should be suggested"),
+              FDragAssist::FindBest(Locations, PartLocation, View, Settings), NumSockets / 2);
+
+    int32 NumOverBudget = 0;
+    double WorstSeconds = 0.0;
+    const double Start = FPlatformTime::Seconds();
+    for (int32 Frame = 0; Frame < NumFrames; Frame++)
+    {
+        const double FrameStart = FPlatformTime::Seconds();
+        bool bOverBudget = false;
+        FDragAssist::FindBest(Locations, PartLocation, View, Settings, &bOverBudget);
+        WorstSeconds = FMath::Max(WorstSeconds, FPlatformTime::Seconds() - FrameStart);
+        NumOverBudget += bOverBudget ? 1 : 0;
+    }
+    const double Seconds = FPlatformTime::Seconds() - Start;
+
+    AddInfo(FString::Printf(TEXT("Scoring %d sockets: %.2f us avg, %.2f us worst, budget %.0f us, %d frames cut short"),
+                            NumSockets, Seconds * 1.0e6 / NumFrames, WorstSeconds * 1.0e6, Settings.BudgetMicroseconds, NumOverBudget));
+
+    return true;
+}
+
+// ===== Drag Latency =====
+
+namespace RobotDragLatency
+{
+    // Moves the synthetic cursor in the middle of the frame, after the pawn's own tick,
+    // the way a camera update or an input event arriving late in the frame would
+    struct FCursorStepTickFunction : public FTickFunction
+    {
+        ARobotSpectatorPawn* Pawn = nullptr;
+        FVector Origin = FVector::ZeroVector;
+        bool bPending = false;
+
+        virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override
+        {
+            if (bPending && IsValid(Pawn))
+            {
+                Pawn->SetSyntheticCursor(Origin, FVector::DownVector);
+                bPending = false;
+            }
+        }
+
+        virtual FString DiagnosticMessage() override { return TEXT("RobotDragLatency::CursorStep"); }
+    };
+
+    /** Frames between a cursor step and the held part arriving under it, 0 is the same frame, INDEX_NONE if it never did */
+    int32 Measure(FRobotTestWorld& TestWorld, AAttachablePart* Part, FCursorStepTickFunction& Step, const FVector& Delta, int32 MaxFrames)
+    {
+        const FVector Expected = Part->GetActorLocation() + Delta;
+        Step.Origin += Delta;
+        Step.bPending = true;
+
+        for (int32 Frame = 0; Frame < MaxFrames; Frame++)
+        {
+            TestWorld.Tick(1.0f / 60.0f);
+            if (Part->GetActorLocation().Equals(Expected, 0.1f))
+            {
+                return Frame;
+            }
+        }
+        return INDEX_NONE;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FDragLatencyBenchmark,
+    "RobotAbuse.Performance.DragLatency",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FDragLatencyBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotDragLatency;
+
+    constexpr int32 NumSteps = 10;
+    constexpr int32 MaxFrames = 5;
+
+    FRobotTestWorld TestWorld;
+    FRobotStressParams WorldParams;
+    WorldParams.NumRobots = 1;
+    TestWorld.Populate(WorldParams);
+    TestWorld.BeginPlay();
+
+    UWorld* World = TestWorld.GetWorld();
+    ARobotSpectatorPawn* Pawn = World->SpawnActor<ARobotSpectatorPawn>();
+    AAttachablePart* Part = TestWorld.GetParts().Num() > 0 ? TestWorld.GetParts()[0] : nullptr;
+    if (!TestNotNull(TEXT("Spectator pawn should spawn"), Pawn) || !TestNotNull(TEXT("Test world should have a part"), Part))
+    {
+        return false;
+    }
+
+    // Pick the part up from straight above
+    FCursorStepTickFunction Step;
+    Step.Pawn = Pawn;
+    Step.Origin = Part->GetActorLocation() + FVector(0.0f, 0.0f, 500.0f);
+    Pawn->SetSyntheticCursor(Step.Origin, FVector::DownVector);
+    Pawn->SimulateClick();
+    if (!TestEqual(TEXT("Clicking the part should pick it up"), Pawn->GetDraggedActor(), static_cast<AActor*>(Part)))
+    {
+        return false;
+    }
+    TestWorld.Tick(1.0f / 60.0f);
+
+    Step.TickGroup = TG_PostPhysics;
+    Step.bCanEverTick = true;
+    Step.RegisterTickFunction(World->PersistentLevel);
+
+    IConsoleVariable* LowLatency = IConsoleManager::Get().FindConsoleVariable(TEXT("robot.Interaction.LowLatencyDrag"));
+    if (!TestNotNull(TEXT("robot.Interaction.LowLatencyDrag should exist"), LowLatency))
+    {
+        Step.UnRegisterTickFunction();
+        return false;
+    }
+    const bool bWasEnabled = LowLatency->GetBool();
+
+    // Worst latency over a few steps, with the drag in the pawn tick and with the end-of-frame drag
+    int32 Latency[2] = { 0, 0 };
+    for (int32 Mode = 0; Mode < 2; Mode++)
+    {
+        LowLatency->Set(Mode == 1, ECVF_SetByCode);
+
+        for (int32 StepIndex = 0; StepIndex < NumSteps; StepIndex++)
+        {
+            const FVector Delta(StepIndex % 2 ? -40.0f : 40.0f, 10.0f, 0.0f);
+            const int32 Frames = Measure(TestWorld, Part, Step, Delta, MaxFrames);
+            Latency[Mode] = Frames == INDEX_NONE || Latency[Mode] == INDEX_NONE ? INDEX_NONE : FMath::Max(Latency[Mode], Frames);
+        }
+    }
+
+    LowLatency->Set(bWasEnabled, ECVF_SetByCode);
+    Step.UnRegisterTickFunction();
+
+    AddInfo(FString::Printf(TEXT("Input to transform latency: %d frames in the pawn tick, %d frames with robot.Interaction.LowLatencyDrag"),
+                            Latency[0], Latency[1]));
+
+    TestTrue(TEXT("The part should follow the cursor in the pawn tick"), Latency[0] != INDEX_NONE);
+    TestEqual(TEXT("The end-of-frame drag should move the part in the frame the cursor moved"), Latency[1], 0);
+
+    const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("RobotAbuse_DragLatency.csv");
+    const FString Csv = FString::Printf(TEXT("Mode,LatencyFrames%sPawnTick,%d%sLowLatency,%d%s"),
+                                        LINE_TERMINATOR, Latency[0], LINE_TERMINATOR, Latency[1], LINE_TERMINATOR);
+    FFileHelper::SaveStringToFile(Csv, *CsvPath);
+
+    Pawn->Destroy();
+    return true;
+}
+
+// ===== Scale Benchmark =====
+
+namespace RobotBenchmark
+{
+    /** DefaultGame.ini section holding robot counts, scene shape and regression thresholds */
+    const TCHAR* ConfigSection = TEXT("RobotAbuse.Benchmarks");
+
+    struct FResult
+    {
+        int32 NumRobots = 0;
+        int32 NumSockets = 0;
+        int32 NumParts = 0;
+        double SpawnMs = 0.0;
+        double StartupMs = 0.0;
+        double AttachDetachUs = 0.0;
+        double HoverUpdateUs = 0.0;
+        double DragUpdateUs = 0.0;
+        double BytesPerPart = 0.0;
+    };
+
+    /** A metric, how it reads in the output and the per-unit threshold key that gates it */
+    struct FMetric
+    {
+        const TCHAR* Name;
+        const TCHAR* ThresholdKey;
+        double FResult::* Value;
+    };
+
+    const FMetric Metrics[] =
+    {
+        { TEXT("SpawnMs"), nullptr, &FResult::SpawnMs },
+        { TEXT("StartupMs"), nullptr, &FResult::StartupMs },
+        { TEXT("AttachDetachUs"), TEXT("MaxAttachDetachUs"), &FResult::AttachDetachUs },
+        { TEXT("HoverUpdateUs"), TEXT("MaxHoverUpdateUs"), &FResult::HoverUpdateUs },
+        { TEXT("DragUpdateUs"), TEXT("MaxDragUpdateUs"), &FResult::DragUpdateUs },
+        { TEXT("BytesPerPart"), TEXT("MaxBytesPerPart"), &FResult::BytesPerPart },
+    };
+
+    int32 GetConfigInt(const TCHAR* Key, int32 Default)
+    {
+        GConfig->GetInt(ConfigSection, Key, Default, GGameIni);
+        return Default;
+    }
+
+    double GetConfigDouble(const TCHAR* Key, double Default)
+    {
+        GConfig->GetDouble(ConfigSection, Key, Default, GGameIni);
+        return Default;
+    }
+
+    /** Robot counts to run, -RobotBenchmarkCounts=10,100 on the command line wins over the ini */
+    TArray<int32> GetRobotCounts()
+    {
+        TArray<FString> Values;
+
+        FString CommandLineCounts;
+        if (FParse::Value(FCommandLine::Get(), TEXT("RobotBenchmarkCounts="), CommandLineCounts, false))
+        {
+            CommandLineCounts.ParseIntoArray(Values, TEXT(","));
+        }
+        else
+        {
+            GConfig->GetArray(ConfigSection, TEXT("RobotCounts"), Values, GGameIni);
+        }
+
+        TArray<int32> Counts;
+        for (const FString& Value : Values)
+        {
+            const int32 Count = FCString::Atoi(*Value);
+            if (Count > 0)
+            {
+                Counts.Add(Count);
+            }
+        }
+
+        if (Counts.Num() == 0)
+        {
+            Counts = { 10, 100, 1000, 10000 };
+        }
+
+        return Counts;
+    }
+
+    /** Average cost of one detach plus re-attach through the same calls the player triggers */
+    double MeasureAttachDetach(const FRobotTestWorld& TestWorld)
+    {
+        const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+        const TArray<UAttachmentPoint*>& HomePoints = TestWorld.GetHomePoints();
+        const int32 NumParts = FMath::Min(Parts.Num(), GetConfigInt(TEXT("MaxAttachDetachParts"), 20000));
+
+        const double Start = FPlatformTime::Seconds();
+        for (int32 i = 0; i < NumParts; i++)
+        {
+            // Every part ends up in the state it started in
+            if (Parts[i]->IsAttached())
+            {
+                Parts[i]->DetachFromPoint();
+                Parts[i]->TryAttachTo_Implementation(HomePoints[i]);
+            }
+            else
+            {
+                Parts[i]->TryAttachTo_Implementation(HomePoints[i]);
+                Parts[i]->DetachFromPoint();
+            }
+        }
+        const double Seconds = FPlatformTime::Seconds() - Start;
+
+        return NumParts > 0 ? Seconds * 1.0e6 / (NumParts * 2) : 0.0;
+    }
+
+    /**
+     * Average cost of one hover update: a real ARobotSpectatorPawn ticked under a synthetic cursor, the way
+     * URobotLoadDriver drives its users. The target changes every update, the worst case.
+     */
+    double MeasureHover(const FRobotTestWorld& TestWorld)
+    {
+        UWorld* World = TestWorld.GetWorld();
+        const TArray<ARobotTorso*>& Robots = TestWorld.GetRobots();
+        const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+        const int32 NumUpdates = GetConfigInt(TEXT("HoverUpdates"), 2000);
+
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+        ARobotSpectatorPawn* Pawn = World->SpawnActor<ARobotSpectatorPawn>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+        if (!Pawn || Robots.Num() == 0)
+        {
+            return 0.0;
+        }
+
+        // Ticked by hand so only the pawn's own update is timed
+        Pawn->SetActorTickEnabled(false);
+
+        const double Start = FPlatformTime::Seconds();
+        for (int32 i = 0; i < NumUpdates; i++)
+        {
+            // Alternate between a torso and an arm so both the actor and the fleet instance paths run
+            const int32 RobotIndex = (i / 2) % Robots.Num();
+            const AActor* Aim = (i % 2 == 0 || Parts.Num() == 0) ? static_cast<const AActor*>(Robots[RobotIndex]) : Parts[RobotIndex % Parts.Num()];
+            Pawn->SetSyntheticCursor(Aim->GetActorLocation() + FVector(0.0f, 0.0f, 1000.0f), FVector::DownVector);
+
+            // Each update stands for a frame of its own, the cursor query traces at most once per frame
+            GFrameCounter++;
+            Pawn->Tick(1.0f / 60.0f);
+        }
+        const double Seconds = FPlatformTime::Seconds() - Start;
+
+        Pawn->Destroy();
+
+        return NumUpdates > 0 ? Seconds * 1.0e6 / NumUpdates : 0.0;
+    }
+
+    /** Average cost of moving a held arm, as ARobotSpectatorPawn::UpdateDraggedActor does every tick */
+    double MeasureDrag(const FRobotTestWorld& TestWorld)
+    {
+        const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+        if (Parts.Num() == 0)
+        {
+            return 0.0;
+        }
+
+        AAttachablePart* Part = Parts[0];
+        UAttachmentPoint* Home = TestWorld.GetHomePoints()[0];
+        const bool bWasAttached = Part->IsAttached();
+        const FVector Origin = Part->GetActorLocation();
+        const int32 NumUpdates = GetConfigInt(TEXT("DragUpdates"), 10000);
+
+        FInteractionTarget Target;
+        Target.Set(Part);
+        Target.OnClicked();
+
+        const double Start = FPlatformTime::Seconds();
+        for (int32 i = 0; i < NumUpdates; i++)
+        {
+            const float Angle = i * 0.01f;
+            Target.UpdateDragPosition(Origin + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * 200.0f);
+        }
+        const double Seconds = FPlatformTime::Seconds() - Start;
+
+        if (bWasAttached)
+        {
+            Target.TryAttachTo(Home);
+        }
+        else
+        {
+            Target.OnDropped();
+        }
+
+        return NumUpdates > 0 ? Seconds * 1.0e6 / NumUpdates : 0.0;
+    }
+
+    FResult Run(int32 NumRobots)
+    {
+        FRobotStressParams Params;
+        Params.NumRobots = NumRobots;
+        Params.SocketsPerRobot = GetConfigInt(TEXT("SocketsPerRobot"), Params.SocketsPerRobot);
+        Params.AttachedRatio = GetConfigDouble(TEXT("AttachedRatio"), Params.AttachedRatio);
+
+        FResult Result;
+        Result.NumRobots = NumRobots;
+
+        const uint64 MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+        FRobotTestWorld TestWorld;
+
+        double Start = FPlatformTime::Seconds();
+        TestWorld.Populate(Params);
+        Result.SpawnMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+        Start = FPlatformTime::Seconds();
+        TestWorld.BeginPlay();
+        Result.StartupMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+        // Whole-scene footprint spread over the parts, robots and sockets included
+        const uint64 MemoryAfter = FPlatformMemory::GetStats().UsedPhysical;
+        Result.NumSockets = TestWorld.GetPoints().Num();
+        Result.NumParts = TestWorld.GetParts().Num();
+        Result.BytesPerPart = Result.NumParts > 0 && MemoryAfter > MemoryBefore ? double(MemoryAfter - MemoryBefore) / Result.NumParts : 0.0;
+
+        // One frame so the fleet and subsystems settle before anything is timed
+        TestWorld.Tick(1.0f / 60.0f);
+
+        Result.AttachDetachUs = MeasureAttachDetach(TestWorld);
+        Result.HoverUpdateUs = MeasureHover(TestWorld);
+        Result.DragUpdateUs = MeasureDrag(TestWorld);
+
+        return Result;
+    }
+
+    void WriteResults(const TArray<FResult>& Results, FString& OutCsvPath, FString& OutJsonPath)
+    {
+        const FString Directory = FPaths::ProjectSavedDir() / TEXT("Benchmarks");
+        OutCsvPath = Directory / TEXT("RobotAbuse_Scale.csv");
+        OutJsonPath = Directory / TEXT("RobotAbuse_Scale.json");
+
+        FString Csv = TEXT("NumRobots,NumSockets,NumParts");
+        for (const FMetric& Metric : Metrics)
+        {
+            Csv += FString::Printf(TEXT(",%s"), Metric.Name);
+        }
+        Csv += LINE_TERMINATOR;
+
+        FString Json;
+        TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+        Writer->WriteObjectStart();
+        Writer->WriteValue(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+        Writer->WriteArrayStart(TEXT("Results"));
+
+        for (const FResult& Result : Results)
+        {
+            Csv += FString::Printf(TEXT("%d,%d,%d"), Result.NumRobots, Result.NumSockets, Result.NumParts);
+
+            Writer->WriteObjectStart();
+            Writer->WriteValue(TEXT("NumRobots"), Result.NumRobots);
+            Writer->WriteValue(TEXT("NumSockets"), Result.NumSockets);
+            Writer->WriteValue(TEXT("NumParts"), Result.NumParts);
+
+            for (const FMetric& Metric : Metrics)
+            {
+                Csv += FString::Printf(TEXT(",%.3f"), Result.*Metric.Value);
+                Writer->WriteValue(Metric.Name, Result.*Metric.Value);
+            }
+
+            Csv += LINE_TERMINATOR;
+            Writer->WriteObjectEnd();
+        }
+
+        Writer->WriteArrayEnd();
+        Writer->WriteObjectEnd();
+        Writer->Close();
+
+        FFileHelper::SaveStringToFile(Csv, *OutCsvPath);
+        FFileHelper::SaveStringToFile(Json, *OutJsonPath);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FAttachmentScaleBenchmark,
+    "RobotAbuse.Performance.Scale",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FAttachmentScaleBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    TArray<FResult> Results;
+
+    for (int32 NumRobots : GetRobotCounts())
+    {
+        const FResult& Result = Results.Add_GetRef(Run(NumRobots));
+
+        AddInfo(FString::Printf(TEXT("N=%d: spawn %.1f ms, startup %.1f ms, attach/detach %.2f us, hover %.2f us, drag %.2f us, %.0f bytes/part"),
+                                Result.NumRobots, Result.SpawnMs, Result.StartupMs, Result.AttachDetachUs,
+                                Result.HoverUpdateUs, Result.DragUpdateUs, Result.BytesPerPart));
+
+        // Thresholds are per operation or per part, so one value holds for every N. Zero disables a gate
+        for (const FMetric& Metric : Metrics)
+        {
+            const double Threshold = Metric.ThresholdKey ? GetConfigDouble(Metric.ThresholdKey, 0.0) : 0.0;
+            if (Threshold > 0.0 && Result.*Metric.Value > Threshold)
+            {
+                AddError(FString::Printf(TEXT("Regression at N=%d: %s is %.3f, threshold %.3f"),
+                                         Result.NumRobots, Metric.Name, Result.*Metric.Value, Threshold));
+            }
+        }
+
+        // StartupMs grows with the scene, so its gate is per robot
+        const double MaxStartupUsPerRobot = GetConfigDouble(TEXT("MaxStartupUsPerRobot"), 0.0);
+        const double StartupUsPerRobot = Result.StartupMs * 1000.0 / FMath::Max(Result.NumRobots, 1);
+        if (MaxStartupUsPerRobot > 0.0 && StartupUsPerRobot > MaxStartupUsPerRobot)
+        {
+            AddError(FString::Printf(TEXT("Regression at N=%d: startup is %.3f us per robot, threshold %.3f"),
+                                     Result.NumRobots, StartupUsPerRobot, MaxStartupUsPerRobot));
+        }
+    }
+
+    FString CsvPath;
+    FString JsonPath;
+    WriteResults(Results, CsvPath, JsonPath);
+    AddInfo(FString::Printf(TEXT("Results written to %s and %s"), *CsvPath, *JsonPath));
+
+    return true;
+}
+
+// ===== Synthetic Users =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FSyntheticUserBenchmark,
+    "RobotAbuse.Performance.SyntheticUsers",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FSyntheticUserBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    TSharedRef<FRobotTestWorld> TestWorld = MakeShared<FRobotTestWorld>();
+
+    // A saved stress layout from the RobotStressMap commandlet wins over the generated grid
+    FString LayoutPath;
+    GConfig->GetString(ConfigSection, TEXT("LoadTestLayout"), LayoutPath, GGameIni);
+    const URobotStressLayout* Layout = LayoutPath.IsEmpty() ? nullptr : LoadObject<URobotStressLayout>(nullptr, *LayoutPath);
+
+    if (Layout)
+    {
+        TestWorld->Populate(*Layout);
+    }
+    else
+    {
+        FRobotStressParams WorldParams;
+        WorldParams.NumRobots = GetConfigInt(TEXT("LoadTestRobots"), 100);
+        WorldParams.SocketsPerRobot = GetConfigInt(TEXT("SocketsPerRobot"), WorldParams.SocketsPerRobot);
+        TestWorld->Populate(WorldParams);
+    }
+    TestWorld->BeginPlay();
+
+    URobotLoadDriver* Driver = UWorld::GetSubsystem<URobotLoadDriver>(TestWorld->GetWorld());
+    if (!TestNotNull(TEXT("Load driver should exist in the test world"), Driver))
+    {
+        return false;
+    }
+
+    FRobotLoadParams LoadParams;
+    LoadParams.NumUsers = GetConfigInt(TEXT("LoadTestUsers"), 16);
+    LoadParams.ClicksPerSecond = GetConfigDouble(TEXT("LoadTestClicksPerSecond"), 4.0);
+    LoadParams.Seed = GetConfigInt(TEXT("LoadTestSeed"), 1234);
+    Driver->Start(LoadParams);
+
+    // One world tick per engine frame, the cursor query only traces hover once per frame
+    const int32 NumFrames = GetConfigInt(TEXT("LoadTestFrames"), 600);
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, TestWorld, NumFrames, NumUsers = LoadParams.NumUsers, FrameIndex = 0]() mutable
+    {
+        TestWorld->Tick(1.0f / 60.0f);
+        if (++FrameIndex < NumFrames)
+        {
+            return false;
+        }
+
+        URobotLoadDriver* LoadDriver = UWorld::GetSubsystem<URobotLoadDriver>(TestWorld->GetWorld());
+        const FRobotLoadStats Stats = LoadDriver->GetStats();
+        LoadDriver->LogStats();
+        LoadDriver->Stop();
+
+        AddInfo(FString::Printf(TEXT("%lld clicks (%lld pickups, %lld attaches, %lld drops), step %.2f us avg / %.2f us max, click %.2f us avg / %.2f us max, checksum %08x"),
+                                Stats.Clicks, Stats.PickUps, Stats.Attaches, Stats.Drops, Stats.GetAverageStepUs(), Stats.MaxStepSeconds * 1.0e6,
+                                Stats.GetAverageClickUs(), Stats.MaxClickSeconds * 1.0e6, Stats.Checksum));
+
+        TestTrue(TEXT("Virtual users should have picked something up"), Stats.PickUps > 0);
+
+        const double MaxUserStepUs = GetConfigDouble(TEXT("MaxUserStepUs"), 0.0);
+        if (MaxUserStepUs > 0.0 && Stats.GetAverageStepUs() > MaxUserStepUs)
+        {
+            AddError(FString::Printf(TEXT("Regression: user step is %.3f us, threshold %.3f"), Stats.GetAverageStepUs(), MaxUserStepUs));
+        }
+
+        const double MaxClickUs = GetConfigDouble(TEXT("MaxClickUs"), 0.0);
+        if (MaxClickUs > 0.0 && Stats.GetAverageClickUs() > MaxClickUs)
+        {
+            AddError(FString::Printf(TEXT("Regression: click is %.3f us, threshold %.3f"), Stats.GetAverageClickUs(), MaxClickUs));
+        }
+
+        const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("RobotAbuse_SyntheticUsers.csv");
+        const FString Csv = FString::Printf(TEXT("Users,Frames,Clicks,PickUps,Attaches,Drops,StepUs,MaxStepUs,ClickUs,MaxClickUs,Checksum%s%d,%lld,%lld,%lld,%lld,%lld,%.3f,%.3f,%.3f,%.3f,%08x%s"),
+                                            LINE_TERMINATOR, NumUsers,
+                                            Stats.Frames, Stats.Clicks, Stats.PickUps, Stats.Attaches, Stats.Drops,
+                                            Stats.GetAverageStepUs(), Stats.MaxStepSeconds * 1.0e6, Stats.GetAverageClickUs(), Stats.MaxClickSeconds * 1.0e6,
+                                            Stats.Checksum, LINE_TERMINATOR);
+        FFileHelper::SaveStringToFile(Csv, *CsvPath);
+
+        return true;
+    }));
+
+    return true;
+}
+
+// ===== Snapshot =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FSnapshotBenchmark,
+    "RobotAbuse.Performance.Snapshot",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FSnapshotBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    FRobotTestWorld TestWorld;
+    FRobotStressParams WorldParams;
+    WorldParams.NumRobots = GetConfigInt(TEXT("SnapshotRobots"), 10000);
+    WorldParams.SocketsPerRobot = GetConfigInt(TEXT("SocketsPerRobot"), WorldParams.SocketsPerRobot);
+    TestWorld.Populate(WorldParams);
+    TestWorld.BeginPlay();
+
+    const FString Path = RobotSnapshot::GetDefaultPath(TEXT("Benchmark"));
+
+    double Start = FPlatformTime::Seconds();
+    if (!TestTrue(TEXT("Snapshot should save"), RobotSnapshot::SaveToFile(TestWorld.GetWorld(), Path)))
+    {
+        return false;
+    }
+    const double SaveMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+    const int64 FileSize = IFileManager::Get().FileSize(*Path);
+
+    // Worst case for the restore: every arm has to go back into its socket
+    for (AAttachablePart* Part : TestWorld.GetParts())
+    {
+        if (Part->IsAttached())
+        {
+            Part->DetachFromPoint();
+        }
+    }
+
+    Start = FPlatformTime::Seconds();
+    const int32 NumChanged = RobotSnapshot::RestoreFromFile(TestWorld.GetWorld(), Path);
+    const double RestoreMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    AddInfo(FString::Printf(TEXT("%d robots, %d parts: save %.1f ms, %lld bytes (%.1f per part), restore %.1f ms, %d parts changed"),
+                            WorldParams.NumRobots, TestWorld.GetParts().Num(), SaveMs, FileSize,
+                            FileSize / (double)FMath::Max(TestWorld.GetParts().Num(), 1), RestoreMs, NumChanged));
+
+    TestTrue(TEXT("Restore should put parts back"), NumChanged > 0);
+
+    const double MaxRestoreMs = GetConfigDouble(TEXT("MaxSnapshotRestoreMs"), 0.0);
+    if (MaxRestoreMs > 0.0 && RestoreMs > MaxRestoreMs)
+    {
+        AddError(FString::Printf(TEXT("Regression: snapshot restore took %.1f ms, threshold %.1f"), RestoreMs, MaxRestoreMs));
+    }
+
+    return true;
+}
+
+// ===== Undo Journal =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FJournalReplayBenchmark,
+    "RobotAbuse.Performance.JournalReplay",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FJournalReplayBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    const int32 NumSteps = GetConfigInt(TEXT("JournalSteps"), 1000);
+
+    FRobotTestWorld TestWorld;
+    FRobotStressParams WorldParams;
+    WorldParams.NumRobots = FMath::DivideAndRoundUp(NumSteps, WorldParams.SocketsPerRobot);
+    TestWorld.Populate(WorldParams);
+    TestWorld.BeginPlay();
+
+    UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(TestWorld.GetWorld());
+    if (!TestNotNull(TEXT("Game worlds should have a journal"), Journal))
+    {
+        return false;
+    }
+    Journal->Clear();
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    const SIZE_T JournalBytes = Journal->GetAllocatedSize();
+
+    // One drag per step: take an arm off, carry it aside and drop it. Three records each
+    double Start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumSteps; i++)
+    {
+        AAttachablePart* Part = Parts[i % Parts.Num()];
+        Part->OnClicked_Implementation();
+        Part->SetActorLocation(Part->GetActorLocation() + FVector(0.0f, 0.0f, 100.0f));
+        Part->Drop();
+    }
+    const double RecordMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    Start = FPlatformTime::Seconds();
+    const int32 NumUndone = Journal->Undo(NumSteps);
+    const double UndoMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    Start = FPlatformTime::Seconds();
+    const int32 NumRedone = Journal->Redo(NumSteps);
+    const double RedoMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    AddInfo(FString::Printf(TEXT("%d steps, %d records: drags %.2f ms, undo %.2f ms, redo %.2f ms"),
+                            NumSteps, Journal->GetNumRecords(), RecordMs, UndoMs, RedoMs));
+
+    TestEqual(TEXT("Every step should be undone"), NumUndone, NumSteps);
+    TestEqual(TEXT("Every step should be redone"), NumRedone, NumSteps);
+    TestEqual(TEXT("Recording should not allocate"), Journal->GetAllocatedSize(), JournalBytes);
+
+    const double MaxReplayMs = GetConfigDouble(TEXT("MaxJournalReplayMs"), 0.0);
+    if (MaxReplayMs > 0.0 && FMath::Max(UndoMs, RedoMs) > MaxReplayMs)
+    {
+        AddError(FString::Printf(TEXT("Regression: replaying %d steps took %.2f ms, threshold %.2f"), NumSteps, FMath::Max(UndoMs, RedoMs), MaxReplayMs));
+    }
+
+    return true;
+}
+
+// ===== Status Panel =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FStatusPanelBenchmark,
+    "RobotAbuse.Performance.StatusPanel",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FStatusPanelBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    if (!FSlateApplication::IsInitialized())
+    {
+        AddWarning(TEXT("Slate is not running, the status panel was not measured"));
+        return true;
+    }
+
+    FRobotTestWorld TestWorld;
+    FRobotStressParams WorldParams;
+    WorldParams.NumRobots = GetConfigInt(TEXT("StatusPanelRobots"), 5000);
+    WorldParams.SocketsPerRobot = GetConfigInt(TEXT("SocketsPerRobot"), WorldParams.SocketsPerRobot);
+    TestWorld.Populate(WorldParams);
+    TestWorld.BeginPlay();
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+
+    double Start = FPlatformTime::Seconds();
+    TSharedRef<SRobotStatusPanel> Panel = SNew(SRobotStatusPanel).World(TestWorld.GetWorld());
+    const double BuildMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(TestWorld.GetWorld());
+    const int32 NumChanges = FMath::Min(GetConfigInt(TEXT("StatusPanelChanges"), 1000), Parts.Num());
+
+    // A burst of pickups in one frame, dispatched to the panel at once
+    for (int32 i = 0; i < NumChanges; i++)
+    {
+        Parts[i]->OnClicked_Implementation();
+    }
+
+    Start = FPlatformTime::Seconds();
+    EventBus->Flush();
+    const double UpdateMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    AddInfo(FString::Printf(TEXT("%d parts: panel built in %.2f ms, %d state changes applied in %.2f ms (%.2f us each)"),
+                            Panel->GetNumItems(), BuildMs, NumChanges, UpdateMs, UpdateMs * 1000.0 / FMath::Max(NumChanges, 1)));
+
+    TestEqual(TEXT("Panel should list every part"), Panel->GetNumItems(), Parts.Num());
+    TestEqual(TEXT("Panel should count every pickup"), Panel->GetNumInState(EPartState::HELD), NumChanges);
+
+    const double MaxBuildMs = GetConfigDouble(TEXT("MaxStatusPanelBuildMs"), 0.0);
+    if (MaxBuildMs > 0.0 && BuildMs > MaxBuildMs)
+    {
+        AddError(FString::Printf(TEXT("Regression: status panel took %.2f ms to build, threshold %.2f"), BuildMs, MaxBuildMs));
+    }
+
+    return true;
+}
+
+// ===== Time To Interactive =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FTimeToInteractiveBenchmark,
+    "RobotAbuse.Performance.TimeToInteractive",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FTimeToInteractiveBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    FRobotStressParams LayoutParams;
+    LayoutParams.NumRobots = GetConfigInt(TEXT("StartupRobots"), 10000);
+    LayoutParams.SocketsPerRobot = GetConfigInt(TEXT("SocketsPerRobot"), LayoutParams.SocketsPerRobot);
+
+    URobotStressLayout* Layout = NewObject<URobotStressLayout>();
+    Layout->Generate(LayoutParams);
+
+    // A stress map in miniature: nothing but the spawner, placed before play begins
+    FRobotTestWorld TestWorld;
+    ARobotStressSpawner* Spawner = TestWorld.GetWorld()->SpawnActor<ARobotStressSpawner>();
+    Spawner->Layout = Layout;
+
+    URobotStartupTracker* Startup = UWorld::GetSubsystem<URobotStartupTracker>(TestWorld.GetWorld());
+    if (!TestNotNull(TEXT("Game worlds should track startup"), Startup))
+    {
+        return false;
+    }
+
+    const double Start = FPlatformTime::Seconds();
+    TestWorld.BeginPlay();
+
+    int32 Frames = 0;
+    while (!Startup->IsInteractive() && Frames < 10)
+    {
+        TestWorld.Tick(1.0f / 60.0f);
+        Frames++;
+    }
+    const double TimeToInteractiveMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    TestTrue(TEXT("World should become interactive once the layout is attached"), Startup->IsInteractive());
+
+    int32 NumAttached = 0;
+    for (TActorIterator<AAttachablePart> It(TestWorld.GetWorld()); It; ++It)
+    {
+        NumAttached += It->CurrentState == EPartState::ATTACHED ? 1 : 0;
+    }
+
+    AddInfo(FString::Printf(TEXT("%d robots, %d arms attached: interactive after %d frames, %.1f ms"),
+                            Layout->Robots.Num(), NumAttached, Frames, TimeToInteractiveMs));
+
+    TestEqual(TEXT("Every socket of the layout should be filled"), NumAttached, Layout->GetNumSockets());
+
+    const double MaxMs = GetConfigDouble(TEXT("MaxTimeToInteractiveMs"), 0.0);
+    if (MaxMs > 0.0 && TimeToInteractiveMs > MaxMs)
+    {
+        AddError(FString::Printf(TEXT("Regression: time to interactive %.1f ms, threshold %.1f"), TimeToInteractiveMs, MaxMs));
+    }
+
+    return true;
+}
+
+// ===== Assembly Spawn =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FAssemblySpawnBenchmark,
+    "RobotAbuse.Performance.AssemblySpawn",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FAssemblySpawnBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    // Two sockets, each starting with its arm, like BP_Robot
+    URobotDefinition* Definition = NewObject<URobotDefinition>();
+    for (EArmType ArmType : { EArmType::Left, EArmType::Right })
+    {
+        URobotPartDefinition* Arm = NewObject<URobotPartDefinition>();
+        Arm->ArmType = ArmType;
+
+        FRobotSocketDefinition Socket;
+        Socket.RelativeLocation = FVector(0.0f, ArmType == EArmType::Left ? -60.0f : 60.0f, 0.0f);
+        Socket.AcceptedArmType = ArmType;
+        Socket.InitialPart = Arm;
+        Definition->Sockets.Add(Socket);
+    }
+
+    const int32 MaxRobots = GetConfigInt(TEXT("AssemblyRobots"), 10000);
+    const float Spacing = 300.0f;
+
+    double UsPerRobot[2] = {};
+    const int32 Counts[2] = { FMath::Max(MaxRobots / 10, 1), MaxRobots };
+
+    for (int32 Run = 0; Run < 2; Run++)
+    {
+        FRobotTestWorld TestWorld;
+        TestWorld.BeginPlay();
+
+        const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)Counts[Run]));
+        const double Start = FPlatformTime::Seconds();
+
+        FRobotAssemblyBatch Batch(TestWorld.GetWorld());
+        Batch.Reserve(Counts[Run]);
+        for (int32 i = 0; i < Counts[Run]; i++)
+        {
+            Batch.Add(*Definition, FTransform(FVector((i % GridSize) * Spacing, (i / GridSize) * Spacing, 0.0f)));
+        }
+        Batch.Finish();
+
+        const double Ms = (FPlatformTime::Seconds() - Start) * 1000.0;
+        UsPerRobot[Run] = Ms * 1000.0 / Counts[Run];
+
+        int32 NumAttached = 0;
+        for (const FRobotAssembly& Assembly : Batch.GetAssemblies())
+        {
+            for (const AAttachablePart* Part : Assembly.Parts)
+            {
+                NumAttached += Part && Part->CurrentState == EPartState::ATTACHED ? 1 : 0;
+            }
+        }
+
+        AddInfo(FString::Printf(TEXT("%d robots: spawned and attached in %.1f ms (%.1f us per robot)"), Counts[Run], Ms, UsPerRobot[Run]));
+        TestEqual(TEXT("Every initial arm should be attached"), NumAttached, Counts[Run] * Definition->Sockets.Num());
+    }
+
+    // Linear scaling keeps the cost per robot flat as the yard grows
+    const double MaxScaling = GetConfigDouble(TEXT("MaxAssemblyScaling"), 0.0);
+    const double Scaling = UsPerRobot[1] / FMath::Max(UsPerRobot[0], UE_DOUBLE_SMALL_NUMBER);
+    if (MaxScaling > 0.0 && Scaling > MaxScaling)
+    {
+        AddError(FString::Printf(TEXT("Regression: cost per robot grew %.2fx from %d to %d robots, threshold %.2fx"),
+                                 Scaling, Counts[0], Counts[1], MaxScaling));
+    }
+
+    return true;
+}
+
+// ===== Mass Drop =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FMassDropBenchmark,
+    "RobotAbuse.Performance.MassDrop",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FMassDropBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    const int32 NumDrops = GetConfigInt(TEXT("DropParts"), 500);
+    const int32 NumFrames = GetConfigInt(TEXT("DropFrames"), 180);
+
+    FRobotTestWorld TestWorld;
+    FRobotStressParams WorldParams;
+    WorldParams.NumRobots = FMath::DivideAndRoundUp(NumDrops, WorldParams.SocketsPerRobot);
+    TestWorld.Populate(WorldParams);
+
+    // A floor under the whole yard, robots stand at z=100 so the arms drop about a metre
+    const float Extent = FMath::CeilToFloat(FMath::Sqrt((float)WorldParams.NumRobots)) * WorldParams.Spacing + 1000.0f;
+    AStaticMeshActor* Floor = TestWorld.GetWorld()->SpawnActor<AStaticMeshActor>(FVector(Extent * 0.5f - 500.0f, Extent * 0.5f - 500.0f, -100.0f), FRotator::ZeroRotator);
+    Floor->SetMobility(EComponentMobility::Movable);
+    Floor->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+    Floor->SetActorScale3D(FVector(Extent / 100.0f, Extent / 100.0f, 1.0f));
+
+    TestWorld.BeginPlay();
+
+    // Every arm is let go in the same frame
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    const int32 NumParts = FMath::Min(NumDrops, Parts.Num());
+    for (int32 i = 0; i < NumParts; i++)
+    {
+        Parts[i]->OnClicked_Implementation();
+        Parts[i]->Drop();
+    }
+
+    TArray<double> FrameMs;
+    FrameMs.Reserve(NumFrames);
+    int32 SettledFrame = INDEX_NONE;
+
+    for (int32 Frame = 0; Frame < NumFrames; Frame++)
+    {
+        const double Start = FPlatformTime::Seconds();
+        TestWorld.Tick(1.0f / 60.0f);
+        FrameMs.Add((FPlatformTime::Seconds() - Start) * 1000.0);
+
+        if (SettledFrame == INDEX_NONE && !Algo::AnyOf(MakeArrayView(Parts.GetData(), NumParts), [](const AAttachablePart* Part) { return Part->IsFalling(); }))
+        {
+            SettledFrame = Frame;
+        }
+    }
+
+    FrameMs.Sort();
+    const double MedianMs = FrameMs[FrameMs.Num() / 2];
+    const double P95Ms = FrameMs[FMath::Min(FMath::FloorToInt(FrameMs.Num() * 0.95), FrameMs.Num() - 1)];
+    const double MaxMs = FrameMs.Last();
+
+    AddInfo(FString::Printf(TEXT("%d parts dropped: game thread median %.2f ms, p95 %.2f ms, max %.2f ms, all settled after %s frames"),
+                            NumParts, MedianMs, P95Ms, MaxMs, SettledFrame == INDEX_NONE ? TEXT("more than the measured") : *FString::FromInt(SettledFrame)));
+
+    TestTrue(TEXT("Every dropped part should settle and stop simulating"), SettledFrame != INDEX_NONE);
+
+    // Settling only at robot.Physics.MaxFallTime would mean neither the sleep event nor the poll noticed the bodies sleep
+    const IConsoleVariable* MaxFallTime = IConsoleManager::Get().FindConsoleVariable(TEXT("robot.Physics.MaxFallTime"));
+    if (SettledFrame != INDEX_NONE && MaxFallTime)
+    {
+        TestTrue(TEXT("Dropped parts should settle when their bodies sleep, not at the fall timeout"), (SettledFrame + 1) / 60.0f < MaxFallTime->GetFloat());
+    }
+
+    const double MaxP95Ms = GetConfigDouble(TEXT("MaxDropFrameMs"), 0.0);
+    if (MaxP95Ms > 0.0 && P95Ms > MaxP95Ms)
+    {
+        AddError(FString::Printf(TEXT("Regression: p95 frame %.2f ms while %d parts fall, threshold %.2f"), P95Ms, NumParts, MaxP95Ms));
+    }
+
+    return true;
+}
+
+// ===== Mass Fleet =====
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FMassFleetBenchmark,
+    "RobotAbuse.Performance.MassFleet",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+bool FMassFleetBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace RobotBenchmark;
+
+    // The backend is picked when a world starts
+    IConsoleVariable* MassEnable = IConsoleManager::Get().FindConsoleVariable(TEXT("robot.Mass.Enable"));
+    if (!TestNotNull(TEXT("robot.Mass.Enable should exist"), MassEnable))
+    {
+        return false;
+    }
+    const bool bWasEnabled = MassEnable->GetBool();
+
+    const int32 MaxParts = GetConfigInt(TEXT("MassParts"), 100000);
+    const int32 NumFrames = GetConfigInt(TEXT("MassFrames"), 120);
+    const int32 WarmupFrames = 10;
+    const int32 RequestsPerFrame = GetConfigInt(TEXT("MassRequestsPerFrame"), 1000);
+    const float ActorRadius = (float)GetConfigDouble(TEXT("MassActorRadius"), 1000.0);
+    const float Spacing = 100.0f;
+
+    double MedianMs[2] = {};
+    double P95Ms[2] = {};
+    const int32 Counts[2] = { FMath::Max(MaxParts / 10, 1), MaxParts };
+
+    for (int32 Run = 0; Run < 2; Run++)
+    {
+        MassEnable->Set(true);
+        FRobotTestWorld TestWorld;
+        MassEnable->Set(bWasEnabled);
+        TestWorld.BeginPlay();
+
+        URobotMassSubsystem* Mass = UWorld::GetSubsystem<URobotMassSubsystem>(TestWorld.GetWorld());
+        if (!TestNotNull(TEXT("Mass backend should exist with robot.Mass.Enable"), Mass))
+        {
+            return false;
+        }
+        Mass->ActorRadius = ActorRadius;
+
+        // A square yard centred on the viewer, which stays at the origin without a player, each part beside its socket
+        const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)Counts[Run]));
+        TArray<FVector> Locations;
+        Locations.Reserve(Counts[Run]);
+        int32 NumNear = 0;
+        for (int32 i = 0; i < Counts[Run]; i++)
+        {
+            const FVector Location(((i % GridSize) - GridSize / 2) * Spacing, ((i / GridSize) - GridSize / 2) * Spacing, 100.0f);
+            Locations.Add(Location);
+            NumNear += Location.SizeSquared() <= FMath::Square(ActorRadius) ? 1 : 0;
+        }
+
+        TArray<FMassEntityHandle> Sockets;
+        TArray<FMassEntityHandle> Parts;
+        Mass->CreateSockets(Locations, EArmType::Universal, Sockets);
+        Mass->CreateParts(AAttachablePart::StaticClass(), Locations, EArmType::Left, Parts);
+
+        // A fixed number of parts change each frame, whatever the size of the fleet
+        TArray<double> FrameMs;
+        FrameMs.Reserve(NumFrames);
+        int32 NextPart = 0;
+        for (int32 Frame = 0; Frame < WarmupFrames + NumFrames; Frame++)
+        {
+            for (int32 Request = 0; Request < RequestsPerFrame; Request++)
+            {
+                const int32 Index = NextPart++ % Parts.Num();
+                if (Mass->GetPartState(Parts[Index]) == EPartState::ATTACHED)
+                {
+                    Mass->RequestDetach(Parts[Index]);
+                }
+                else
+                {
+                    Mass->RequestAttach(Parts[Index], Sockets[Index]);
+                }
+            }
+
+            const double Start = FPlatformTime::Seconds();
+            Mass->Tick(1.0f / 60.0f);
+            if (Frame >= WarmupFrames)
+            {
+                FrameMs.Add((FPlatformTime::Seconds() - Start) * 1000.0);
+            }
+        }
+
+        FrameMs.Sort();
+        MedianMs[Run] = FrameMs[FrameMs.Num() / 2];
+        P95Ms[Run] = FrameMs[FMath::Min(FMath::FloorToInt(FrameMs.Num() * 0.95), FrameMs.Num() - 1)];
+
+        AddInfo(FString::Printf(TEXT("%d parts, %d requests per frame: Mass tick median %.3f ms, p95 %.3f ms, %d actors"),
+                                Counts[Run], RequestsPerFrame, MedianMs[Run], P95Ms[Run], Mass->GetNumPartActors()));
+        TestTrue(TEXT("Only parts near the viewer should have actors"), Mass->GetNumPartActors() <= NumNear);
+        TestTrue(TEXT("Parts near the viewer should have actors"), NumNear == 0 || Mass->GetNumPartActors() > 0);
+    }
+
+    const double MaxTickMs = GetConfigDouble(TEXT("MaxMassTickMs"), 0.0);
+    if (MaxTickMs > 0.0 && P95Ms[1] > MaxTickMs)
+    {
+        AddError(FString::Printf(TEXT("Regression: p95 Mass tick %.3f ms with %d parts, threshold %.3f"), P95Ms[1], Counts[1], MaxTickMs));
+    }
+
+    // Flat: ten times the parts with the same activity should cost about the same per frame
+    const double MaxScaling = GetConfigDouble(TEXT("MaxMassTickScaling"), 0.0);
+    const double Scaling = MedianMs[1] / FMath::Max(MedianMs[0], UE_DOUBLE_SMALL_NUMBER);
+    if (MaxScaling > 0.0 && Scaling > MaxScaling)
+    {
+        AddError(FString::Printf(TEXT("Regression: Mass tick grew %.2fx from %d to %d parts, threshold %.2fx"),
+                                 Scaling, Counts[0], Counts[1], MaxScaling));
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
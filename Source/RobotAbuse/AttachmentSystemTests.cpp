@@ -1,6 +1,25 @@
 ﻿#include "Misc/AutomationTest.h"
 #include "AttachablePart.h"
+#include "AttachmentJournal.h"
 #include "AttachmentPoint.h"
+#include "AttachmentRegistry.h"
+#include "AttachmentTransaction.h"
+#include "RobotAssembly.h"
+#include "RobotDefinitions.h"
+#include "RobotEventBus.h"
+#include "RobotFleetRenderer.h"
+#include "RobotMassSubsystem.h"
+#include "RobotPartPool.h"
+#include "RobotSnapshot.h"
+#include "RobotSpectatorPawn.h"
+#include "RobotStatusPanel.h"
+#include "RobotTestWorld.h"
+#include "RobotTorso.h"
+#include "Components/ChildActorComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "Framework/Application/SlateApplication.h"
+#include "HAL/IConsoleManager.h"
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(
     FAttachmentCompatibilityTest_Final,
@@ -57,3 +76,866 @@ bool FPartStateTransitionTest_Final::RunTest(const FString& Parameters)
     
     return true;
 }
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FAttachmentRegistryLinkTest,
+    "RobotAbuse.AttachmentRegistry.LinkUnlink",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FAttachmentRegistryLinkTest::RunTest(const FString& Parameters)
+{
+    UAttachmentRegistry* Registry = NewObject<UAttachmentRegistry>();
+
+    UAttachmentPoint* SocketA = NewObject<UAttachmentPoint>();
+    UAttachmentPoint* SocketB = NewObject<UAttachmentPoint>();
+    AAttachablePart* Part = NewObject<AAttachablePart>();
+
+    Registry->Link(Part, SocketA);
+    TestEqual(TEXT("Socket should report the linked part"), Registry->GetPartInSocket(SocketA), Part);
+    TestEqual(TEXT("Part should report the linked socket"), Registry->GetSocketOfPart(Part), SocketA);
+
+    // Moving to another socket frees the first one
+    Registry->Link(Part, SocketB);
+    TestNull(TEXT("Old socket should be empty after relinking"), Registry->GetPartInSocket(SocketA));
+    TestEqual(TEXT("Part should report the new socket"), Registry->GetSocketOfPart(Part), SocketB);
+
+    Registry->UnregisterSocket(SocketB);
+    TestNull(TEXT("Part should have no socket once its socket is gone"), Registry->GetSocketOfPart(Part));
+    TestEqual(TEXT("Only the remaining socket should be registered"), Registry->GetNumSockets(), 1);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FCategoryFilterTest,
+    "RobotAbuse.AttachmentRegistry.CategoryFilter",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FCategoryFilterTest::RunTest(const FString& Parameters)
+{
+    UAttachmentRegistry* Registry = NewObject<UAttachmentRegistry>();
+
+    UAttachmentPoint* LeftSocket = NewObject<UAttachmentPoint>();
+    LeftSocket->AcceptedArmType = EArmType::Left;
+
+    UAttachmentPoint* RightSocket = NewObject<UAttachmentPoint>();
+    RightSocket->AcceptedArmType = EArmType::Right;
+
+    UAttachmentPoint* UniversalSocket = NewObject<UAttachmentPoint>();
+    UniversalSocket->AcceptedArmType = EArmType::Universal;
+
+    Registry->RegisterSocket(LeftSocket);
+    Registry->RegisterSocket(RightSocket);
+    Registry->RegisterSocket(UniversalSocket);
+
+    AAttachablePart* LeftArm = NewObject<AAttachablePart>();
+    LeftArm->ArmType = EArmType::Left;
+
+    // Mask rule must agree with the old arm type rule
+    TestTrue(TEXT("Universal part fits a left socket"), UAttachmentPoint::AreArmTypesCompatible(EArmType::Left, EArmType::Universal));
+    TestFalse(TEXT("Right part does not fit a left socket"), UAttachmentPoint::AreArmTypesCompatible(EArmType::Left, EArmType::Right));
+
+    TArray<UAttachmentPoint*> Compatible;
+    Registry->GatherCompatibleSockets(LeftArm->GetCategoryMask(), Compatible);
+    TestEqual(TEXT("Left arm should fit the left and universal sockets"), Compatible.Num(), 2);
+    TestTrue(TEXT("Left socket should be a candidate"), Compatible.Contains(LeftSocket));
+    TestTrue(TEXT("Universal socket should be a candidate"), Compatible.Contains(UniversalSocket));
+
+    // Occupied sockets drop out of the candidate column
+    Registry->Link(LeftArm, LeftSocket);
+    Compatible.Reset();
+    Registry->GatherCompatibleSockets(LeftArm->GetCategoryMask(), Compatible);
+    TestEqual(TEXT("Only the universal socket should remain"), Compatible.Num(), 1);
+
+    // Categories replace the arm side, Left and Right stay available as names
+    AAttachablePart* TaggedArm = NewObject<AAttachablePart>();
+    TaggedArm->Categories.Add(TEXT("Right"));
+    TestEqual(TEXT("Category names should map onto the side bits"), TaggedArm->GetCategoryMask(), RobotPartCategories::Right);
+
+    Compatible.Reset();
+    Registry->FilterCompatibleSockets(TaggedArm->GetCategoryMask(), { LeftSocket, RightSocket, UniversalSocket }, Compatible);
+    TestEqual(TEXT("Right-tagged arm should fit the right and universal sockets"), Compatible.Num(), 2);
+
+    // Every category of the part has to be accepted, sharing one is not enough
+    AAttachablePart* LeftHand = NewObject<AAttachablePart>();
+    LeftHand->Categories = { TEXT("Left"), TEXT("Hand") };
+    TestFalse(TEXT("Left hand should not fit a socket that only takes left arms"), RobotPartCategories::AreCompatible(LeftSocket->GetAcceptedMask(), LeftHand->GetCategoryMask()));
+
+    Compatible.Reset();
+    Registry->GatherCompatibleSockets(LeftHand->GetCategoryMask(), Compatible);
+    TestEqual(TEXT("No free socket should take a left hand yet"), Compatible.Num(), 0);
+
+    // Changed names are resolved again and the registry reads the new mask
+    UniversalSocket->AcceptedCategories = { TEXT("Left"), TEXT("Hand") };
+    Registry->RefreshSocketMask(UniversalSocket);
+    Compatible.Reset();
+    Registry->GatherCompatibleSockets(LeftHand->GetCategoryMask(), Compatible);
+    TestTrue(TEXT("The re-tagged socket should take the left hand"), Compatible.Num() == 1 && Compatible[0] == UniversalSocket);
+
+    LeftHand->Categories = { TEXT("Right") };
+    TestEqual(TEXT("A part's mask should follow its categories"), LeftHand->GetCategoryMask(), RobotPartCategories::Right);
+
+    // A part without categories is an arm, it does not fit sockets restricted to something else
+    AAttachablePart* DefaultPart = NewObject<AAttachablePart>();
+    UAttachmentPoint* ToolSocket = NewObject<UAttachmentPoint>();
+    ToolSocket->AcceptedCategories = { TEXT("Tool") };
+    Registry->RegisterSocket(ToolSocket);
+    TestFalse(TEXT("Default part should not fit a tool socket"), ToolSocket->IsCompatibleWith(DefaultPart));
+    TestTrue(TEXT("Default part should fit an arm socket"), RightSocket->IsCompatibleWith(DefaultPart));
+
+    Compatible.Reset();
+    Registry->GatherCompatibleSockets(DefaultPart->GetCategoryMask(), Compatible);
+    TestFalse(TEXT("Tool socket should not be a candidate for a default part"), Compatible.Contains(ToolSocket));
+
+    Compatible.Reset();
+    Registry->GatherCompatibleSockets(0, Compatible);
+    TestEqual(TEXT("An empty mask should fit no socket"), Compatible.Num(), 0);
+
+    return true;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FAttachmentTransactionTest,
+    "RobotAbuse.Transaction.ValidateAndCoalesce",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FAttachmentTransactionTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 2;
+    Params.LeftWeight = 1.0f;
+    Params.RightWeight = 0.0f;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(TestWorld.GetWorld());
+    if (!TestNotNull(TEXT("Registry should exist"), Registry))
+    {
+        return false;
+    }
+
+    int32 NumNotifications = 0;
+    FDelegateHandle Handle = Registry->OnAttachmentsChanged.AddLambda([&NumNotifications](TConstArrayView<FAttachmentChange>)
+    {
+        NumNotifications++;
+    });
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    const TArray<UAttachmentPoint*>& Points = TestWorld.GetHomePoints();
+
+    // Only right arms fit here now, and every arm in this world is a left one
+    Points[0]->SetAcceptedArmType(EArmType::Right);
+
+    FAttachmentTransaction Batch;
+    Batch.Detach(Parts[1]);
+    Batch.Attach(Parts[0], Points[1]);
+    Batch.Attach(Parts[2], Points[3]);
+    Batch.Attach(Parts[1], Points[0]);
+
+    AddExpectedError(TEXT("cannot attach"), EAutomationExpectedErrorFlags::Contains, 2);
+    TestEqual(TEXT("Only the valid ops should apply"), Batch.Commit(TestWorld.GetWorld()), 2);
+    TestTrue(TEXT("Detach should apply"), Batch.GetOps()[0].bApplied);
+    TestTrue(TEXT("Attach into a socket an earlier op freed should apply"), Batch.GetOps()[1].bApplied);
+    TestFalse(TEXT("Attach into an occupied socket should be refused"), Batch.GetOps()[2].bApplied);
+    TestFalse(TEXT("Attach into an incompatible socket should be refused"), Batch.GetOps()[3].bApplied);
+
+    TestEqual(TEXT("First arm should have moved"), Parts[0]->GetAttachmentPoint(), Points[1]);
+    TestNull(TEXT("Second arm should be loose"), Parts[1]->GetAttachmentPoint());
+    TestEqual(TEXT("Refused arm should stay where it was"), Parts[2]->GetAttachmentPoint(), Points[2]);
+    TestTrue(TEXT("First arm should sit on its new socket"), Parts[0]->GetActorLocation().Equals(Points[1]->GetComponentLocation(), 0.01f));
+    TestEqual(TEXT("The whole batch should notify once"), NumNotifications, 1);
+
+    // Asking for the socket a part is already in is not an error
+    Batch.Reset();
+    Batch.Attach(Parts[0], Points[1]);
+    TestEqual(TEXT("Re-attaching to the current socket should count as applied"), Batch.Commit(TestWorld.GetWorld()), 1);
+    TestEqual(TEXT("Arm should still be in that socket"), Parts[0]->GetAttachmentPoint(), Points[1]);
+
+    Registry->OnAttachmentsChanged.Remove(Handle);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FPartPoolReuseTest,
+    "RobotAbuse.PartPool.Reuse",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FPartPoolReuseTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 1;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    URobotPartPool* Pool = UWorld::GetSubsystem<URobotPartPool>(TestWorld.GetWorld());
+    UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(TestWorld.GetWorld());
+    if (!TestNotNull(TEXT("Pool should exist"), Pool) || !TestNotNull(TEXT("Registry should exist"), Registry))
+    {
+        return false;
+    }
+
+    AAttachablePart* Part = TestWorld.GetParts()[0];
+    UAttachmentPoint* Socket = TestWorld.GetHomePoints()[0];
+    TestTrue(TEXT("Part should start attached"), Part->IsAttached());
+
+    const int32 NumParts = Registry->GetNumParts();
+
+    // Releasing an attached part frees its socket and takes it out of the registry
+    Pool->Release(Part);
+    TestTrue(TEXT("Released part should be pooled"), Part->IsPooled());
+    TestTrue(TEXT("Socket should be free after release"), Socket->IsAvailable());
+    TestEqual(TEXT("Pooled part should leave the registry"), Registry->GetNumParts(), NumParts - 1);
+    TestEqual(TEXT("Pool should hold the part"), Pool->GetNumFree(Part->GetClass()), 1);
+
+    const FTransform Transform(FVector(100.0f, 200.0f, 300.0f));
+    AAttachablePart* Reused = Pool->Acquire(Part->GetClass(), Transform);
+    TestEqual(TEXT("Acquire should hand back the parked actor"), Reused, Part);
+    TestFalse(TEXT("Reused part should not be pooled"), Reused->IsPooled());
+    TestEqual(TEXT("Reused part should be detached"), Reused->CurrentState, EPartState::DETACHED);
+    TestNull(TEXT("Reused part should have no socket"), Reused->GetAttachmentPoint());
+    TestEqual(TEXT("Reused part should be at the requested location"), Reused->GetActorLocation(), Transform.GetLocation());
+    TestEqual(TEXT("Reused part should be back in the registry"), Registry->GetNumParts(), NumParts);
+
+    // Arms owned by a child actor component are left to it
+    AActor* Owner = TestWorld.GetWorld()->SpawnActor<AActor>();
+    UChildActorComponent* ChildComponent = NewObject<UChildActorComponent>(Owner);
+    ChildComponent->SetChildActorClass(AAttachablePart::StaticClass());
+    ChildComponent->RegisterComponent();
+    AAttachablePart* ChildPart = Cast<AAttachablePart>(ChildComponent->GetChildActor());
+    if (TestNotNull(TEXT("Child actor component should create an arm"), ChildPart))
+    {
+        Pool->Release(ChildPart);
+        TestFalse(TEXT("Child actor arm should not be pooled"), ChildPart->IsPooled());
+        TestEqual(TEXT("Child actor arm should stay with its component"), ChildComponent->GetChildActor(), static_cast<AActor*>(ChildPart));
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FSnapshotRoundTripTest,
+    "RobotAbuse.Snapshot.RoundTrip",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FSnapshotRoundTripTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 4;
+    Params.AttachedRatio = 0.5f;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    TArray<UAttachmentPoint*> SavedPoints;
+    TArray<FVector> SavedLocations;
+    for (AAttachablePart* Part : Parts)
+    {
+        SavedPoints.Add(Part->GetAttachmentPoint());
+        SavedLocations.Add(Part->GetActorLocation());
+    }
+
+    TArray<uint8> Bytes;
+    if (!TestTrue(TEXT("Snapshot should save"), RobotSnapshot::Save(TestWorld.GetWorld(), Bytes)))
+    {
+        return false;
+    }
+
+    // Swap everything around: attached arms come off, loose arms go into their home socket
+    for (int32 i = 0; i < Parts.Num(); i++)
+    {
+        if (Parts[i]->IsAttached())
+        {
+            Parts[i]->DetachFromPoint();
+            Parts[i]->SetActorLocation(FVector(0.0f, 0.0f, -1000.0f - i));
+        }
+        else
+        {
+            Parts[i]->TryAttachTo_Implementation(TestWorld.GetHomePoints()[i]);
+        }
+    }
+
+    TestEqual(TEXT("Restore should change every part"), RobotSnapshot::Restore(TestWorld.GetWorld(), Bytes), Parts.Num());
+
+    for (int32 i = 0; i < Parts.Num(); i++)
+    {
+        TestEqual(TEXT("Part should be back in its saved socket"), Parts[i]->GetAttachmentPoint(), SavedPoints[i]);
+        if (!SavedPoints[i])
+        {
+            TestTrue(TEXT("Loose part should be back at its saved location"), Parts[i]->GetActorLocation().Equals(SavedLocations[i], 0.01f));
+        }
+    }
+
+    TestEqual(TEXT("Restoring the current state should change nothing"), RobotSnapshot::Restore(TestWorld.GetWorld(), Bytes), 0);
+
+    Bytes[Bytes.Num() - 1] ^= 0xFF;
+    AddExpectedError(TEXT("corrupt data"), EAutomationExpectedErrorFlags::Contains, 1);
+    TestEqual(TEXT("A corrupt snapshot should be refused"), RobotSnapshot::Restore(TestWorld.GetWorld(), Bytes), INDEX_NONE);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FAttachmentJournalUndoRedoTest,
+    "RobotAbuse.Journal.UndoRedo",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FAttachmentJournalUndoRedoTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 2;
+    Params.LeftWeight = 1.0f;
+    Params.RightWeight = 0.0f;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(TestWorld.GetWorld());
+    if (!TestNotNull(TEXT("Game worlds should have a journal"), Journal))
+    {
+        return false;
+    }
+    Journal->Clear();
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    const TArray<UAttachmentPoint*>& Points = TestWorld.GetHomePoints();
+    AAttachablePart* Arm = Parts[0];
+    UAttachmentPoint* Home = Points[0];
+    const SIZE_T JournalBytes = Journal->GetAllocatedSize();
+
+    // A whole drag is one step: take the arm off, carry it and drop it
+    Arm->OnClicked_Implementation();
+    Arm->SetActorLocation(FVector(0.0f, 0.0f, 500.0f));
+    Arm->Drop();
+    TestFalse(TEXT("Arm should be off its socket after the drag"), Arm->IsAttached());
+
+    // The drop was recorded in mid-air, where the arm comes to rest replaces it
+    const FVector RestLocation(0.0f, 0.0f, 120.0f);
+    Arm->SetActorLocation(RestLocation, false, nullptr, ETeleportType::ResetPhysics);
+    Journal->AmendRest(Arm);
+
+    // Moving a second arm out of the way and the first into its socket, as one batch
+    FAttachmentTransaction Batch;
+    Batch.Detach(Parts[1]);
+    Batch.Attach(Arm, Points[1]);
+    TestEqual(TEXT("Batch should apply both ops"), Batch.Commit(TestWorld.GetWorld()), 2);
+
+    TestEqual(TEXT("Undoing the batch should be one step"), Journal->Undo(), 1);
+    TestEqual(TEXT("Second arm should be back in its socket"), Parts[1]->GetAttachmentPoint(), Points[1]);
+    TestNull(TEXT("First arm should be loose again"), Arm->GetAttachmentPoint());
+    TestTrue(TEXT("First arm should be where it came to rest"), Arm->GetActorLocation().Equals(RestLocation, 0.01f));
+    TestFalse(TEXT("Undo should not drop the arm again"), Arm->IsFalling());
+
+    TestEqual(TEXT("Undoing the drag should be one step"), Journal->Undo(), 1);
+    TestEqual(TEXT("Arm should be back in its home socket"), Arm->GetAttachmentPoint(), Home);
+    TestFalse(TEXT("Nothing should be left to undo"), Journal->CanUndo());
+
+    TestEqual(TEXT("Redo should replay both steps"), Journal->Redo(5), 2);
+    TestEqual(TEXT("First arm should be in the second socket after redo"), Arm->GetAttachmentPoint(), Points[1]);
+    TestNull(TEXT("Second arm should be loose after redo"), Parts[1]->GetAttachmentPoint());
+
+    // A new change after an undo drops the redo history
+    Journal->Undo();
+    Parts[2]->DetachFromPoint();
+    TestFalse(TEXT("Redo history should be gone after a new change"), Journal->CanRedo());
+
+    // Two players dragging at the same time each get their own step, however their changes interleave
+    Journal->Clear();
+    AActor* PlayerA = TestWorld.GetRobots()[0];
+    AActor* PlayerB = TestWorld.GetRobots()[1];
+    {
+        FAttachmentJournalInstigatorScope Instigator(Journal, PlayerA);
+        Arm->OnClicked_Implementation();
+    }
+    {
+        FAttachmentJournalInstigatorScope Instigator(Journal, PlayerB);
+        Parts[1]->OnClicked_Implementation();
+        Parts[1]->Drop();
+    }
+    {
+        FAttachmentJournalInstigatorScope Instigator(Journal, PlayerA);
+        Arm->Drop();
+    }
+
+    TestEqual(TEXT("Undoing the first player's drag should be one step"), Journal->Undo(), 1);
+    TestNull(TEXT("The second player's arm should still be loose"), Parts[1]->GetAttachmentPoint());
+    TestEqual(TEXT("Undoing the second player's drag should be one step"), Journal->Undo(), 1);
+    TestEqual(TEXT("The second player's arm should be back in its socket"), Parts[1]->GetAttachmentPoint(), Points[1]);
+    TestFalse(TEXT("Both drags should be undone"), Journal->CanUndo());
+
+    // In a session each player undoes and redoes only their own steps
+    {
+        FAttachmentJournalInstigatorScope Instigator(Journal, PlayerA);
+        Arm->OnClicked_Implementation();
+        Arm->Drop();
+    }
+    {
+        FAttachmentJournalInstigatorScope Instigator(Journal, PlayerB);
+        Parts[1]->OnClicked_Implementation();
+        Parts[1]->Drop();
+    }
+
+    TestEqual(TEXT("The first player should undo their own drag"), Journal->UndoBy(PlayerA), 1);
+    TestEqual(TEXT("The first player's arm should be back home"), Arm->GetAttachmentPoint(), Home);
+    TestNull(TEXT("The second player's newer drag should stay"), Parts[1]->GetAttachmentPoint());
+    TestEqual(TEXT("The first player should have nothing left to undo"), Journal->UndoBy(PlayerA), 0);
+
+    TestEqual(TEXT("The first player should redo their own drag"), Journal->RedoBy(PlayerA), 1);
+    TestNull(TEXT("The first player's arm should be loose again"), Arm->GetAttachmentPoint());
+
+    TestEqual(TEXT("The second player should undo their own drag"), Journal->UndoBy(PlayerB), 1);
+    TestEqual(TEXT("The second player's arm should be back in its socket"), Parts[1]->GetAttachmentPoint(), Points[1]);
+    TestNull(TEXT("The first player's arm should stay loose"), Arm->GetAttachmentPoint());
+
+    // The world history passes over steps a player undid themselves
+    TestEqual(TEXT("World undo should take back the first player's drag"), Journal->Undo(), 1);
+    TestEqual(TEXT("The first player's arm should be home after the world undo"), Arm->GetAttachmentPoint(), Home);
+    TestEqual(TEXT("World redo should replay the first player's drag only"), Journal->Redo(), 1);
+    TestEqual(TEXT("The second player's arm should stay in its socket"), Parts[1]->GetAttachmentPoint(), Points[1]);
+
+    // A new change by the second player replaces the step they undid
+    {
+        FAttachmentJournalInstigatorScope Instigator(Journal, PlayerB);
+        Parts[3]->DetachFromPoint();
+    }
+    TestEqual(TEXT("The second player's undone drag should be gone after a new change"), Journal->RedoBy(PlayerB), 0);
+    Journal->Clear();
+
+    // Parking a part in the pool is bookkeeping, not a change to undo
+    Parts[1]->DeactivateForPool();
+    TestFalse(TEXT("Pooling should not be recorded"), Journal->CanUndo());
+
+    TestEqual(TEXT("Recording should not grow the journal"), Journal->GetAllocatedSize(), JournalBytes);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FRobotEventBusCoalesceTest,
+    "RobotAbuse.EventBus.Coalesce",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FRobotEventBusCoalesceTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 2;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(TestWorld.GetWorld());
+    if (!TestNotNull(TEXT("Game worlds should have an event bus"), EventBus))
+    {
+        return false;
+    }
+
+    int32 NumDispatches = 0;
+    TArray<FRobotEvent> Received;
+    FDelegateHandle Handle = EventBus->OnEvents.AddLambda([&NumDispatches, &Received](TConstArrayView<FRobotEvent> Events)
+    {
+        NumDispatches++;
+        Received.Append(Events.GetData(), Events.Num());
+    });
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    AActor* Instigator = TestWorld.GetRobots()[0];
+
+    // The cursor sweeps over three parts in one frame, only the last one is reported
+    EventBus->Post(ERobotEventType::HoverChanged, Parts[0], Instigator);
+    EventBus->Post(ERobotEventType::HoverChanged, Parts[1], Instigator);
+
+    // Two detaches in one batch arrive as socket changes in the same dispatch
+    FAttachmentTransaction Batch;
+    Batch.Detach(Parts[0]);
+    Batch.Detach(Parts[1]);
+    Batch.Commit(TestWorld.GetWorld());
+
+    EventBus->Post(ERobotEventType::HoverChanged, Parts[2], Instigator);
+
+    EventBus->Flush();
+    TestEqual(TEXT("Everything in a frame should go out in one dispatch"), NumDispatches, 1);
+    TestEqual(TEXT("Hover changes should collapse into one event"), Received.Num(), 3);
+    if (Received.Num() == 3)
+    {
+        TestEqual(TEXT("Socket changes should keep their place"), Received[0].Type, ERobotEventType::SocketChanged);
+        TestEqual(TEXT("Socket change should name the old socket"), Received[0].OldPoint, TestWorld.GetHomePoints()[0]);
+        TestNull(TEXT("Detached part should have no new socket"), Received[0].Point);
+        TestEqual(TEXT("The hover should come after the changes posted before it"), Received[2].Type, ERobotEventType::HoverChanged);
+        TestEqual(TEXT("The last hovered part should win"), Received[2].Part, Parts[2]);
+    }
+
+    EventBus->Flush();
+    TestEqual(TEXT("An empty queue should not dispatch"), NumDispatches, 1);
+
+    EventBus->OnEvents.Remove(Handle);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FRobotStatusPanelTest,
+    "RobotAbuse.StatusPanel.Updates",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FRobotStatusPanelTest::RunTest(const FString& Parameters)
+{
+    if (!FSlateApplication::IsInitialized())
+    {
+        AddWarning(TEXT("Slate is not running, the status panel was not tested"));
+        return true;
+    }
+
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 4;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    TSharedRef<SRobotStatusPanel> Panel = SNew(SRobotStatusPanel).World(TestWorld.GetWorld());
+
+    TestEqual(TEXT("Panel should list every part"), Panel->GetNumItems(), Parts.Num());
+    TestEqual(TEXT("Every part should start attached"), Panel->GetNumInState(EPartState::ATTACHED), Parts.Num());
+
+    URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(TestWorld.GetWorld());
+
+    // Take one arm off and hold it, the totals follow once the frame's events go out
+    Parts[0]->OnClicked_Implementation();
+    TestEqual(TEXT("Totals should not change before the events are dispatched"), Panel->GetNumInState(EPartState::HELD), 0);
+
+    EventBus->Flush();
+    TestEqual(TEXT("Held part should be counted"), Panel->GetNumInState(EPartState::HELD), 1);
+    TestEqual(TEXT("Held part should leave the attached total"), Panel->GetNumInState(EPartState::ATTACHED), Parts.Num() - 1);
+
+    Parts[0]->Drop();
+    EventBus->Flush();
+    TestEqual(TEXT("Dropped part should be counted as detached"), Panel->GetNumInState(EPartState::DETACHED), 1);
+    TestEqual(TEXT("Nothing should be held after the drop"), Panel->GetNumInState(EPartState::HELD), 0);
+
+    // Parking a part in the pool removes its row, handing it out again brings the row back
+    Parts[1]->DeactivateForPool();
+    EventBus->Flush();
+    TestEqual(TEXT("A pooled part should leave the list"), Panel->GetNumItems(), Parts.Num() - 1);
+    TestEqual(TEXT("A pooled part should leave the totals"), Panel->GetNumInState(EPartState::ATTACHED), Parts.Num() - 2);
+
+    Parts[1]->ReactivateFromPool(Parts[1]->GetActorTransform());
+    EventBus->Flush();
+    TestEqual(TEXT("A reactivated part should be listed again"), Panel->GetNumItems(), Parts.Num());
+    TestEqual(TEXT("A reactivated part should count as detached"), Panel->GetNumInState(EPartState::DETACHED), 2);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FRobotAssemblyBatchTest,
+    "RobotAbuse.Assembly.Batch",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FRobotAssemblyBatchTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+    TestWorld.BeginPlay();
+
+    URobotPartDefinition* LeftArm = NewObject<URobotPartDefinition>();
+    LeftArm->ArmType = EArmType::Left;
+
+    // A left socket that starts with an arm and an empty right one
+    URobotDefinition* Definition = NewObject<URobotDefinition>();
+    FRobotSocketDefinition LeftSocket;
+    LeftSocket.Name = TEXT("LeftSocket");
+    LeftSocket.RelativeLocation = FVector(0.0f, -60.0f, 0.0f);
+    LeftSocket.AcceptedArmType = EArmType::Left;
+    LeftSocket.InitialPart = LeftArm;
+    Definition->Sockets.Add(LeftSocket);
+
+    FRobotSocketDefinition RightSocket;
+    RightSocket.Name = TEXT("RightSocket");
+    RightSocket.RelativeLocation = FVector(0.0f, 60.0f, 0.0f);
+    RightSocket.AcceptedArmType = EArmType::Right;
+    Definition->Sockets.Add(RightSocket);
+
+    TArray<FSoftObjectPath> Missing;
+    Definition->GetSpawnAssets(Missing);
+    TestEqual(TEXT("An in-memory definition should need no loading"), Missing.Num(), 0);
+
+    FRobotAssemblyBatch Batch(TestWorld.GetWorld());
+    for (int32 i = 0; i < 3; i++)
+    {
+        Batch.Add(*Definition, FTransform(FVector(i * 300.0f, 0.0f, 0.0f)));
+    }
+    Batch.Finish();
+
+    TestEqual(TEXT("Every robot should be spawned"), Batch.Num(), 3);
+    for (const FRobotAssembly& Assembly : Batch.GetAssemblies())
+    {
+        if (!TestNotNull(TEXT("Robot should spawn"), Assembly.Robot) || !TestEqual(TEXT("Robot should have both sockets"), Assembly.Points.Num(), 2))
+        {
+            return false;
+        }
+
+        TestEqual(TEXT("Sockets should be found by their definition name"), UAttachmentPoint::FindByName(Assembly.Robot, TEXT("LeftSocket")), Assembly.Points[0]);
+        TestNull(TEXT("Robots should not use child actor components"), Assembly.Robot->FindComponentByClass<UChildActorComponent>());
+
+        AAttachablePart* Part = Assembly.Parts[0];
+        if (TestNotNull(TEXT("Left socket should get its initial arm"), Part))
+        {
+            TestEqual(TEXT("Initial arm should be attached"), Part->CurrentState, EPartState::ATTACHED);
+            TestEqual(TEXT("Initial arm should sit in its socket"), Part->GetAttachmentPoint(), Assembly.Points[0]);
+            TestEqual(TEXT("Socket should hold its initial arm"), Assembly.Points[0]->AttachedPart, Part);
+            TestEqual(TEXT("Arm should take the part definition's type"), Part->ArmType, EArmType::Left);
+        }
+
+        TestNull(TEXT("Right socket should start without a part"), Assembly.Parts[1]);
+        TestTrue(TEXT("Right socket should be free"), Assembly.Points[1]->IsAvailable());
+        TestTrue(TEXT("Robot should keep its definition for clients to build from"), Assembly.Robot->GetDefinition() == Definition);
+    }
+
+    // A second socket with a name already taken is skipped instead of replacing the first
+    Definition->Sockets.Add(RightSocket);
+    AddExpectedError(TEXT("used twice"), EAutomationExpectedErrorFlags::Contains, 1);
+
+    FRobotAssemblyBatch DuplicateBatch(TestWorld.GetWorld());
+    const int32 DuplicateIndex = DuplicateBatch.Add(*Definition, FTransform(FVector(0.0f, 600.0f, 0.0f)));
+    DuplicateBatch.Finish();
+    TestEqual(TEXT("Duplicate socket should be skipped"), DuplicateBatch.GetAssemblies()[DuplicateIndex].Points.Num(), 2);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FPhysicsDropTest,
+    "RobotAbuse.Physics.Drop",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FPhysicsDropTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 2;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    const TArray<AAttachablePart*>& Parts = TestWorld.GetParts();
+    AAttachablePart* Arm = Parts[0];
+    UStaticMeshComponent* Mesh = Arm->GetMeshComponent();
+
+    TestFalse(TEXT("Attached arms should be kinematic"), Mesh->IsSimulatingPhysics());
+
+    Arm->OnClicked_Implementation();
+    TestFalse(TEXT("Held arms should be kinematic"), Mesh->IsSimulatingPhysics());
+
+    Arm->Drop();
+    TestTrue(TEXT("Dropped arm should fall"), Arm->IsFalling());
+    TestTrue(TEXT("Dropped arm should simulate"), Mesh->IsSimulatingPhysics());
+
+    // Picking it up again mid-fall hands it back to the cursor
+    Arm->OnClicked_Implementation();
+    TestFalse(TEXT("Picked up arm should stop falling"), Arm->IsFalling());
+    TestFalse(TEXT("Picked up arm should be kinematic"), Mesh->IsSimulatingPhysics());
+
+    Arm->Drop();
+    TestTrue(TEXT("Arm should attach while falling"), Arm->TryAttachTo_Implementation(TestWorld.GetHomePoints()[0]));
+    TestFalse(TEXT("Attached arm should stop falling"), Arm->IsFalling());
+    TestFalse(TEXT("Attached arm should be kinematic again"), Mesh->IsSimulatingPhysics());
+    TestEqual(TEXT("Attached arm should sit on its socket"), Arm->GetAttachmentPoint(), TestWorld.GetHomePoints()[0]);
+
+    // Turned off, a drop leaves the part where it was let go
+    IConsoleVariable* DropVar = IConsoleManager::Get().FindConsoleVariable(TEXT("robot.Physics.Drop"));
+    DropVar->Set(false);
+    Arm->OnClicked_Implementation();
+    Arm->Drop();
+    TestFalse(TEXT("Drop without physics should not simulate"), Mesh->IsSimulatingPhysics());
+    DropVar->Set(true);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FFleetStillCursorHoverTest,
+    "RobotAbuse.Fleet.StillCursorHover",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FFleetStillCursorHoverTest::RunTest(const FString& Parameters)
+{
+    IConsoleVariable* Instancing = IConsoleManager::Get().FindConsoleVariable(TEXT("robot.Fleet.Instancing"));
+    if (!TestNotNull(TEXT("robot.Fleet.Instancing should exist"), Instancing))
+    {
+        return false;
+    }
+    const bool bWasEnabled = Instancing->GetBool();
+    Instancing->Set(true, ECVF_SetByCode);
+
+    FRobotTestWorld TestWorld;
+
+    FRobotStressParams Params;
+    Params.NumRobots = 2;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    AAttachablePart* Arm = TestWorld.GetParts()[0];
+    ARobotSpectatorPawn* Pawn = TestWorld.GetWorld()->SpawnActor<ARobotSpectatorPawn>();
+    if (!TestNotNull(TEXT("Spectator pawn should spawn"), Pawn))
+    {
+        Instancing->Set(bWasEnabled, ECVF_SetByCode);
+        return false;
+    }
+    TestTrue(TEXT("Idle attached arm should be drawn by the fleet"), Arm->bInstancedByFleet);
+
+    // The first hover promotes the arm, the ones after it must find the real mesh under the same cursor
+    Pawn->SetSyntheticCursor(Arm->GetActorLocation() + FVector(0.0f, 0.0f, 500.0f), FVector::DownVector);
+    for (int32 Frame = 0; Frame < 5; Frame++)
+    {
+        TestWorld.Tick(1.0f / 60.0f);
+        TestEqual(FString::Printf(TEXT("Frame %d: arm under a still cursor should stay hovered"), Frame), Pawn->GetHoveredTarget(), static_cast<UObject*>(Arm));
+        TestFalse(FString::Printf(TEXT("Frame %d: hovered arm should not go back to the fleet"), Frame), Arm->bInstancedByFleet);
+    }
+
+    Pawn->Destroy();
+    Instancing->Set(bWasEnabled, ECVF_SetByCode);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FClickAttachesSuggestionTest,
+    "RobotAbuse.Interaction.ClickAttachesSuggestion",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FClickAttachesSuggestionTest::RunTest(const FString& Parameters)
+{
+    FRobotTestWorld TestWorld;
+
+    // Loose arms lying next to a robot with free sockets
+    FRobotStressParams Params;
+    Params.NumRobots = 1;
+    Params.AttachedRatio = 0.0f;
+    Params.RightWeight = 0.0f;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    AAttachablePart* Arm = TestWorld.GetParts()[0];
+    UAttachmentPoint* Socket = TestWorld.GetHomePoints()[0];
+    ARobotSpectatorPawn* Pawn = TestWorld.GetWorld()->SpawnActor<ARobotSpectatorPawn>();
+    if (!TestNotNull(TEXT("Spectator pawn should spawn"), Pawn))
+    {
+        return false;
+    }
+
+    Pawn->SetSyntheticCursor(Arm->GetActorLocation() + FVector(0.0f, 0.0f, 500.0f), FVector::DownVector);
+    Pawn->SimulateClick();
+    if (!TestEqual(TEXT("Clicking the arm should pick it up"), Pawn->GetDraggedActor(), static_cast<AActor*>(Arm)))
+    {
+        Pawn->Destroy();
+        return false;
+    }
+
+    // Hold it in front of the socket, inside the assist radius but outside the drop snap radius
+    Pawn->SetSyntheticCursor(Socket->GetComponentLocation() + FVector(80.0f, 0.0f, 500.0f), FVector::DownVector);
+    for (int32 Frame = 0; Frame < 3; Frame++)
+    {
+        TestWorld.Tick(1.0f / 60.0f);
+    }
+
+    TestEqual(TEXT("Drag assist should suggest the socket"), Pawn->GetSuggestedSocket(), Socket);
+    TestTrue(TEXT("Arm should be outside the drop snap radius"), FVector::Dist(Arm->GetActorLocation(), Socket->GetComponentLocation()) > 30.0f);
+
+    Pawn->SimulateClick();
+    TestEqual(TEXT("Click should attach the arm to the suggested socket"), Arm->GetAttachmentPoint(), Socket);
+    TestNull(TEXT("Pawn should let go of the attached arm"), Pawn->GetDraggedActor());
+
+    Pawn->Destroy();
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FMassActorAttachTest,
+    "RobotAbuse.Mass.ActorAttach",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter
+)
+
+bool FMassActorAttachTest::RunTest(const FString& Parameters)
+{
+    // The backend is picked when a world starts
+    IConsoleVariable* MassEnable = IConsoleManager::Get().FindConsoleVariable(TEXT("robot.Mass.Enable"));
+    if (!TestNotNull(TEXT("robot.Mass.Enable should exist"), MassEnable))
+    {
+        return false;
+    }
+    const bool bWasEnabled = MassEnable->GetBool();
+    MassEnable->Set(true);
+    FRobotTestWorld TestWorld;
+    MassEnable->Set(bWasEnabled);
+
+    // One robot with free left sockets at the origin, where the viewer is without a player
+    FRobotStressParams Params;
+    Params.NumRobots = 1;
+    Params.AttachedRatio = 0.0f;
+    Params.RightWeight = 0.0f;
+    TestWorld.Populate(Params);
+    TestWorld.BeginPlay();
+
+    URobotMassSubsystem* Mass = UWorld::GetSubsystem<URobotMassSubsystem>(TestWorld.GetWorld());
+    if (!TestNotNull(TEXT("Mass backend should exist with robot.Mass.Enable"), Mass))
+    {
+        return false;
+    }
+
+    UAttachmentPoint* Point = TestWorld.GetPoints()[0];
+    TArray<FVector> SocketLocations = { Point->GetComponentLocation() };
+    TArray<FVector> PartLocations = { Point->GetComponentLocation() + FVector(0.0f, 100.0f, 0.0f) };
+
+    TArray<FMassEntityHandle> Sockets;
+    TArray<FMassEntityHandle> Parts;
+    Mass->CreateSockets(SocketLocations, EArmType::Left, Sockets);
+    Mass->BindSocket(Sockets[0], Point);
+    Mass->CreateParts(AAttachablePart::StaticClass(), PartLocations, EArmType::Left, Parts);
+
+    // In range: tagged on the first tick, given an actor on the next
+    Mass->Tick(1.0f / 60.0f);
+    Mass->Tick(1.0f / 60.0f);
+    if (!TestEqual(TEXT("Part next to the viewer should have an actor"), Mass->GetNumPartActors(), 1))
+    {
+        return false;
+    }
+
+    // The actor still has the old state when the visual sync runs, it must not win over the request
+    Mass->RequestAttach(Parts[0], Sockets[0]);
+    Mass->Tick(1.0f / 60.0f);
+    Mass->Tick(1.0f / 60.0f);
+
+    TestEqual(TEXT("Entity should stay attached"), Mass->GetPartState(Parts[0]), EPartState::ATTACHED);
+    TestTrue(TEXT("Entity should sit in the socket"), Mass->GetPartSocket(Parts[0]) == Sockets[0]);
+    TestTrue(TEXT("Actor should end up on the socket component"), Point->AttachedPart && Point->AttachedPart->IsAttached());
+
+    // Requests for a socket that is not there are turned down, not asserted on
+    Mass->RequestDetach(Parts[0]);
+    Mass->Tick(1.0f / 60.0f);
+    Mass->RequestAttach(Parts[0], FMassEntityHandle());
+    Mass->Tick(1.0f / 60.0f);
+    TestEqual(TEXT("Attach to an unset socket should be rejected"), Mass->GetPartState(Parts[0]), EPartState::DETACHED);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
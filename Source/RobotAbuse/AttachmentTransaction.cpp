@@ -0,0 +1,171 @@
+#include "AttachmentTransaction.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "AttachmentJournal.h"
+#include "AttachmentPoint.h"
+#include "AttachmentRegistry.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+
+void FAttachmentTransaction::Attach(AAttachablePart* Part, UAttachmentPoint* Point)
+{
+	FAttachmentOp& Op = Ops.AddDefaulted_GetRef();
+	Op.Type = EAttachmentOpType::Attach;
+	Op.Part = Part;
+	Op.Point = Point;
+}
+
+void FAttachmentTransaction::Detach(AAttachablePart* Part)
+{
+	FAttachmentOp& Op = Ops.AddDefaulted_GetRef();
+	Op.Type = EAttachmentOpType::Detach;
+	Op.Part = Part;
+}
+
+void FAttachmentTransaction::Validate()
+{
+	// Occupancy as it will be after the ops seen so far, layered over the live state
+	TMap<const UAttachmentPoint*, const AAttachablePart*> SocketOccupant;
+	TMap<const AAttachablePart*, const UAttachmentPoint*> PartSocket;
+	SocketOccupant.Reserve(Ops.Num());
+	PartSocket.Reserve(Ops.Num());
+
+	auto GetOccupant = [&SocketOccupant](const UAttachmentPoint* Point) -> const AAttachablePart*
+	{
+		const AAttachablePart* const* Found = SocketOccupant.Find(Point);
+		return Found ? *Found : Point->AttachedPart;
+	};
+
+	auto GetSocket = [&PartSocket](const AAttachablePart* Part) -> const UAttachmentPoint*
+	{
+		const UAttachmentPoint* const* Found = PartSocket.Find(Part);
+		return Found ? *Found : Part->GetAttachmentPoint();
+	};
+
+	for (FAttachmentOp& Op : Ops)
+	{
+		Op.bApplied = false;
+
+		if (!IsValid(Op.Part))
+		{
+			continue;
+		}
+
+		const UAttachmentPoint* CurrentSocket = GetSocket(Op.Part);
+
+		if (Op.Type == EAttachmentOpType::Detach)
+		{
+			if (CurrentSocket)
+			{
+				SocketOccupant.Add(CurrentSocket, nullptr);
+				PartSocket.Add(Op.Part, nullptr);
+				Op.bApplied = true;
+			}
+			continue;
+		}
+
+		// Already there, nothing to do but it is not an error either
+		if (Op.Point && Op.Point == CurrentSocket)
+		{
+			Op.bApplied = true;
+			continue;
+		}
+
+		// Same rule as CanAcceptPart, with availability taken from the simulated state
+		if (!IsValid(Op.Point) || GetOccupant(Op.Point) != nullptr || !Op.Point->IsCompatibleWith(Op.Part))
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("Attachment transaction: %s cannot attach to %s"),
+				*GetNameSafe(Op.Part), *GetNameSafe(Op.Point));
+			continue;
+		}
+
+		if (CurrentSocket)
+		{
+			SocketOccupant.Add(CurrentSocket, nullptr);
+		}
+		SocketOccupant.Add(Op.Point, Op.Part);
+		PartSocket.Add(Op.Part, Op.Point);
+		Op.bApplied = true;
+	}
+}
+
+int32 FAttachmentTransaction::Commit(UWorld* World)
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::AttachmentTransaction");
+
+	Validate();
+
+	// Every registry change below goes out as one notification when the scope closes
+	FAttachmentBatchScope BatchScope(UWorld::GetSubsystem<UAttachmentRegistry>(World));
+
+	// And the whole batch undoes as one step
+	FAttachmentJournalScope JournalStep(UWorld::GetSubsystem<UAttachmentJournal>(World));
+
+	// Hold every moving part's transform and overlap update until the whole batch is applied,
+	// the per-part scopes in AttachToPoint nest inside these
+	TArray<USceneComponent*, TInlineAllocator<16>> Roots;
+	TSet<USceneComponent*, DefaultKeyFuncs<USceneComponent*>, TInlineSetAllocator<16>> ScopedRoots;
+	Roots.Reserve(Ops.Num());
+	ScopedRoots.Reserve(Ops.Num());
+	for (const FAttachmentOp& Op : Ops)
+	{
+		USceneComponent* Root = Op.bApplied ? Op.Part->GetRootComponent() : nullptr;
+		bool bAlreadyScoped = false;
+		if (Root)
+		{
+			ScopedRoots.Add(Root, &bAlreadyScoped);
+		}
+		if (Root && !bAlreadyScoped)
+		{
+			Roots.Add(Root);
+		}
+	}
+
+	// The scopes are stack objects their component keeps a pointer to, so they are built in place
+	// in storage sized up front that never moves
+	TArray<TTypeCompatibleBytes<FScopedMovementUpdate>, TInlineAllocator<16>> MovementScopes;
+	MovementScopes.SetNumUninitialized(Roots.Num());
+	for (int32 Index = 0; Index < Roots.Num(); ++Index)
+	{
+		new (MovementScopes[Index].GetTypedPtr()) FScopedMovementUpdate(Roots[Index], EScopedUpdate::DeferredUpdates);
+	}
+
+	int32 NumApplied = 0;
+	for (const FAttachmentOp& Op : Ops)
+	{
+		if (!Op.bApplied)
+		{
+			continue;
+		}
+
+		if (Op.Type == EAttachmentOpType::Attach && Op.Part->GetAttachmentPoint() == Op.Point)
+		{
+			// Re-attach to the socket the part is already in
+		}
+		else if (Op.Type == EAttachmentOpType::Detach)
+		{
+			Op.Part->DetachFromPoint();
+		}
+		else
+		{
+			// Already validated, so this skips TryAttachTo's pick-up handling. AttachPart still checks
+			// CanAcceptPart, which holds here because the ops before this one freed the socket
+			if (Op.Part->GetAttachmentPoint())
+			{
+				Op.Part->DetachFromPoint();
+			}
+			Op.Point->AttachPart(Op.Part);
+			Op.Part->AttachToPoint(Op.Point);
+		}
+
+		NumApplied++;
+	}
+
+	// Apply the deferred updates, last opened first, before the registry notification goes out
+	for (int32 Index = MovementScopes.Num() - 1; Index >= 0; --Index)
+	{
+		DestructItem(MovementScopes[Index].GetTypedPtr());
+	}
+
+	return NumApplied;
+}
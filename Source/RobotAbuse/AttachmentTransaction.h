@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AAttachablePart;
+class UAttachmentPoint;
+class UWorld;
+
+enum class EAttachmentOpType : uint8
+{
+	Attach,
+	Detach
+};
+
+/** One queued operation and whether the commit applied it */
+struct FAttachmentOp
+{
+	EAttachmentOpType Type = EAttachmentOpType::Attach;
+	AAttachablePart* Part = nullptr;
+	UAttachmentPoint* Point = nullptr;
+	bool bApplied = false;
+};
+
+/**
+ * Batch of attach/detach operations applied in one pass.
+ * Commit first validates every op in order against the sockets' compatibility and the occupancy the
+ * earlier ops in the batch will leave behind, then applies the valid ones with deferred movement
+ * updates and sends a single coalesced UAttachmentRegistry change notification at the end.
+ * The applied ops are one UAttachmentJournal step.
+ * Attaching a part to the socket it is already in counts as applied and changes nothing.
+ * Invalid ops are skipped with a warning, the rest of the batch still goes through.
+ */
+class ROBOTABUSE_API FAttachmentTransaction
+{
+public:
+	void Reserve(int32 NumOps) { Ops.Reserve(NumOps); }
+	void Reset() { Ops.Reset(); }
+
+	void Attach(AAttachablePart* Part, UAttachmentPoint* Point);
+	void Detach(AAttachablePart* Part);
+
+	/** Validate and apply every queued op. Returns how many were applied */
+	int32 Commit(UWorld* World);
+
+	int32 Num() const { return Ops.Num(); }
+	TConstArrayView<FAttachmentOp> GetOps() const { return Ops; }
+
+private:
+	void Validate();
+
+	TArray<FAttachmentOp> Ops;
+};
@@ -0,0 +1,158 @@
+#include "DragAssist.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "AttachmentPointSubsystem.h"
+#include "AttachmentRegistry.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static TAutoConsoleVariable<bool> CVarRobotDragAssist(
+	TEXT("robot.Interaction.DragAssist"),
+	true,
+	TEXT("Highlight the best compatible socket near a dragged part every frame."));
+
+bool FDragAssist::IsEnabled()
+{
+	return CVarRobotDragAssist.GetValueOnGameThread();
+}
+
+UAttachmentPoint* FDragAssist::Update(AAttachablePart* Part, const FDragAssistView& View, const FDragAssistSettings& Settings)
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::DragAssist");
+
+	UWorld* World = Part ? Part->GetWorld() : nullptr;
+	const UAttachmentPointSubsystem* Spatial = UWorld::GetSubsystem<UAttachmentPointSubsystem>(World);
+	const UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(World);
+
+	if (!Spatial || !Registry)
+	{
+		SetSuggestion(nullptr);
+		return nullptr;
+	}
+
+	const FVector PartLocation = Part->GetActorLocation();
+
+	// The grid only holds empty sockets, the registry's packed masks drop the incompatible ones
+	Nearby.Reset();
+	Candidates.Reset();
+	Spatial->GatherPointsInRadius(PartLocation, Settings.Radius, Nearby);
+	Registry->FilterCompatibleSockets(Part->GetCategoryMask(), Nearby, Candidates);
+
+	Locations.Reset(Candidates.Num());
+	for (const UAttachmentPoint* Point : Candidates)
+	{
+		Locations.Add(Point->GetComponentLocation());
+	}
+
+	bool bOverBudget = false;
+	const int32 Best = FindBest(Locations, PartLocation, View, Settings, &bOverBudget);
+
+	if (bOverBudget)
+	{
+		ROBOT_CSV_COUNT(DragAssistOverBudget);
+	}
+
+	SetSuggestion(Best != INDEX_NONE ? Candidates[Best] : nullptr);
+	return GetSuggestion();
+}
+
+void FDragAssist::Clear()
+{
+	SetSuggestion(nullptr);
+}
+
+void FDragAssist::SetSuggestion(UAttachmentPoint* Point)
+{
+	UAttachmentPoint* Previous = Suggestion.Get();
+	if (Previous == Point)
+	{
+		return;
+	}
+
+	if (Previous)
+	{
+		Previous->SetHighlighted(false);
+	}
+
+	Suggestion = Point;
+
+	if (Point)
+	{
+		Point->SetHighlighted(true);
+	}
+}
+
+int32 FDragAssist::FindBest(TConstArrayView<FVector> InLocations, const FVector& PartLocation, const FDragAssistView& View,
+	const FDragAssistSettings& Settings, bool* bOutOverBudget)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const uint64 BudgetCycles = static_cast<uint64>(Settings.BudgetMicroseconds * 1.0e-6 / FPlatformTime::GetSecondsPerCycle64());
+
+	// Everything the inner loop needs is normalised once here, so each term lands in 0..1
+	const double InvRadiusSq = 1.0 / FMath::Max(FMath::Square(Settings.Radius), UE_KINDA_SMALL_NUMBER);
+	const double CosMaxAngle = FMath::Cos(FMath::DegreesToRadians(Settings.MaxAngleDegrees));
+	const double InvAngleRange = 1.0 / FMath::Max(1.0 - CosMaxAngle, UE_KINDA_SMALL_NUMBER);
+	const double InvScreenRadiusSq = 1.0 / FMath::Max(FMath::Square(Settings.ScreenRadius), UE_KINDA_SMALL_NUMBER);
+	const FVector RayDirection = View.RayDirection.GetSafeNormal();
+
+	int32 BestIndex = INDEX_NONE;
+	double BestScore = TNumericLimits<double>::Max();
+	bool bOverBudget = false;
+
+	constexpr int32 ChunkSize = 32;
+	for (int32 Base = 0; Base < InLocations.Num() && !bOverBudget; Base += ChunkSize)
+	{
+		const int32 End = FMath::Min(Base + ChunkSize, InLocations.Num());
+
+		for (int32 i = Base; i < End; i++)
+		{
+			const FVector& Location = InLocations[i];
+
+			const double DistanceTerm = FVector::DistSquared(Location, PartLocation) * InvRadiusSq;
+
+			const FVector ToSocket = Location - View.RayOrigin;
+			const double ToSocketSize = ToSocket.Size();
+			const double Cos = ToSocketSize > UE_KINDA_SMALL_NUMBER ? FVector::DotProduct(ToSocket, RayDirection) / ToSocketSize : 1.0;
+			const double AngleTerm = (1.0 - Cos) * InvAngleRange;
+
+			double ScreenTerm = 0.0;
+			if (View.bHasProjection)
+			{
+				const FVector4 Clip = View.ViewProjection.TransformFVector4(FVector4(Location, 1.0));
+				if (Clip.W <= 0.0)
+				{
+					continue;
+				}
+
+				const double InvW = 1.0 / Clip.W;
+				const FVector2D Screen(View.ViewMin.X + (0.5 + Clip.X * InvW * 0.5) * View.ViewSize.X,
+					View.ViewMin.Y + (0.5 - Clip.Y * InvW * 0.5) * View.ViewSize.Y);
+				ScreenTerm = FVector2D::DistSquared(Screen, View.CursorPosition) * InvScreenRadiusSq;
+			}
+
+			// Out of range on any axis disqualifies, the rest is a weighted sum where lower is better
+			if (DistanceTerm > 1.0 || AngleTerm > 1.0 || ScreenTerm > 1.0)
+			{
+				continue;
+			}
+
+			const double Score = Settings.DistanceWeight * DistanceTerm + Settings.AngleWeight * AngleTerm + Settings.ScreenWeight * ScreenTerm;
+			if (Score < BestScore)
+			{
+				BestScore = Score;
+				BestIndex = i;
+			}
+		}
+
+		bOverBudget = End < InLocations.Num() && FPlatformTime::Cycles64() - StartCycles > BudgetCycles;
+	}
+
+	if (bOutOverBudget)
+	{
+		*bOutOverBudget = bOverBudget;
+	}
+
+	return BestIndex;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DragAssist.generated.h"
+
+class AAttachablePart;
+class UAttachmentPoint;
+
+/** Tuning for the socket suggested while a part is dragged */
+USTRUCT(BlueprintType)
+struct FDragAssistSettings
+{
+	GENERATED_BODY()
+
+	/** Sockets further than this from the held part are never suggested */
+	UPROPERTY(EditAnywhere, Category = "Drag Assist")
+	float Radius = 150.0f;
+
+	/** Largest angle between the cursor ray and a socket that still counts as aimed at */
+	UPROPERTY(EditAnywhere, Category = "Drag Assist")
+	float MaxAngleDegrees = 25.0f;
+
+	/** Largest cursor distance on screen, in pixels, when a projection is available */
+	UPROPERTY(EditAnywhere, Category = "Drag Assist")
+	float ScreenRadius = 120.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Drag Assist")
+	float DistanceWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Drag Assist")
+	float AngleWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Drag Assist")
+	float ScreenWeight = 1.0f;
+
+	/** Hard cap on scoring time per frame, the best socket found so far wins when it runs out */
+	UPROPERTY(EditAnywhere, Category = "Drag Assist")
+	float BudgetMicroseconds = 50.0f;
+};
+
+/** What the player is looking through this frame */
+struct FDragAssistView
+{
+	FVector RayOrigin = FVector::ZeroVector;
+	FVector RayDirection = FVector::ForwardVector;
+
+	// Screen-space scoring only runs with a projection, synthetic input has none
+	bool bHasProjection = false;
+	FMatrix ViewProjection = FMatrix::Identity;
+	FVector2D ViewMin = FVector2D::ZeroVector;
+	FVector2D ViewSize = FVector2D::ZeroVector;
+	FVector2D CursorPosition = FVector2D::ZeroVector;
+};
+
+/**
+ * Drag assist: every frame while a part is held, scores the empty compatible sockets around it by
+ * distance, cursor angle and screen distance, and highlights the best one so the player sees where
+ * the part can go. The scoring kernel runs over packed locations and stops at a fixed time budget,
+ * so hundreds of sockets in range cost the same bounded time. Toggle with robot.Interaction.DragAssist.
+ */
+class ROBOTABUSE_API FDragAssist
+{
+public:
+	/** Rescore around Part and move the highlight to the new best socket. Call once per frame while dragging */
+	UAttachmentPoint* Update(AAttachablePart* Part, const FDragAssistView& View, const FDragAssistSettings& Settings);
+
+	/** Drop the suggestion and its highlight */
+	void Clear();
+
+	UAttachmentPoint* GetSuggestion() const { return Suggestion.Get(); }
+
+	static bool IsEnabled();
+
+	/**
+	 * The scoring kernel. Returns the index of the best location, INDEX_NONE if none qualifies.
+	 * Stops once the budget is spent and reports that through bOutOverBudget
+	 */
+	static int32 FindBest(TConstArrayView<FVector> Locations, const FVector& PartLocation, const FDragAssistView& View,
+		const FDragAssistSettings& Settings, bool* bOutOverBudget = nullptr);
+
+private:
+	void SetSuggestion(UAttachmentPoint* Point);
+
+	TWeakObjectPtr<UAttachmentPoint> Suggestion;
+
+	// Scratch buffers kept between frames so scoring never allocates
+	TArray<UAttachmentPoint*> Nearby;
+	TArray<UAttachmentPoint*> Candidates;
+	TArray<FVector> Locations;
+};
@@ -0,0 +1,260 @@
+#include "InteractionQuery.h"
+#include "RobotAbuse.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "Framework/Application/SlateApplication.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Widgets/SViewport.h"
+
+static TAutoConsoleVariable<bool> CVarRobotAsyncHover(
+	TEXT("robot.Interaction.AsyncHover"),
+	false,
+	TEXT("Trace hover targets with AsyncLineTraceByChannel and consume the result next frame."));
+
+static TAutoConsoleVariable<bool> CVarRobotAsyncDragTarget(
+	TEXT("robot.Interaction.AsyncDragTarget"),
+	false,
+	TEXT("Trace the drop target under a dragged part asynchronously so clicks can reuse the result."));
+
+bool FInteractionQuery::IsAsync(EInteractionQueryType Type)
+{
+	switch (Type)
+	{
+	case EInteractionQueryType::Hover: return CVarRobotAsyncHover.GetValueOnGameThread();
+	case EInteractionQueryType::DragTarget: return CVarRobotAsyncDragTarget.GetValueOnGameThread();
+	default: return false;
+	}
+}
+
+// Cursor position in viewport pixels straight from the platform, bypassing the position cached by the last input pump
+static bool GetLiveMousePosition(APlayerController* PC, FVector2D& OutPosition)
+{
+	const ULocalPlayer* LocalPlayer = PC->GetLocalPlayer();
+	UGameViewportClient* ViewportClient = LocalPlayer ? LocalPlayer->ViewportClient.Get() : nullptr;
+	if (!ViewportClient || !ViewportClient->Viewport || !FSlateApplication::IsInitialized())
+	{
+		return false;
+	}
+
+	const TSharedPtr<SViewport> ViewportWidget = ViewportClient->GetGameViewportWidget();
+	if (!ViewportWidget.IsValid())
+	{
+		return false;
+	}
+
+	const FGeometry& Geometry = ViewportWidget->GetCachedGeometry();
+	const FVector2D LocalSize = Geometry.GetLocalSize();
+	if (LocalSize.X <= 0.0f || LocalSize.Y <= 0.0f)
+	{
+		return false;
+	}
+
+	// Outside the viewport counts as no cursor, like APlayerController::GetMousePosition
+	const FVector2D Local = Geometry.AbsoluteToLocal(FSlateApplication::Get().GetCursorPos());
+	if (Local.X < 0.0f || Local.Y < 0.0f || Local.X >= LocalSize.X || Local.Y >= LocalSize.Y)
+	{
+		return false;
+	}
+
+	// Slate units to viewport pixels
+	OutPosition = Local * FVector2D(ViewportClient->Viewport->GetSizeXY()) / LocalSize;
+	return true;
+}
+
+void FInteractionQuery::Update(APlayerController* PC, bool bLiveCursor)
+{
+	Controller = PC;
+
+	PollAsync();
+
+	// The override owns the ray, it bumps the generation itself when it moves
+	if (bRayOverride)
+	{
+		return;
+	}
+
+	FVector2D NewMousePosition;
+	const bool bHasMouse = PC && ((bLiveCursor && GetLiveMousePosition(PC, NewMousePosition))
+		|| PC->GetMousePosition(NewMousePosition.X, NewMousePosition.Y));
+	if (!bHasMouse)
+	{
+		// No cursor (e.g. mouse left the viewport), keep the last result but never trace from it
+		bHasRay = false;
+		return;
+	}
+
+	FVector NewViewLocation;
+	FRotator NewViewRotation;
+	PC->GetPlayerViewPoint(NewViewLocation, NewViewRotation);
+
+	const bool bMoved = !bHasRay
+		|| !NewMousePosition.Equals(MousePosition, 0.1f)
+		|| !NewViewLocation.Equals(ViewLocation, 0.01f)
+		|| !NewViewRotation.Equals(ViewRotation, 0.001f);
+
+	if (!bMoved)
+	{
+		return;
+	}
+
+	MousePosition = NewMousePosition;
+	ViewLocation = NewViewLocation;
+	ViewRotation = NewViewRotation;
+	TraceDistance = PC->HitResultTraceDistance;
+
+	bHasRay = PC->DeprojectScreenPositionToWorld(MousePosition.X, MousePosition.Y, RayOrigin, RayDirection);
+	++RayGeneration;
+}
+
+void FInteractionQuery::SetRayOverride(UWorld* InWorld, const FVector& Origin, const FVector& Direction)
+{
+	const FVector NewDirection = Direction.GetSafeNormal();
+	const bool bMoved = !bRayOverride
+		|| OverrideWorld.Get() != InWorld
+		|| !Origin.Equals(RayOrigin, 0.01f)
+		|| !NewDirection.Equals(RayDirection, 0.0001f);
+
+	OverrideWorld = InWorld;
+	bRayOverride = true;
+	bHasRay = InWorld != nullptr;
+
+	if (bMoved)
+	{
+		RayOrigin = Origin;
+		RayDirection = NewDirection;
+		++RayGeneration;
+	}
+}
+
+void FInteractionQuery::ClearRayOverride()
+{
+	if (bRayOverride)
+	{
+		bRayOverride = false;
+		bHasRay = false;
+		OverrideWorld.Reset();
+		++RayGeneration;
+	}
+}
+
+const FHitResult& FInteractionQuery::GetHit(EInteractionQueryType Type)
+{
+	if (IsHitCurrent())
+	{
+		return Hit;
+	}
+
+	if (IsAsync(Type))
+	{
+		// Serve the last known hit, the fresh one lands next frame
+		RequestAsync();
+	}
+	else if (Type == EInteractionQueryType::Click || LastTraceFrame != GFrameCounter)
+	{
+		// Clicks always act on the current ray, other readers share one trace per frame
+		TraceSync();
+	}
+
+	return Hit;
+}
+
+void FInteractionQuery::Prefetch(EInteractionQueryType Type)
+{
+	if (!IsHitCurrent() && IsAsync(Type))
+	{
+		RequestAsync();
+	}
+}
+
+void FInteractionQuery::TraceSync()
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::CursorTrace");
+	ROBOT_CSV_COUNT(TracesPerFrame);
+
+	LastTraceFrame = GFrameCounter;
+
+	UWorld* World = GetWorld();
+	FHitResult NewHit;
+
+	if (World && bHasRay)
+	{
+		// Same trace GetHitResultUnderCursor would run, built from the ray we already have
+		World->LineTraceSingleByChannel(NewHit, RayOrigin, RayOrigin + RayDirection * TraceDistance, ECC_Visibility,
+			FCollisionQueryParams(SCENE_QUERY_STAT(RobotCursorTrace), false));
+	}
+
+	SetHit(NewHit, RayGeneration);
+}
+
+void FInteractionQuery::RequestAsync()
+{
+	UWorld* World = GetWorld();
+
+	// One trace in flight at a time, and only if it is not already for this ray
+	if (!World || !bHasRay || (PendingTrace.IsValid() && PendingGeneration == RayGeneration))
+	{
+		return;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::CursorTraceAsync");
+	ROBOT_CSV_COUNT(TracesPerFrame);
+
+	// A trace still in flight for an older ray is abandoned, only the newest ray matters
+	PendingGeneration = RayGeneration;
+	PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, RayOrigin,
+		RayOrigin + RayDirection * TraceDistance, ECC_Visibility,
+		FCollisionQueryParams(SCENE_QUERY_STAT(RobotCursorTraceAsync), false),
+		FCollisionResponseParams::DefaultResponseParam, nullptr, PendingGeneration);
+}
+
+void FInteractionQuery::PollAsync()
+{
+	UWorld* World = GetWorld();
+
+	if (!World || !PendingTrace.IsValid())
+	{
+		return;
+	}
+
+	FTraceDatum Datum;
+	if (World->QueryTraceData(PendingTrace, Datum))
+	{
+		PendingTrace = FTraceHandle();
+
+		// Results can land out of order with a sync trace, never replace a newer hit with an older one
+		if (Datum.UserData >= HitGeneration)
+		{
+			SetHit(Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult(), Datum.UserData);
+		}
+	}
+	else if (!World->IsTraceHandleValid(PendingTrace, false))
+	{
+		// Result expired before we read it, the next query will ask again
+		PendingTrace = FTraceHandle();
+	}
+}
+
+void FInteractionQuery::SetHit(const FHitResult& NewHit, uint32 Generation)
+{
+	Hit = NewHit;
+	HitGeneration = Generation;
+
+	// The hit may be a frame old, drop it if the actor is gone by now
+	if (Hit.HasValidHitObjectHandle() && !IsValid(Hit.GetActor()))
+	{
+		Hit = FHitResult();
+	}
+}
+
+UWorld* FInteractionQuery::GetWorld() const
+{
+	if (bRayOverride)
+	{
+		return OverrideWorld.Get();
+	}
+
+	const APlayerController* PC = Controller.Get();
+	return PC ? PC->GetWorld() : nullptr;
+}
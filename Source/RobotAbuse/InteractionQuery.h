@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "WorldCollision.h"
+
+class APlayerController;
+
+/** Who is asking for the hit under the cursor. Hover and drag-target can run asynchronously */
+enum class EInteractionQueryType : uint8
+{
+	Hover,
+	DragTarget,
+	Click
+};
+
+/**
+ * Cursor query shared by hover, click and drag.
+ * The cursor ray is refreshed every frame, but the line trace only runs when the cursor or
+ * camera moved since the last trace, and never more than once per frame.
+ *
+ * Hover and drag-target queries can be switched to AsyncLineTraceByChannel with
+ * robot.Interaction.AsyncHover / robot.Interaction.AsyncDragTarget. Async results arrive a frame
+ * later and are tagged with the ray generation they were traced for; clicks only reuse a result
+ * traced for the current ray and otherwise trace synchronously, so they always act on what is
+ * under the cursor right now.
+ */
+class ROBOTABUSE_API FInteractionQuery
+{
+public:
+	/**
+	 * Refresh the cursor ray from the controller and collect finished async traces. Call once per frame.
+	 * With bLiveCursor the position is read from the OS cursor right now instead of the viewport's
+	 * copy from the start of the frame, for callers that sample late in the frame
+	 */
+	void Update(APlayerController* PC, bool bLiveCursor = false);
+
+	/**
+	 * Use a world-space ray instead of the controller's cursor until cleared. Needs no controller or
+	 * viewport, so synthetic input can drive interaction headless
+	 */
+	void SetRayOverride(UWorld* InWorld, const FVector& Origin, const FVector& Direction);
+	void ClearRayOverride();
+	bool HasRayOverride() const { return bRayOverride; }
+
+	/** Force the next query to trace again, e.g. after the scene under the cursor changed */
+	void Invalidate() { ++RayGeneration; }
+
+	/** Hit under the cursor for the given consumer, shared by every reader this frame */
+	const FHitResult& GetHit(EInteractionQueryType Type);
+
+	/** Queue an async trace for the current ray if Type runs async, so a later GetHit is already fresh */
+	void Prefetch(EInteractionQueryType Type);
+
+	/** True if the cached hit was traced for the cursor ray as it is now */
+	bool IsHitCurrent() const { return HitGeneration == RayGeneration; }
+
+	bool HasRay() const { return bHasRay; }
+	const FVector& GetRayOrigin() const { return RayOrigin; }
+	const FVector& GetRayDirection() const { return RayDirection; }
+
+	static bool IsAsync(EInteractionQueryType Type);
+
+private:
+	void TraceSync();
+	void RequestAsync();
+	void PollAsync();
+	void SetHit(const FHitResult& NewHit, uint32 Generation);
+
+	UWorld* GetWorld() const;
+
+	TWeakObjectPtr<APlayerController> Controller;
+
+	// Set while the ray comes from SetRayOverride, traces then run in this world
+	TWeakObjectPtr<UWorld> OverrideWorld;
+	bool bRayOverride = false;
+
+	// Inputs the ray was built from
+	FVector2D MousePosition = FVector2D::ZeroVector;
+	FVector ViewLocation = FVector::ZeroVector;
+	FRotator ViewRotation = FRotator::ZeroRotator;
+
+	FVector RayOrigin = FVector::ZeroVector;
+	FVector RayDirection = FVector::ForwardVector;
+	float TraceDistance = 100000.0f;
+	bool bHasRay = false;
+
+	// Bumped whenever the ray changes or the result is invalidated
+	uint32 RayGeneration = 1;
+
+	FHitResult Hit;
+	uint32 HitGeneration = 0;
+	uint64 LastTraceFrame = MAX_uint64;
+
+	// Async trace in flight, its generation travels as the trace user data
+	FTraceHandle PendingTrace;
+	uint32 PendingGeneration = 0;
+};
@@ -0,0 +1,195 @@
+#include "InteractionTarget.h"
+#include "IAttachable.h"
+#include "IClickable.h"
+#include "IDraggable.h"
+#include "IHoverable.h"
+
+namespace
+{
+	// True if every listed event resolves to a C++ function on this class, i.e. no Blueprint override
+	bool AreEventsNative(const UClass* Class, TConstArrayView<FName> EventNames)
+	{
+		for (const FName& EventName : EventNames)
+		{
+			const UFunction* Function = Class->FindFunctionByName(EventName);
+			if (!Function || !Function->HasAnyFunctionFlags(FUNC_Native))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void AddCapability(FInteractionClassInfo& Info, const UClass* Class, EInteractionCapability Capability,
+		const UClass* InterfaceClass, TConstArrayView<FName> EventNames)
+	{
+		if (!Class->ImplementsInterface(InterfaceClass))
+		{
+			return;
+		}
+
+		Info.Capabilities |= Capability;
+
+		if (AreEventsNative(Class, EventNames))
+		{
+			Info.NativeCapabilities |= Capability;
+		}
+	}
+
+	FInteractionClassInfo BuildClassInfo(const UClass* Class)
+	{
+		const FName ClickEvents[] = { GET_FUNCTION_NAME_CHECKED(IClickable, OnClicked) };
+		const FName HoverEvents[] = { GET_FUNCTION_NAME_CHECKED(IHoverable, OnHoverBegin), GET_FUNCTION_NAME_CHECKED(IHoverable, OnHoverEnd) };
+		const FName DragEvents[] = { GET_FUNCTION_NAME_CHECKED(IDraggable, UpdateDragPosition), GET_FUNCTION_NAME_CHECKED(IDraggable, OnDropped) };
+		const FName AttachEvents[] = { GET_FUNCTION_NAME_CHECKED(IAttachable, TryAttachTo) };
+
+		FInteractionClassInfo Info;
+		AddCapability(Info, Class, EInteractionCapability::Clickable, UClickable::StaticClass(), ClickEvents);
+		AddCapability(Info, Class, EInteractionCapability::Hoverable, UHoverable::StaticClass(), HoverEvents);
+		AddCapability(Info, Class, EInteractionCapability::Draggable, UDraggable::StaticClass(), DragEvents);
+		AddCapability(Info, Class, EInteractionCapability::Attachable, UAttachable::StaticClass(), AttachEvents);
+		return Info;
+	}
+}
+
+FInteractionClassInfo FInteractionClassInfo::Get(const UClass* Class)
+{
+	check(IsInGameThread());
+
+	if (!Class)
+	{
+		return FInteractionClassInfo();
+	}
+
+	// Keyed with the object serial, so a recompiled Blueprint class never reuses a stale entry
+	static TMap<TObjectKey<UClass>, FInteractionClassInfo> Cache;
+
+	if (const FInteractionClassInfo* Found = Cache.Find(Class))
+	{
+		return *Found;
+	}
+
+	return Cache.Add(Class, BuildClassInfo(Class));
+}
+
+void FInteractionTarget::Set(UObject* InObject)
+{
+	Object = InObject;
+	Info = FInteractionClassInfo::Get(InObject ? InObject->GetClass() : nullptr);
+
+	// Cast returns null for interfaces implemented in Blueprint, those stay on the reflected path
+	const EInteractionCapability Native = Info.NativeCapabilities;
+	NativeClickable = EnumHasAnyFlags(Native, EInteractionCapability::Clickable) ? Cast<IClickable>(InObject) : nullptr;
+	NativeHoverable = EnumHasAnyFlags(Native, EInteractionCapability::Hoverable) ? Cast<IHoverable>(InObject) : nullptr;
+	NativeDraggable = EnumHasAnyFlags(Native, EInteractionCapability::Draggable) ? Cast<IDraggable>(InObject) : nullptr;
+	NativeAttachable = EnumHasAnyFlags(Native, EInteractionCapability::Attachable) ? Cast<IAttachable>(InObject) : nullptr;
+}
+
+void FInteractionTarget::OnClicked() const
+{
+	UObject* Target = Object.Get();
+	if (!Target)
+	{
+		return;
+	}
+
+	if (NativeClickable)
+	{
+		NativeClickable->OnClicked_Implementation();
+	}
+	else if (Info.Has(EInteractionCapability::Clickable))
+	{
+		IClickable::Execute_OnClicked(Target);
+	}
+}
+
+void FInteractionTarget::OnHoverBegin() const
+{
+	UObject* Target = Object.Get();
+	if (!Target)
+	{
+		return;
+	}
+
+	if (NativeHoverable)
+	{
+		NativeHoverable->OnHoverBegin_Implementation();
+	}
+	else if (Info.Has(EInteractionCapability::Hoverable))
+	{
+		IHoverable::Execute_OnHoverBegin(Target);
+	}
+}
+
+void FInteractionTarget::OnHoverEnd() const
+{
+	UObject* Target = Object.Get();
+	if (!Target)
+	{
+		return;
+	}
+
+	if (NativeHoverable)
+	{
+		NativeHoverable->OnHoverEnd_Implementation();
+	}
+	else if (Info.Has(EInteractionCapability::Hoverable))
+	{
+		IHoverable::Execute_OnHoverEnd(Target);
+	}
+}
+
+void FInteractionTarget::UpdateDragPosition(const FVector& WorldPosition) const
+{
+	UObject* Target = Object.Get();
+	if (!Target)
+	{
+		return;
+	}
+
+	if (NativeDraggable)
+	{
+		NativeDraggable->UpdateDragPosition_Implementation(WorldPosition);
+	}
+	else if (Info.Has(EInteractionCapability::Draggable))
+	{
+		IDraggable::Execute_UpdateDragPosition(Target, WorldPosition);
+	}
+}
+
+void FInteractionTarget::OnDropped() const
+{
+	UObject* Target = Object.Get();
+	if (!Target)
+	{
+		return;
+	}
+
+	if (NativeDraggable)
+	{
+		NativeDraggable->OnDropped_Implementation();
+	}
+	else if (Info.Has(EInteractionCapability::Draggable))
+	{
+		IDraggable::Execute_OnDropped(Target);
+	}
+}
+
+bool FInteractionTarget::TryAttachTo(UAttachmentPoint* Point) const
+{
+	UObject* Target = Object.Get();
+	if (!Target)
+	{
+		return false;
+	}
+
+	if (NativeAttachable)
+	{
+		return NativeAttachable->TryAttachTo_Implementation(Point);
+	}
+	if (Info.Has(EInteractionCapability::Attachable))
+	{
+		return IAttachable::Execute_TryAttachTo(Target, Point);
+	}
+	return false;
+}
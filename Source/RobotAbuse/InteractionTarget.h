@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IAttachable;
+class IClickable;
+class IDraggable;
+class IHoverable;
+class UAttachmentPoint;
+
+/** Interaction interfaces a class implements */
+enum class EInteractionCapability : uint8
+{
+	None = 0,
+	Clickable = 1 << 0,
+	Hoverable = 1 << 1,
+	Draggable = 1 << 2,
+	Attachable = 1 << 3,
+};
+ENUM_CLASS_FLAGS(EInteractionCapability)
+
+/**
+ * What a class can do, worked out once per class instead of per call.
+ * Native capabilities are the ones whose events are all implemented in C++ and not overridden in
+ * Blueprint, so they can be called directly without going through ProcessEvent.
+ */
+struct ROBOTABUSE_API FInteractionClassInfo
+{
+	EInteractionCapability Capabilities = EInteractionCapability::None;
+	EInteractionCapability NativeCapabilities = EInteractionCapability::None;
+
+	bool Has(EInteractionCapability Capability) const { return EnumHasAllFlags(Capabilities, Capability); }
+
+	/** Cached lookup, game thread only */
+	static FInteractionClassInfo Get(const UClass* Class);
+};
+
+/**
+ * An object we talk to through the interaction interfaces, with its dispatch resolved up front.
+ * C++ implementations are called through cached native interface pointers; only Blueprint
+ * implementations and overrides take the reflected Execute_ path.
+ * Holds the object weakly. Every dispatch checks it is still alive first, so a target destroyed
+ * between events is skipped instead of called through a dangling interface pointer.
+ */
+class ROBOTABUSE_API FInteractionTarget
+{
+public:
+	void Set(UObject* InObject);
+	void Reset() { Set(nullptr); }
+
+	UObject* Get() const { return Object.Get(); }
+	bool IsValid() const { return Object.IsValid(); }
+	bool Has(EInteractionCapability Capability) const { return Info.Has(Capability) && Object.IsValid(); }
+
+	// IClickable
+	void OnClicked() const;
+
+	// IHoverable
+	void OnHoverBegin() const;
+	void OnHoverEnd() const;
+
+	// IDraggable
+	void UpdateDragPosition(const FVector& WorldPosition) const;
+	void OnDropped() const;
+
+	// IAttachable
+	bool TryAttachTo(UAttachmentPoint* Point) const;
+
+private:
+	TWeakObjectPtr<UObject> Object;
+	FInteractionClassInfo Info;
+
+	// Only set when the whole interface can be called natively
+	IClickable* NativeClickable = nullptr;
+	IHoverable* NativeHoverable = nullptr;
+	IDraggable* NativeDraggable = nullptr;
+	IAttachable* NativeAttachable = nullptr;
+};
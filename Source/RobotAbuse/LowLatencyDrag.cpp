@@ -0,0 +1,77 @@
+#include "LowLatencyDrag.h"
+#include "RobotSpectatorPawn.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarRobotLowLatencyDrag(
+	TEXT("robot.Interaction.LowLatencyDrag"),
+	true,
+	TEXT("Sample the cursor and move the dragged part at the end of the frame, after the camera update."));
+
+bool FDragInputFilter::IsLowLatencyEnabled()
+{
+	return CVarRobotLowLatencyDrag.GetValueOnGameThread();
+}
+
+bool FDragInputFilter::Filter(const FVector& RawLocation, float DeltaTime, const FLowLatencyDragSettings& Settings, FVector& OutLocation)
+{
+	// First sample of a drag starts at rest, so the part does not jump on pickup
+	if (!bHasSample)
+	{
+		LastRaw = RawLocation;
+		Velocity = FVector::ZeroVector;
+		Filtered = RawLocation;
+		Applied = RawLocation;
+		bHasSample = true;
+		OutLocation = RawLocation;
+		return true;
+	}
+
+	// A second sample in the same frame (late tick after a hand-driven tick) keeps the last velocity
+	if (DeltaTime > UE_SMALL_NUMBER)
+	{
+		Velocity = (RawLocation - LastRaw) / DeltaTime;
+	}
+	LastRaw = RawLocation;
+
+	const FVector Predicted = Settings.PredictionSeconds > 0.0f ? RawLocation + Velocity * Settings.PredictionSeconds : RawLocation;
+
+	if (Settings.SmoothingHalfLife > 0.0f)
+	{
+		// Frame rate independent exponential smoothing
+		const float Alpha = 1.0f - FMath::Exp2(-DeltaTime / Settings.SmoothingHalfLife);
+		Filtered = FMath::Lerp(Filtered, Predicted, Alpha);
+	}
+	else
+	{
+		Filtered = Predicted;
+	}
+
+	OutLocation = Filtered;
+	if (Filtered.Equals(Applied, Settings.MinMoveDistance))
+	{
+		return false;
+	}
+
+	Applied = Filtered;
+	return true;
+}
+
+// ===== Late Tick =====
+
+void FRobotLateDragTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (IsValid(Target) && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->LateTick(DeltaTime);
+	}
+}
+
+FString FRobotLateDragTickFunction::DiagnosticMessage()
+{
+	return Target ? Target->GetFullName() + TEXT("[LateDragTick]") : TEXT("<none>[LateDragTick]");
+}
+
+FName FRobotLateDragTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return Target ? Target->GetClass()->GetFName() : NAME_None;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "LowLatencyDrag.generated.h"
+
+class ARobotSpectatorPawn;
+
+/** Tuning for the low-latency drag mode */
+USTRUCT(BlueprintType)
+struct FLowLatencyDragSettings
+{
+	GENERATED_BODY()
+
+	/**
+	 * Extrapolate the cursor this far ahead along its current velocity, in seconds.
+	 * Roughly one display frame hides the scan-out delay, 0 disables prediction
+	 */
+	UPROPERTY(EditAnywhere, Category = "Drag", meta = (ClampMin = "0.0", ClampMax = "0.1"))
+	float PredictionSeconds = 0.0f;
+
+	/** Time for the part to close half the distance to the cursor, 0 disables smoothing */
+	UPROPERTY(EditAnywhere, Category = "Drag", meta = (ClampMin = "0.0", ClampMax = "0.25"))
+	float SmoothingHalfLife = 0.0f;
+
+	/** Moves shorter than this are skipped so a resting cursor does not dirty the part's transform */
+	UPROPERTY(EditAnywhere, Category = "Drag", meta = (ClampMin = "0.0"))
+	float MinMoveDistance = 0.01f;
+};
+
+/**
+ * Turns the raw drag target sampled each frame into the location the part is moved to,
+ * applying the optional prediction and smoothing. Reset whenever a new drag starts.
+ */
+class ROBOTABUSE_API FDragInputFilter
+{
+public:
+	/**
+	 * Filter this frame's sample into OutLocation
+	 * @return False if the result is within MinMoveDistance of the last location handed out, nothing to move
+	 */
+	bool Filter(const FVector& RawLocation, float DeltaTime, const FLowLatencyDragSettings& Settings, FVector& OutLocation);
+
+	void Reset() { bHasSample = false; }
+
+	/** True if the low-latency path is on, see robot.Interaction.LowLatencyDrag */
+	static bool IsLowLatencyEnabled();
+
+private:
+	FVector LastRaw = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	FVector Filtered = FVector::ZeroVector;
+	FVector Applied = FVector::ZeroVector;
+	bool bHasSample = false;
+};
+
+/**
+ * Second tick of the spectator pawn, in TG_LastDemotable. That is after every actor has ticked and the
+ * player camera was updated for the frame, the last point on the game thread before the scene is sent
+ * to the renderer. Sampling the cursor and moving the dragged part here means the part is drawn at the
+ * cursor of the frame it is rendered in, instead of one frame behind.
+ */
+USTRUCT()
+struct FRobotLateDragTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	ARobotSpectatorPawn* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FRobotLateDragTickFunction> : public TStructOpsTypeTraitsBase2<FRobotLateDragTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
@@ -0,0 +1,88 @@
+#include "PartCategories.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace
+{
+	/** Category name -> bit, built once from config */
+	const TMap<FName, int32>& GetCategoryBits()
+	{
+		static const TMap<FName, int32> Bits = []()
+		{
+			TMap<FName, int32> Result;
+			Result.Add(TEXT("Left"), 0);
+			Result.Add(TEXT("Right"), 1);
+			Result.Add(TEXT("Arm"), 2);
+
+			TArray<FString> Names;
+			if (GConfig)
+			{
+				GConfig->GetArray(TEXT("RobotAbuse.PartCategories"), TEXT("Categories"), Names, GGameIni);
+			}
+
+			for (const FString& Name : Names)
+			{
+				if (Result.Num() >= 64)
+				{
+					UE_LOG(LogRobotAbuse, Error, TEXT("Part category %s ignored, only 64 categories fit in a mask"), *Name);
+					continue;
+				}
+
+				if (!Result.Contains(*Name))
+				{
+					Result.Add(*Name, Result.Num());
+				}
+			}
+
+			return Result;
+		}();
+
+		return Bits;
+	}
+}
+
+FPartCategoryMask RobotPartCategories::SocketMaskFromArmType(EArmType Type)
+{
+	switch (Type)
+	{
+	case EArmType::Left: return Left | Arm;
+	case EArmType::Right: return Right | Arm;
+	default: return Left | Right | Arm;
+	}
+}
+
+FPartCategoryMask RobotPartCategories::PartMaskFromArmType(EArmType Type)
+{
+	switch (Type)
+	{
+	case EArmType::Left: return Left;
+	case EArmType::Right: return Right;
+	default: return Arm;
+	}
+}
+
+FPartCategoryMask RobotPartCategories::FromNames(TConstArrayView<FName> Names)
+{
+	FPartCategoryMask Mask = 0;
+
+	for (const FName& Name : Names)
+	{
+		const int32 Bit = FindBit(Name);
+		if (Bit == INDEX_NONE)
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("Unknown part category %s, add it to [RobotAbuse.PartCategories]"), *Name.ToString());
+			continue;
+		}
+
+		Mask |= 1ull << Bit;
+	}
+
+	return Mask;
+}
+
+int32 RobotPartCategories::FindBit(FName Name)
+{
+	const int32* Bit = GetCategoryBits().Find(Name);
+	return Bit ? *Bit : INDEX_NONE;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EArmType : uint8;
+
+/** One bit per part category, a part fits a socket when the socket accepts every bit the part has */
+using FPartCategoryMask = uint64;
+
+/**
+ * Part categories as bitmasks. Bits 0 and 1 are the Left and Right arm sides and bit 2 an arm for
+ * either side, the rest are named in [RobotAbuse.PartCategories] of DefaultGame.ini (hands, heads,
+ * tools, sizes...), up to 64 in total. Every part has at least one bit, an empty mask fits nothing.
+ */
+namespace RobotPartCategories
+{
+	constexpr FPartCategoryMask Left = 1ull << 0;
+	constexpr FPartCategoryMask Right = 1ull << 1;
+	constexpr FPartCategoryMask Arm = 1ull << 2;
+
+	/** What an arm socket of this type accepts: arms for either side, and its own side or both for Universal */
+	ROBOTABUSE_API FPartCategoryMask SocketMaskFromArmType(EArmType Type);
+
+	/** Side a part of this arm type needs, a Universal part is just an Arm so it fits either side */
+	ROBOTABUSE_API FPartCategoryMask PartMaskFromArmType(EArmType Type);
+
+	/** Mask for a list of category names. Unknown names are logged and ignored */
+	ROBOTABUSE_API FPartCategoryMask FromNames(TConstArrayView<FName> Names);
+
+	/** Bit index of a category, INDEX_NONE if it is not configured */
+	ROBOTABUSE_API int32 FindBit(FName Name);
+
+	/** The one compatibility rule: every category of the part must be accepted by the socket */
+	inline bool AreCompatible(FPartCategoryMask SocketMask, FPartCategoryMask PartMask)
+	{
+		return PartMask != 0 && (PartMask & ~SocketMask) == 0;
+	}
+}
+
+/** Mask of a category name array, resolved again whenever the names change */
+struct FPartCategoryCache
+{
+	FPartCategoryMask Get(TConstArrayView<FName> Names)
+	{
+		if (!bResolved || !Matches(Names))
+		{
+			CachedNames.Reset();
+			CachedNames.Append(Names.GetData(), Names.Num());
+			Mask = RobotPartCategories::FromNames(Names);
+			bResolved = true;
+		}
+		return Mask;
+	}
+
+private:
+	bool Matches(TConstArrayView<FName> Names) const
+	{
+		if (Names.Num() != CachedNames.Num())
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < Names.Num(); i++)
+		{
+			if (Names[i] != CachedNames[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	TArray<FName> CachedNames;
+	FPartCategoryMask Mask = 0;
+	bool bResolved = false;
+};
@@ -14,6 +14,9 @@ public class RobotAbuse : ModuleRules
 		{
 			"Slate",
 			"SlateCore",
+			"MassEntity",
+			"NetCore",
+			"Json",
 		});
 
 		// Uncomment if you are using Slate UI
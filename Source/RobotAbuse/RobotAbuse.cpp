@@ -3,4 +3,16 @@
 #include "RobotAbuse.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogRobotAbuse);
+
+DEFINE_STAT(STAT_RobotMIDsAvoided);
+DEFINE_STAT(STAT_RobotFleetInstances);
+DEFINE_STAT(STAT_RobotPooledParts);
+DEFINE_STAT(STAT_RobotPoolMisses);
+DEFINE_STAT(STAT_RobotFallingParts);
+
+UE_TRACE_CHANNEL_DEFINE(RobotAbuseChannel);
+
+CSV_DEFINE_CATEGORY_MODULE(ROBOTABUSE_API, RobotAbuse, true);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, RobotAbuse, "RobotAbuse" );
@@ -3,4 +3,39 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
+// Verbose hot-path logging is compiled out of Test and Shipping builds
+#if UE_BUILD_SHIPPING || UE_BUILD_TEST
+DECLARE_LOG_CATEGORY_EXTERN(LogRobotAbuse, Log, Warning);
+#else
+DECLARE_LOG_CATEGORY_EXTERN(LogRobotAbuse, Log, All);
+#endif
+
+DECLARE_STATS_GROUP(TEXT("RobotAbuse"), STATGROUP_RobotAbuse, STATCAT_Advanced);
+
+// Material slots that are highlighted through custom primitive data instead of a dynamic material instance
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Dynamic Materials Avoided"), STAT_RobotMIDsAvoided, STATGROUP_RobotAbuse, ROBOTABUSE_API);
+
+// Robot parts currently drawn as fleet instances instead of their own mesh component
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Fleet Instanced Parts"), STAT_RobotFleetInstances, STATGROUP_RobotAbuse, ROBOTABUSE_API);
+
+// Parts parked in URobotPartPool, and acquires that found the pool empty and had to spawn
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pooled Parts"), STAT_RobotPooledParts, STATGROUP_RobotAbuse, ROBOTABUSE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pool Misses"), STAT_RobotPoolMisses, STATGROUP_RobotAbuse, ROBOTABUSE_API);
+
+// Dropped parts still simulating, back to zero once they have all settled
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Falling Parts"), STAT_RobotFallingParts, STATGROUP_RobotAbuse, ROBOTABUSE_API);
+
+// Insights channel for the interaction hot paths, enable with -trace=cpu,RobotAbuse
+UE_TRACE_CHANNEL_EXTERN(RobotAbuseChannel, ROBOTABUSE_API);
+
+#define ROBOT_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, RobotAbuseChannel)
+
+// CSV counters (-csvCategories=RobotAbuse): TracesPerFrame, HoverChanges, Attaches and Drops are per-frame counts
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(ROBOTABUSE_API, RobotAbuse);
+
+#define ROBOT_CSV_COUNT(Stat) CSV_CUSTOM_STAT(RobotAbuse, Stat, 1, ECsvCustomStatOp::Accumulate)
@@ -0,0 +1,129 @@
+#include "RobotAssembly.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "AttachmentRegistry.h"
+#include "RobotDefinitions.h"
+#include "RobotTorso.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+
+FRobotAssemblyBatch::FRobotAssemblyBatch(UWorld* InWorld)
+	: World(InWorld)
+{
+	DefaultMeshes.LoadDefaults();
+}
+
+FRobotAssemblyBatch::~FRobotAssemblyBatch()
+{
+	// Deferred actors left unfinished would never begin play
+	if (PendingParts.Num() > 0 || PendingRobots.Num() > 0)
+	{
+		Finish();
+	}
+}
+
+void FRobotAssemblyBatch::Reserve(int32 NumRobots)
+{
+	Assemblies.Reserve(NumRobots);
+	PendingRobots.Reserve(NumRobots);
+}
+
+int32 FRobotAssemblyBatch::Add(const URobotDefinition& Definition, const FTransform& Transform)
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::AssemblyAdd");
+
+	const int32 Index = Assemblies.AddDefaulted();
+	FRobotAssembly& Assembly = Assemblies[Index];
+
+	UClass* TorsoClass = Definition.RobotClass.Get();
+	if (!TorsoClass && !Definition.RobotClass.IsNull())
+	{
+		UE_LOG(LogRobotAbuse, Warning, TEXT("%s: robot class %s is not loaded"), *Definition.GetName(), *Definition.RobotClass.ToString());
+		return Index;
+	}
+
+	ARobotTorso* Robot = World->SpawnActorDeferred<ARobotTorso>(TorsoClass ? TorsoClass : ARobotTorso::StaticClass(), Transform);
+	if (!Robot)
+	{
+		return Index;
+	}
+
+	Assembly.Robot = Robot;
+	PendingRobots.Add({ Robot, Transform });
+
+	// The torso builds the sockets itself so clients can do the same from the replicated definition
+	TArray<UAttachmentPoint*, TInlineAllocator<4>> Points;
+	Robot->BuildFromDefinition(Definition, DefaultMeshes, Points);
+
+	for (int32 SocketIndex = 0; SocketIndex < Points.Num(); SocketIndex++)
+	{
+		UAttachmentPoint* Point = Points[SocketIndex];
+		if (!Point)
+		{
+			continue;
+		}
+
+		const FRobotSocketDefinition& Socket = Definition.Sockets[SocketIndex];
+		Assembly.Points.Add(Point);
+
+		AAttachablePart* Part = nullptr;
+		if (const URobotPartDefinition* PartDefinition = Socket.InitialPart.Get())
+		{
+			UClass* PartClass = PartDefinition->PartClass.Get();
+			const FTransform PartTransform(Transform.TransformPosition(Socket.RelativeLocation));
+
+			Part = World->SpawnActorDeferred<AAttachablePart>(PartClass ? PartClass : AAttachablePart::StaticClass(), PartTransform);
+			if (Part)
+			{
+				Part->ArmType = PartDefinition->ArmType;
+				Part->Categories = PartDefinition->Categories;
+
+				UStaticMeshComponent* PartMesh = Part->GetMeshComponent();
+				if (PartMesh && !PartMesh->GetStaticMesh())
+				{
+					if (UStaticMesh* Mesh = PartDefinition->Mesh.Get())
+					{
+						PartMesh->SetStaticMesh(Mesh);
+					}
+					else
+					{
+						PartMesh->SetStaticMesh(DefaultMeshes.Part);
+						PartMesh->SetRelativeScale3D(FVector(0.5f, 0.2f, 0.2f));
+					}
+				}
+
+				Point->InitialPart = Part;
+				PendingParts.Add({ Part, PartTransform });
+			}
+		}
+		else if (!Socket.InitialPart.IsNull())
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("%s: part definition %s is not loaded"), *Definition.GetName(), *Socket.InitialPart.ToString());
+		}
+
+		Assembly.Parts.Add(Part);
+	}
+
+	return Index;
+}
+
+void FRobotAssemblyBatch::Finish()
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::AssemblyFinish");
+
+	FAttachmentBatchScope Batch(UWorld::GetSubsystem<UAttachmentRegistry>(World));
+
+	for (const FPendingActor& Pending : PendingParts)
+	{
+		Pending.Actor->FinishSpawning(Pending.Transform);
+	}
+
+	for (const FPendingActor& Pending : PendingRobots)
+	{
+		Pending.Actor->FinishSpawning(Pending.Transform);
+	}
+
+	PendingParts.Reset();
+	PendingRobots.Reset();
+}
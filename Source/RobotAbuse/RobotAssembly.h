@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RobotStressLayout.h"
+
+class AAttachablePart;
+class ARobotTorso;
+class UAttachmentPoint;
+class URobotDefinition;
+class UWorld;
+
+/** What FRobotAssemblyBatch spawned for one robot, in socket order */
+struct ROBOTABUSE_API FRobotAssembly
+{
+	ARobotTorso* Robot = nullptr;
+	TArray<UAttachmentPoint*, TInlineAllocator<4>> Points;
+
+	/** Initial part of each socket, null where the socket starts empty */
+	TArray<AAttachablePart*, TInlineAllocator<4>> Parts;
+};
+
+/**
+ * Spawns robots from URobotDefinitions in one batch. Add spawns the torso and initial parts deferred
+ * and builds the sockets on the unfinished torso, each socket told its part directly. Finish then
+ * constructs all parts and all robots in one pass under a single registry notification. No child
+ * actor components and no searching children at BeginPlay, so the cost per robot stays flat.
+ * The definition's classes and meshes must already be loaded, see URobotDefinition::GetSpawnAssets.
+ */
+class ROBOTABUSE_API FRobotAssemblyBatch
+{
+public:
+	explicit FRobotAssemblyBatch(UWorld* InWorld);
+	~FRobotAssemblyBatch();
+
+	UE_NONCOPYABLE(FRobotAssemblyBatch);
+
+	void Reserve(int32 NumRobots);
+
+	/** Spawn Definition at Transform without constructing it yet. Returns its index in GetAssemblies, the robot is null if the torso could not spawn */
+	int32 Add(const URobotDefinition& Definition, const FTransform& Transform);
+
+	/** Construct everything added so far. Parts go first, the sockets attach them as their robot begins play */
+	void Finish();
+
+	int32 Num() const { return Assemblies.Num(); }
+	TConstArrayView<FRobotAssembly> GetAssemblies() const { return Assemblies; }
+
+private:
+	struct FPendingActor
+	{
+		AActor* Actor;
+		FTransform Transform;
+	};
+
+	UWorld* World;
+	FRobotStressMeshes DefaultMeshes;
+
+	TArray<FRobotAssembly> Assemblies;
+	TArray<FPendingActor> PendingParts;
+	TArray<FPendingActor> PendingRobots;
+};
@@ -0,0 +1,126 @@
+#include "RobotAssemblySpawner.h"
+#include "RobotAbuse.h"
+#include "RobotAssembly.h"
+#include "RobotAssetPreloader.h"
+#include "RobotDefinitions.h"
+#include "Components/SceneComponent.h"
+#include "HAL/PlatformTime.h"
+
+// Definitions, then their part definitions, then the classes and meshes those name
+static constexpr int32 MaxAssemblyLoadPasses = 3;
+
+ARobotAssemblySpawner::ARobotAssemblySpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void ARobotAssemblySpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Robots replicate, clients build their sockets from the definition the server sends
+	if (!HasAuthority() || Placements.Num() == 0)
+	{
+		return;
+	}
+
+	if (URobotStartupTracker* Startup = UWorld::GetSubsystem<URobotStartupTracker>(GetWorld()))
+	{
+		Startup->BeginWork();
+		bStartupWorkPending = true;
+	}
+
+	LoadAssets();
+}
+
+void ARobotAssemblySpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (LoadHandle.IsValid())
+	{
+		LoadHandle->CancelHandle();
+		LoadHandle.Reset();
+	}
+	EndStartupWork();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ARobotAssemblySpawner::LoadAssets()
+{
+	TArray<FSoftObjectPath> ToLoad;
+	TSet<const URobotDefinition*> Seen;
+
+	for (const FRobotAssemblyPlacement& Placement : Placements)
+	{
+		if (const URobotDefinition* Definition = Placement.Definition.Get())
+		{
+			bool bAlreadySeen = false;
+			Seen.Add(Definition, &bAlreadySeen);
+			if (!bAlreadySeen)
+			{
+				Definition->GetSpawnAssets(ToLoad);
+			}
+		}
+		else if (!Placement.Definition.IsNull())
+		{
+			ToLoad.AddUnique(Placement.Definition.ToSoftObjectPath());
+		}
+	}
+
+	// Paths that fail to load stay unresolved, spawn what there is instead of asking again forever
+	if (ToLoad.Num() == 0 || LoadPasses >= MaxAssemblyLoadPasses)
+	{
+		LoadHandle.Reset();
+		SpawnAssemblies();
+		return;
+	}
+
+	LoadPasses++;
+	LoadHandle = RobotAssets::LoadAsync(MoveTemp(ToLoad), FStreamableDelegate::CreateUObject(this, &ARobotAssemblySpawner::LoadAssets), GetName());
+}
+
+void ARobotAssemblySpawner::SpawnAssemblies()
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::AssemblySpawn");
+	const double Start = FPlatformTime::Seconds();
+
+	const FTransform& SpawnerTransform = GetActorTransform();
+
+	FRobotAssemblyBatch Batch(GetWorld());
+	Batch.Reserve(Placements.Num());
+
+	for (const FRobotAssemblyPlacement& Placement : Placements)
+	{
+		if (const URobotDefinition* Definition = Placement.Definition.Get())
+		{
+			Batch.Add(*Definition, Placement.Transform * SpawnerTransform);
+		}
+		else
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("%s could not load robot definition %s"), *GetName(), *Placement.Definition.ToString());
+		}
+	}
+
+	Batch.Finish();
+	NumSpawned = Batch.Num();
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("%s spawned %d robots in %.1f ms"), *GetName(), NumSpawned, (FPlatformTime::Seconds() - Start) * 1000.0);
+
+	EndStartupWork();
+}
+
+void ARobotAssemblySpawner::EndStartupWork()
+{
+	if (!bStartupWorkPending)
+	{
+		return;
+	}
+
+	bStartupWorkPending = false;
+	if (URobotStartupTracker* Startup = UWorld::GetSubsystem<URobotStartupTracker>(GetWorld()))
+	{
+		Startup->EndWork();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RobotAssemblySpawner.generated.h"
+
+class URobotDefinition;
+struct FStreamableHandle;
+
+/** One robot an ARobotAssemblySpawner builds */
+USTRUCT(BlueprintType)
+struct FRobotAssemblyPlacement
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Assembly")
+	TSoftObjectPtr<URobotDefinition> Definition;
+
+	/** Relative to the spawner */
+	UPROPERTY(EditAnywhere, Category = "Assembly")
+	FTransform Transform;
+};
+
+/**
+ * Builds robots from URobotDefinitions when play begins, the data-driven replacement for placing
+ * BP_Robot with child actor arms. The definitions and their classes and meshes are streamed in first,
+ * then every robot is spawned through one FRobotAssemblyBatch. The map counts as interactive for
+ * URobotStartupTracker once they are all attached.
+ */
+UCLASS()
+class ROBOTABUSE_API ARobotAssemblySpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ARobotAssemblySpawner();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, Category = "Assembly")
+	TArray<FRobotAssemblyPlacement> Placements;
+
+	/** Number of robots spawned, 0 until the assets are in */
+	int32 GetNumSpawned() const { return NumSpawned; }
+
+private:
+	void LoadAssets();
+	void SpawnAssemblies();
+	void EndStartupWork();
+
+	TSharedPtr<FStreamableHandle> LoadHandle;
+	int32 LoadPasses = 0;
+	int32 NumSpawned = 0;
+	bool bStartupWorkPending = false;
+};
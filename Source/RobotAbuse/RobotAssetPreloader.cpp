@@ -0,0 +1,263 @@
+#include "RobotAssetPreloader.h"
+#include "RobotAbuse.h"
+#include "RobotDefinitions.h"
+#include "AttachablePart.h"
+#include "EngineUtils.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "TimerManager.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace RobotAssets
+{
+	const FName GameBundle(TEXT("Game"));
+
+	TSharedPtr<FStreamableHandle> LoadAsync(TArray<FSoftObjectPath> Paths, FStreamableDelegate Callback, const FString& DebugName)
+	{
+		if (!UAssetManager::IsInitialized())
+		{
+			for (const FSoftObjectPath& Path : Paths)
+			{
+				Path.TryLoad();
+			}
+			Callback.ExecuteIfBound();
+			return nullptr;
+		}
+
+		return UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths), MoveTemp(Callback),
+			FStreamableManager::DefaultAsyncLoadPriority, false, false, DebugName);
+	}
+
+	/** Map name without path, options or PIE prefix, so a load request and the world it makes compare equal */
+	static FString GetMapShortName(const FString& MapName)
+	{
+		FString Name;
+		if (!MapName.Split(TEXT("?"), &Name, nullptr))
+		{
+			Name = MapName;
+		}
+		return UWorld::RemovePIEPrefix(FPackageName::GetShortName(Name));
+	}
+}
+
+// ===== Preloader =====
+
+void URobotAssetPreloader::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &URobotAssetPreloader::HandlePreLoadMap);
+
+	if (!UAssetManager::IsInitialized())
+	{
+		HandlePreloadComplete();
+		return;
+	}
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+
+	TArray<FPrimaryAssetId> AssetIds;
+	AssetManager.GetPrimaryAssetIdList(URobotDefinition::PrimaryAssetType, AssetIds);
+
+	TArray<FPrimaryAssetId> PartIds;
+	AssetManager.GetPrimaryAssetIdList(URobotPartDefinition::PrimaryAssetType, PartIds);
+	AssetIds.Append(PartIds);
+
+	PreloadStartTime = FPlatformTime::Seconds();
+
+	if (AssetIds.Num() > 0)
+	{
+		PreloadHandle = AssetManager.LoadPrimaryAssets(AssetIds, { RobotAssets::GameBundle },
+			FStreamableDelegate::CreateUObject(this, &URobotAssetPreloader::HandlePreloadComplete), FStreamableManager::AsyncLoadHighPriority);
+	}
+
+	// Nothing to load, or all of it already in memory
+	if (!PreloadHandle.IsValid() || PreloadHandle->HasLoadCompleted())
+	{
+		HandlePreloadComplete();
+	}
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("Preloading %d robot definitions"), AssetIds.Num());
+}
+
+void URobotAssetPreloader::Deinitialize()
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+
+	if (PreloadHandle.IsValid())
+	{
+		PreloadHandle->CancelHandle();
+		PreloadHandle.Reset();
+	}
+	PendingCallbacks.Empty();
+
+	Super::Deinitialize();
+}
+
+void URobotAssetPreloader::CallWhenPreloaded(FSimpleDelegate Callback)
+{
+	if (bPreloadComplete)
+	{
+		Callback.ExecuteIfBound();
+	}
+	else
+	{
+		PendingCallbacks.Add(MoveTemp(Callback));
+	}
+}
+
+void URobotAssetPreloader::HandlePreloadComplete()
+{
+	if (bPreloadComplete)
+	{
+		return;
+	}
+
+	bPreloadComplete = true;
+	PreloadSeconds = PreloadStartTime > 0.0 ? FPlatformTime::Seconds() - PreloadStartTime : 0.0;
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("Robot definitions preloaded in %.1f ms"), PreloadSeconds * 1000.0);
+
+	for (FSimpleDelegate& Callback : MoveTemp(PendingCallbacks))
+	{
+		Callback.ExecuteIfBound();
+	}
+	PendingCallbacks.Empty();
+}
+
+void URobotAssetPreloader::GetRobotDefinitions(TArray<URobotDefinition*>& OutDefinitions) const
+{
+	if (UAssetManager::IsInitialized())
+	{
+		UAssetManager::Get().GetPrimaryAssetObjectList<URobotDefinition>(URobotDefinition::PrimaryAssetType, OutDefinitions);
+	}
+}
+
+void URobotAssetPreloader::GetPartDefinitions(TArray<URobotPartDefinition*>& OutDefinitions) const
+{
+	if (UAssetManager::IsInitialized())
+	{
+		UAssetManager::Get().GetPrimaryAssetObjectList<URobotPartDefinition>(URobotPartDefinition::PrimaryAssetType, OutDefinitions);
+	}
+}
+
+void URobotAssetPreloader::HandlePreLoadMap(const FString& MapName)
+{
+	LoadingMapName = RobotAssets::GetMapShortName(MapName);
+	MapLoadStartTime = FPlatformTime::Seconds();
+}
+
+double URobotAssetPreloader::GetMapLoadStartTime(const FString& MapName) const
+{
+	return RobotAssets::GetMapShortName(MapName) == LoadingMapName ? MapLoadStartTime : 0.0;
+}
+
+// ===== Startup tracker =====
+
+bool URobotStartupTracker::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URobotStartupTracker::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	StartTime = FPlatformTime::Seconds();
+
+	UWorld* World = GetWorld();
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	URobotAssetPreloader* Preloader = GameInstance ? GameInstance->GetSubsystem<URobotAssetPreloader>() : nullptr;
+	if (!Preloader)
+	{
+		return;
+	}
+
+	// Count from the map load request when the preloader saw it, the world is only created half way through
+	if (const double MapLoadStartTime = Preloader->GetMapLoadStartTime(World->GetOutermost()->GetName()))
+	{
+		StartTime = MapLoadStartTime;
+	}
+
+	if (!Preloader->IsPreloadComplete())
+	{
+		BeginWork();
+		Preloader->CallWhenPreloaded(FSimpleDelegate::CreateUObject(this, &URobotStartupTracker::EndWork));
+	}
+}
+
+void URobotStartupTracker::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Actors begin play after this, give them the frame to register their work
+	InWorld.GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &URobotStartupTracker::TryFinish));
+}
+
+void URobotStartupTracker::BeginWork()
+{
+	PendingWork++;
+}
+
+void URobotStartupTracker::EndWork()
+{
+	if (ensure(PendingWork > 0))
+	{
+		PendingWork--;
+		TryFinish();
+	}
+}
+
+void URobotStartupTracker::TryFinish()
+{
+	const UWorld* World = GetWorld();
+	if (bInteractive || PendingWork > 0 || !World || !World->HasBegunPlay())
+	{
+		return;
+	}
+
+	bInteractive = true;
+	TimeToInteractive = FPlatformTime::Seconds() - StartTime;
+
+	CSV_EVENT(RobotAbuse, TEXT("Interactive"));
+	UE_LOG(LogRobotAbuse, Log, TEXT("%s interactive after %.1f ms (%.1f s since launch)"),
+		*RobotAssets::GetMapShortName(World->GetOutermost()->GetName()), TimeToInteractive * 1000.0, FPlatformTime::Seconds() - GStartTime);
+
+	OnInteractive.Broadcast(TimeToInteractive);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("RobotMeasureStartup")))
+	{
+		Report();
+		FPlatformMisc::RequestExit(false, TEXT("RobotMeasureStartup"));
+	}
+}
+
+void URobotStartupTracker::Report() const
+{
+	const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("RobotAbuse_TimeToInteractive.csv");
+
+	FString Csv;
+	if (!FPaths::FileExists(CsvPath))
+	{
+		Csv = TEXT("Map,Parts,TimeToInteractiveMs,SinceLaunchMs\n");
+	}
+
+	UWorld* World = GetWorld();
+	int32 NumParts = 0;
+	for (TActorIterator<AAttachablePart> It(World); It; ++It)
+	{
+		NumParts++;
+	}
+
+	Csv += FString::Printf(TEXT("%s,%d,%.1f,%.1f\n"),
+		*RobotAssets::GetMapShortName(World->GetOutermost()->GetName()), NumParts,
+		TimeToInteractive * 1000.0, (FPlatformTime::Seconds() - GStartTime) * 1000.0);
+
+	FFileHelper::SaveStringToFile(Csv, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	UE_LOG(LogRobotAbuse, Display, TEXT("Wrote %s"), *CsvPath);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RobotAssetPreloader.generated.h"
+
+class URobotDefinition;
+class URobotPartDefinition;
+
+namespace RobotAssets
+{
+	/** Asset bundle holding the classes and meshes a definition spawns with */
+	extern ROBOTABUSE_API const FName GameBundle;
+
+	/**
+	 * Load Paths in the background through the asset manager and call Callback on the game thread once
+	 * they are in memory. Keep the handle to keep them loaded. Without an asset manager (commandlets)
+	 * the paths are loaded on the spot.
+	 */
+	ROBOTABUSE_API TSharedPtr<FStreamableHandle> LoadAsync(TArray<FSoftObjectPath> Paths, FStreamableDelegate Callback, const FString& DebugName);
+}
+
+/**
+ * Preload stage for the robot and part definitions. As soon as the game instance starts, every
+ * RobotDefinition and RobotPartDefinition primary asset is requested from the asset manager with its
+ * Game bundle, so the classes and meshes they name stream in while the first map loads. Nothing waits
+ * on the result, code that needs the definitions asks to be called once they are in.
+ * Also remembers when each map started loading, for URobotStartupTracker.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotAssetPreloader : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	bool IsPreloadComplete() const { return bPreloadComplete; }
+	double GetPreloadSeconds() const { return PreloadSeconds; }
+
+	/** Callback runs once the definitions are loaded, right away if they already are */
+	void CallWhenPreloaded(FSimpleDelegate Callback);
+
+	void GetRobotDefinitions(TArray<URobotDefinition*>& OutDefinitions) const;
+	void GetPartDefinitions(TArray<URobotPartDefinition*>& OutDefinitions) const;
+
+	/** FPlatformTime::Seconds() when MapName started loading, 0 if no map load was seen */
+	double GetMapLoadStartTime(const FString& MapName) const;
+
+private:
+	void HandlePreLoadMap(const FString& MapName);
+	void HandlePreloadComplete();
+
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+	TArray<FSimpleDelegate> PendingCallbacks;
+
+	double PreloadStartTime = 0.0;
+	double PreloadSeconds = 0.0;
+	bool bPreloadComplete = false;
+
+	FString LoadingMapName;
+	double MapLoadStartTime = 0.0;
+	FDelegateHandle PreLoadMapHandle;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnRobotInteractive, double /*Seconds*/);
+
+/**
+ * Measures time-to-interactive of a game world: from the moment its map started loading until play
+ * has begun and every piece of startup work registered with BeginWork has ended, e.g. the definition
+ * preload and stress spawners. Logged, marked in CSV captures, and with -RobotMeasureStartup appended to
+ * Saved/Benchmarks/RobotAbuse_TimeToInteractive.csv before the game exits.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotStartupTracker : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Hold off interactivity until the matching EndWork */
+	void BeginWork();
+	void EndWork();
+
+	bool IsInteractive() const { return bInteractive; }
+	double GetTimeToInteractive() const { return TimeToInteractive; }
+
+	FOnRobotInteractive OnInteractive;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void TryFinish();
+	void Report() const;
+
+	double StartTime = 0.0;
+	double TimeToInteractive = 0.0;
+	int32 PendingWork = 0;
+	bool bInteractive = false;
+};
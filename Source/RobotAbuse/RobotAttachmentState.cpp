@@ -0,0 +1,439 @@
+#include "RobotAttachmentState.h"
+#include "RobotAbuse.h"
+#include "AttachmentPoint.h"
+#include "AttachmentTransaction.h"
+#include "EngineUtils.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Net/UnrealNetwork.h"
+
+static TAutoConsoleVariable<float> CVarRobotNetDragSendRate(
+	TEXT("robot.Net.DragSendRate"),
+	20.0f,
+	TEXT("Held part location updates per second sent to the other players, 0 sends only pickups, drops and attaches."));
+
+static FAutoConsoleCommandWithWorld CmdRobotNetStats(
+	TEXT("robot.Net.Stats"),
+	TEXT("Log attachment replication traffic on the server: state ops, moves and bytes per op."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const ARobotAttachmentState* State = ARobotAttachmentState::Get(World))
+		{
+			State->LogStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CmdRobotNetResetStats(
+	TEXT("robot.Net.ResetStats"),
+	TEXT("Reset the attachment replication counters."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (ARobotAttachmentState* State = ARobotAttachmentState::Get(World))
+		{
+			State->ResetStats();
+		}
+	}));
+
+// ===== Fast Array =====
+
+void FRobotPartNetItem::PostReplicatedAdd(const FRobotPartNetArray& Array)
+{
+	if (Array.Owner)
+	{
+		Array.Owner->QueueApply(*this);
+	}
+}
+
+void FRobotPartNetItem::PostReplicatedChange(const FRobotPartNetArray& Array)
+{
+	if (Array.Owner)
+	{
+		Array.Owner->QueueApply(*this);
+	}
+}
+
+bool FRobotPartNetArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	const int64 BitsBefore = DeltaParms.Writer ? DeltaParms.Writer->GetNumBits() : 0;
+
+	const bool bResult = FFastArraySerializer::FastArrayDeltaSerialize<FRobotPartNetItem, FRobotPartNetArray>(Items, DeltaParms, *this);
+
+	if (DeltaParms.Writer && Owner)
+	{
+		const int64 Bits = DeltaParms.Writer->GetNumBits() - BitsBefore;
+		if (Bits > 0)
+		{
+			Owner->Stats.BitsSent += Bits;
+			Owner->Stats.Sends++;
+		}
+	}
+
+	return bResult;
+}
+
+void FRobotPartNetArray::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (Owner)
+	{
+		Owner->ApplyPending();
+	}
+}
+
+// ===== State Actor =====
+
+ARobotAttachmentState::ARobotAttachmentState()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	SetReplicatingMovement(false);
+
+	Parts.Owner = this;
+}
+
+void ARobotAttachmentState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ARobotAttachmentState, Parts);
+}
+
+void ARobotAttachmentState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Parts.Owner = this;
+
+	if (URobotAttachmentStateSubsystem* Subsystem = UWorld::GetSubsystem<URobotAttachmentStateSubsystem>(GetWorld()))
+	{
+		Subsystem->SetState(this);
+	}
+
+	// Parts record themselves when they change, start from what the level already has
+	if (HasAuthority())
+	{
+		for (TActorIterator<AAttachablePart> It(GetWorld()); It; ++It)
+		{
+			if (!It->IsPooled())
+			{
+				RecordPart(*It);
+			}
+		}
+		ResetStats();
+	}
+}
+
+void ARobotAttachmentState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (URobotAttachmentStateSubsystem* Subsystem = UWorld::GetSubsystem<URobotAttachmentStateSubsystem>(GetWorld()))
+	{
+		if (Subsystem->GetState() == this)
+		{
+			Subsystem->SetState(nullptr);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+ARobotAttachmentState* ARobotAttachmentState::Get(const UWorld* World)
+{
+	const URobotAttachmentStateSubsystem* Subsystem = World ? World->GetSubsystem<URobotAttachmentStateSubsystem>() : nullptr;
+	return Subsystem ? Subsystem->GetState() : nullptr;
+}
+
+float ARobotAttachmentState::GetMoveSendInterval()
+{
+	const float Rate = CVarRobotNetDragSendRate.GetValueOnGameThread();
+	return Rate > 0.0f ? 1.0f / Rate : 0.0f;
+}
+
+// ===== Server =====
+
+void ARobotAttachmentState::RecordPart(AAttachablePart* Part, AActor* Holder)
+{
+	if (!HasAuthority() || !IsValid(Part))
+	{
+		return;
+	}
+
+	FRobotPartNetItem* Item = FindItem(Part);
+	if (!Item)
+	{
+		ItemIndices.Add(Part, Parts.Items.Num());
+		Item = &Parts.Items.AddDefaulted_GetRef();
+		Item->Part = Part;
+	}
+
+	const UAttachmentPoint* Point = Part->GetAttachmentPoint();
+	AActor* Robot = Point ? Point->GetOwner() : nullptr;
+	const FName PointName = Point ? Point->GetFName() : NAME_None;
+
+	// A pickup detaches first, both land in the same replicated change and count as one op
+	const bool bStateChanged = Item->State != Part->CurrentState || Item->Robot != Robot || Item->PointName != PointName;
+	if (bStateChanged && Item->LastOpFrame != GFrameCounter)
+	{
+		Item->LastOpFrame = GFrameCounter;
+		Stats.StateOps++;
+		Stats.AttachOps += Part->CurrentState == EPartState::ATTACHED ? 1 : 0;
+	}
+
+	Item->State = Part->CurrentState;
+	Item->Robot = Robot;
+	Item->PointName = PointName;
+	Item->Location = Part->GetActorLocation();
+
+	if (Item->State != EPartState::HELD)
+	{
+		Item->Holder = nullptr;
+	}
+	else if (Holder)
+	{
+		Item->Holder = Holder;
+	}
+
+	// Relevancy follows whoever has the part: its holder, its robot, or nobody and then only distance counts
+	AActor* RelevancyOwner = Item->State == EPartState::HELD ? Item->Holder : Robot;
+	if (Part->GetOwner() != RelevancyOwner)
+	{
+		Part->SetOwner(RelevancyOwner);
+	}
+
+	Parts.MarkItemDirty(*Item);
+}
+
+void ARobotAttachmentState::RecordMove(AAttachablePart* Part)
+{
+	FRobotPartNetItem* Item = HasAuthority() && IsValid(Part) ? FindItem(Part) : nullptr;
+	if (!Item || Item->State != EPartState::HELD)
+	{
+		return;
+	}
+
+	Item->Location = Part->GetActorLocation();
+	Parts.MarkItemDirty(*Item);
+	Stats.Moves++;
+}
+
+void ARobotAttachmentState::RemovePart(AAttachablePart* Part)
+{
+	int32 Index = INDEX_NONE;
+	if (!HasAuthority() || !ItemIndices.RemoveAndCopyValue(Part, Index))
+	{
+		return;
+	}
+
+	Parts.Items.RemoveAtSwap(Index);
+	if (Parts.Items.IsValidIndex(Index))
+	{
+		ItemIndices.Add(Parts.Items[Index].Part, Index);
+	}
+	Parts.MarkArrayDirty();
+}
+
+bool ARobotAttachmentState::CanPickUp(const AAttachablePart* Part, const AActor* Instigator) const
+{
+	if (!IsValid(Part) || Part->IsPooled())
+	{
+		return false;
+	}
+
+	// A holder that left the session releases its part
+	const FRobotPartNetItem* Item = FindItem(Part);
+	return !Item || Item->State != EPartState::HELD || !IsValid(Item->Holder) || Item->Holder == Instigator;
+}
+
+bool ARobotAttachmentState::IsHeldBy(const AAttachablePart* Part, const AActor* Instigator) const
+{
+	const FRobotPartNetItem* Item = FindItem(Part);
+	return Item && Item->State == EPartState::HELD && Item->Holder == Instigator && Part->IsHeld();
+}
+
+bool ARobotAttachmentState::IsHeldByOther(const AAttachablePart* Part, const AActor* Instigator) const
+{
+	if (Predictions.Contains(Part))
+	{
+		return false;
+	}
+
+	const FRobotPartNetItem* Item = FindItem(Part);
+	return Item && Item->State == EPartState::HELD && Item->Holder != Instigator;
+}
+
+void ARobotAttachmentState::LogStats() const
+{
+	const UNetDriver* NetDriver = GetNetDriver();
+	const int32 NumConnections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("Attachment replication: %d parts, %d connections, %lld state ops (%lld attaches), %lld moves"),
+		Parts.Items.Num(), NumConnections, Stats.StateOps, Stats.AttachOps, Stats.Moves);
+	UE_LOG(LogRobotAbuse, Log, TEXT("Attachment replication: %.1f KB sent in %lld updates, %.1f bytes per op over all connections, %.1f per connection"),
+		Stats.BitsSent / 8192.0, Stats.Sends, Stats.GetBytesPerOp(), Stats.GetBytesPerOp() / FMath::Max(NumConnections, 1));
+}
+
+FRobotPartNetItem* ARobotAttachmentState::FindItem(const AAttachablePart* Part)
+{
+	return const_cast<FRobotPartNetItem*>(static_cast<const ARobotAttachmentState*>(this)->FindItem(Part));
+}
+
+const FRobotPartNetItem* ARobotAttachmentState::FindItem(const AAttachablePart* Part) const
+{
+	if (HasAuthority())
+	{
+		const int32* Index = ItemIndices.Find(Part);
+		return Index ? &Parts.Items[*Index] : nullptr;
+	}
+
+	// Clients only look up single parts when a prediction is rolled back
+	return Parts.Items.FindByPredicate([Part](const FRobotPartNetItem& Item) { return Item.Part == Part; });
+}
+
+// ===== Client Prediction =====
+
+void ARobotAttachmentState::BeginPrediction(AAttachablePart* Part)
+{
+	if (Part)
+	{
+		Predictions.FindOrAdd(Part)++;
+	}
+}
+
+void ARobotAttachmentState::EndPrediction(AAttachablePart* Part, bool bAccepted)
+{
+	int32* Count = Part ? Predictions.Find(Part) : nullptr;
+	if (Count && --(*Count) <= 0)
+	{
+		Predictions.Remove(Part);
+	}
+
+	// Accepted changes arrive through replication as usual, a rejected one goes back to what the server has
+	if (!bAccepted && Part && !Predictions.Contains(Part))
+	{
+		PendingApply.AddUnique(Part);
+		ApplyPending();
+	}
+}
+
+// ===== Client Apply =====
+
+void ARobotAttachmentState::QueueApply(const FRobotPartNetItem& Item)
+{
+	if (Item.Part)
+	{
+		PendingApply.AddUnique(Item.Part);
+	}
+}
+
+void ARobotAttachmentState::ApplyPending()
+{
+	if (HasAuthority() || PendingApply.Num() == 0)
+	{
+		return;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::ApplyNetState");
+
+	TMap<const AAttachablePart*, const FRobotPartNetItem*> ItemsByPart;
+	ItemsByPart.Reserve(Parts.Items.Num());
+	for (const FRobotPartNetItem& Item : Parts.Items)
+	{
+		if (Item.Part)
+		{
+			ItemsByPart.Add(Item.Part, &Item);
+		}
+	}
+
+	struct FLooseState
+	{
+		AAttachablePart* Part;
+		EPartState State;
+		FVector Location;
+	};
+	TArray<FLooseState, TInlineAllocator<8>> LooseParts;
+
+	// Socket changes go through one transaction, so a packet full of attaches validates and notifies once
+	FAttachmentTransaction Transaction;
+	Transaction.Reserve(PendingApply.Num());
+
+	for (const TWeakObjectPtr<AAttachablePart>& WeakPart : PendingApply)
+	{
+		AAttachablePart* Part = WeakPart.Get();
+		const FRobotPartNetItem* const* Found = Part ? ItemsByPart.Find(Part) : nullptr;
+		if (!Found || Predictions.Contains(Part))
+		{
+			continue;
+		}
+
+		const FRobotPartNetItem& Item = **Found;
+
+		// The local player moves its own held part, the server only confirms it
+		const APawn* HolderPawn = Cast<APawn>(Item.Holder);
+		if (Item.State == EPartState::HELD && HolderPawn && HolderPawn->IsLocallyControlled() && Part->IsHeld())
+		{
+			continue;
+		}
+
+		if (Item.State == EPartState::ATTACHED)
+		{
+			UAttachmentPoint* Point = UAttachmentPoint::FindByName(Item.Robot, Item.PointName);
+			if (Point && Part->GetAttachmentPoint() != Point)
+			{
+				Transaction.Attach(Part, Point);
+			}
+			continue;
+		}
+
+		if (Part->GetAttachmentPoint())
+		{
+			Transaction.Detach(Part);
+		}
+		LooseParts.Add({ Part, Item.State, Item.Location });
+	}
+
+	PendingApply.Reset();
+	Transaction.Commit(GetWorld());
+
+	for (const FLooseState& Loose : LooseParts)
+	{
+		if (Loose.State == EPartState::HELD)
+		{
+			if (!Loose.Part->IsHeld())
+			{
+				Loose.Part->PickUp();
+			}
+			Loose.Part->SetActorLocation(Loose.Location, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+		else
+		{
+			// The server already let it fall, this is where it came to rest
+			Loose.Part->PlaceAt(Loose.Location);
+		}
+	}
+}
+
+// ===== Subsystem =====
+
+bool URobotAttachmentStateSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URobotAttachmentStateSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Standalone games keep everything local, clients receive the server's actor
+	const ENetMode NetMode = InWorld.GetNetMode();
+	if (NetMode != NM_ListenServer && NetMode != NM_DedicatedServer)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	InWorld.SpawnActor<ARobotAttachmentState>(SpawnParams);
+}
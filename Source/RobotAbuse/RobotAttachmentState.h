@@ -0,0 +1,188 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttachablePart.h"
+#include "GameFramework/Info.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RobotAttachmentState.generated.h"
+
+class ARobotAttachmentState;
+class UAttachmentPoint;
+struct FRobotPartNetArray;
+
+/** Replicated state of one part. Sockets go by robot and component name, so runtime-built robots resolve too */
+USTRUCT()
+struct FRobotPartNetItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	AAttachablePart* Part = nullptr;
+
+	UPROPERTY()
+	EPartState State = EPartState::DETACHED;
+
+	// Socket the part sits in while ATTACHED
+	UPROPERTY()
+	AActor* Robot = nullptr;
+
+	UPROPERTY()
+	FName PointName;
+
+	// Pawn holding the part while HELD
+	UPROPERTY()
+	AActor* Holder = nullptr;
+
+	// Actor location while HELD or DETACHED
+	UPROPERTY()
+	FVector_NetQuantize10 Location;
+
+	// Server only, state changes are counted once per frame
+	uint64 LastOpFrame = 0;
+
+	void PostReplicatedAdd(const FRobotPartNetArray& Array);
+	void PostReplicatedChange(const FRobotPartNetArray& Array);
+};
+
+/** Delta-serialized part states: only items marked dirty since a connection's last ack are sent to it */
+USTRUCT()
+struct FRobotPartNetArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FRobotPartNetItem> Items;
+
+	// Not replicated, set by the owning actor
+	ARobotAttachmentState* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+};
+
+template<>
+struct TStructOpsTypeTraits<FRobotPartNetArray> : public TStructOpsTypeTraitsBase2<FRobotPartNetArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+/** Server side replication counters since the last reset, see robot.Net.Stats */
+struct FRobotNetStats
+{
+	/** Pickups, drops, attaches and detaches, once per part per frame */
+	int64 StateOps = 0;
+	int64 AttachOps = 0;
+
+	/** Held part location updates */
+	int64 Moves = 0;
+
+	/** Bits written for the part array, summed over every connection */
+	int64 BitsSent = 0;
+	int64 Sends = 0;
+
+	double GetBytesPerOp() const
+	{
+		const int64 Ops = StateOps + Moves;
+		return Ops > 0 ? BitsSent / 8.0 / Ops : 0.0;
+	}
+};
+
+/**
+ * Server-authoritative attachment state for multi-user sessions. Spawned by the server, always
+ * relevant, and the only thing that replicates part state: parts record themselves here on every
+ * pickup, drop, attach and detach, and clients apply the changes they receive through one
+ * FAttachmentTransaction per packet. Player actions reach the server through ARobotSpectatorPawn
+ * RPCs, which validate against this state before acting. Pickup and drop are predicted on the
+ * client and left alone until the server answers.
+ */
+UCLASS(NotPlaceable, Transient)
+class ROBOTABUSE_API ARobotAttachmentState : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ARobotAttachmentState();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** The session's state actor, nullptr in standalone games */
+	static ARobotAttachmentState* Get(const UWorld* World);
+
+	// ===== Server =====
+
+	/** Write Part's current state. Holder is kept across records while the part stays HELD */
+	void RecordPart(AAttachablePart* Part, AActor* Holder = nullptr);
+	void RecordMove(AAttachablePart* Part);
+	void RemovePart(AAttachablePart* Part);
+
+	/** Seconds between held part location updates, 0 if they are not sent. See robot.Net.DragSendRate */
+	static float GetMoveSendInterval();
+
+	/** False while someone else holds the part */
+	bool CanPickUp(const AAttachablePart* Part, const AActor* Instigator) const;
+	bool IsHeldBy(const AAttachablePart* Part, const AActor* Instigator) const;
+
+	/** True while the replicated state has Part held by anyone but Instigator. Predicted parts wait for the answer */
+	bool IsHeldByOther(const AAttachablePart* Part, const AActor* Instigator) const;
+
+	const FRobotNetStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FRobotNetStats(); }
+	void LogStats() const;
+
+	// ===== Client Prediction =====
+
+	/** The local player changed Part ahead of the server, replicated changes to it wait for the answer */
+	void BeginPrediction(AAttachablePart* Part);
+
+	/** Server answered. A rejected prediction is rolled back to the replicated state */
+	void EndPrediction(AAttachablePart* Part, bool bAccepted);
+
+private:
+	friend struct FRobotPartNetItem;
+	friend struct FRobotPartNetArray;
+
+	FRobotPartNetItem* FindItem(const AAttachablePart* Part);
+	const FRobotPartNetItem* FindItem(const AAttachablePart* Part) const;
+
+	// Client: apply everything received in the last packet
+	void QueueApply(const FRobotPartNetItem& Item);
+	void ApplyPending();
+
+	UPROPERTY(Replicated)
+	FRobotPartNetArray Parts;
+
+	// Server: part -> index into Parts.Items
+	TMap<const AAttachablePart*, int32> ItemIndices;
+
+	// Client: parts received since the last apply, and parts waiting on a server answer
+	TArray<TWeakObjectPtr<AAttachablePart>> PendingApply;
+	TMap<TWeakObjectPtr<AAttachablePart>, int32> Predictions;
+
+	FRobotNetStats Stats;
+};
+
+/** Spawns the session's ARobotAttachmentState on listen and dedicated servers and finds it for everyone */
+UCLASS()
+class ROBOTABUSE_API URobotAttachmentStateSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	void SetState(ARobotAttachmentState* InState) { State = InState; }
+	ARobotAttachmentState* GetState() const { return State; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	UPROPERTY()
+	ARobotAttachmentState* State = nullptr;
+};
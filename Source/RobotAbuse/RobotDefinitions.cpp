@@ -0,0 +1,70 @@
+#include "RobotDefinitions.h"
+
+#if WITH_EDITOR
+#include "Misc/DataValidation.h"
+#endif
+
+#define LOCTEXT_NAMESPACE "RobotDefinitions"
+
+const FPrimaryAssetType URobotPartDefinition::PrimaryAssetType(TEXT("RobotPartDefinition"));
+const FPrimaryAssetType URobotDefinition::PrimaryAssetType(TEXT("RobotDefinition"));
+
+static void AddIfUnloaded(const FSoftObjectPath& Path, TArray<FSoftObjectPath>& OutPaths)
+{
+	if (Path.IsValid() && !Path.ResolveObject())
+	{
+		OutPaths.AddUnique(Path);
+	}
+}
+
+void URobotDefinition::GetSpawnAssets(TArray<FSoftObjectPath>& OutPaths) const
+{
+	AddIfUnloaded(RobotClass.ToSoftObjectPath(), OutPaths);
+	AddIfUnloaded(Mesh.ToSoftObjectPath(), OutPaths);
+	AddIfUnloaded(SocketVisualMesh.ToSoftObjectPath(), OutPaths);
+
+	for (const FRobotSocketDefinition& Socket : Sockets)
+	{
+		if (const URobotPartDefinition* Part = Socket.InitialPart.Get())
+		{
+			AddIfUnloaded(Part->PartClass.ToSoftObjectPath(), OutPaths);
+			AddIfUnloaded(Part->Mesh.ToSoftObjectPath(), OutPaths);
+		}
+		else
+		{
+			AddIfUnloaded(Socket.InitialPart.ToSoftObjectPath(), OutPaths);
+		}
+	}
+}
+
+FName URobotDefinition::GetSocketName(int32 Index) const
+{
+	const FName Name = Sockets.IsValidIndex(Index) ? Sockets[Index].Name : NAME_None;
+	return Name.IsNone() ? FName(TEXT("Socket"), Index + 1) : Name;
+}
+
+#if WITH_EDITOR
+EDataValidationResult URobotDefinition::IsDataValid(FDataValidationContext& Context) const
+{
+	EDataValidationResult Result = Super::IsDataValid(Context);
+
+	// The torso would skip the second socket of a name, and snapshots and replication could not tell them apart
+	TSet<FName> Names;
+	for (int32 Index = 0; Index < Sockets.Num(); Index++)
+	{
+		const FName Name = GetSocketName(Index);
+		bool bAlreadySet = false;
+		Names.Add(Name, &bAlreadySet);
+		if (bAlreadySet)
+		{
+			Context.AddError(FText::Format(LOCTEXT("DuplicateSocketName", "Socket {0} has the name {1}, which another socket already uses"),
+				FText::AsNumber(Index), FText::FromName(Name)));
+			Result = EDataValidationResult::Invalid;
+		}
+	}
+
+	return Result;
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttachablePart.h"
+#include "Engine/DataAsset.h"
+#include "RobotDefinitions.generated.h"
+
+class ARobotTorso;
+class UStaticMesh;
+
+/**
+ * One kind of robot part. Primary asset of type RobotPartDefinition, found by the asset manager in
+ * /Game/Robots and loaded with its "Game" bundle by URobotAssetPreloader before play needs it.
+ */
+UCLASS(BlueprintType)
+class ROBOTABUSE_API URobotPartDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override { return FPrimaryAssetId(PrimaryAssetType, GetFName()); }
+
+	/** Actor to spawn, AAttachablePart if empty */
+	UPROPERTY(EditDefaultsOnly, Category = "Part", meta = (AssetBundles = "Game"))
+	TSoftClassPtr<AAttachablePart> PartClass;
+
+	/** Used when the class brings no mesh of its own */
+	UPROPERTY(EditDefaultsOnly, Category = "Part", meta = (AssetBundles = "Game"))
+	TSoftObjectPtr<UStaticMesh> Mesh;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Part")
+	EArmType ArmType = EArmType::Universal;
+
+	/** Names from [RobotAbuse.PartCategories], see AAttachablePart::Categories */
+	UPROPERTY(EditDefaultsOnly, Category = "Part")
+	TArray<FName> Categories;
+};
+
+/** One socket of a robot definition and the part it starts with */
+USTRUCT(BlueprintType)
+struct FRobotSocketDefinition
+{
+	GENERATED_BODY()
+
+	/** Component name of the socket, how replication and snapshots find it. Socket_<n> if empty, must be unique */
+	UPROPERTY(EditDefaultsOnly, Category = "Socket")
+	FName Name;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Socket")
+	FVector RelativeLocation = FVector::ZeroVector;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Socket")
+	EArmType AcceptedArmType = EArmType::Universal;
+
+	/** See UAttachmentPoint::AcceptedCategories */
+	UPROPERTY(EditDefaultsOnly, Category = "Socket")
+	TArray<FName> AcceptedCategories;
+
+	/** Attached when the robot begins play, empty socket if not set */
+	UPROPERTY(EditDefaultsOnly, Category = "Socket", meta = (AssetBundles = "Game"))
+	TSoftObjectPtr<URobotPartDefinition> InitialPart;
+};
+
+/**
+ * One kind of robot: torso, sockets and the parts they start with. Primary asset of type RobotDefinition,
+ * see URobotPartDefinition. Spawned by FRobotAssemblyBatch, which needs everything GetSpawnAssets lists in memory.
+ */
+UCLASS(BlueprintType)
+class ROBOTABUSE_API URobotDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override { return FPrimaryAssetId(PrimaryAssetType, GetFName()); }
+
+	/** Torso to spawn, ARobotTorso if empty */
+	UPROPERTY(EditDefaultsOnly, Category = "Robot", meta = (AssetBundles = "Game"))
+	TSoftClassPtr<ARobotTorso> RobotClass;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Robot", meta = (AssetBundles = "Game"))
+	TSoftObjectPtr<UStaticMesh> Mesh;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Robot", meta = (AssetBundles = "Game"))
+	TSoftObjectPtr<UStaticMesh> SocketVisualMesh;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Robot")
+	TArray<FRobotSocketDefinition> Sockets;
+
+	/** Component name of socket Index, the same on the server and on every client */
+	FName GetSocketName(int32 Index) const;
+
+#if WITH_EDITOR
+	virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+#endif
+
+	/**
+	 * Append the classes, meshes and part definitions spawning this robot needs that are not loaded yet.
+	 * Part definitions come first and their own assets only once they are loaded, so load until this adds nothing
+	 */
+	void GetSpawnAssets(TArray<FSoftObjectPath>& OutPaths) const;
+};
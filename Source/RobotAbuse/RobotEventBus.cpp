@@ -0,0 +1,108 @@
+#include "RobotEventBus.h"
+#include "RobotAbuse.h"
+#include "Engine/World.h"
+
+void URobotEventBus::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UAttachmentRegistry* Registry = Collection.InitializeDependency<UAttachmentRegistry>())
+	{
+		AttachmentsChangedHandle = Registry->OnAttachmentsChanged.AddUObject(this, &URobotEventBus::HandleAttachmentsChanged);
+	}
+}
+
+void URobotEventBus::Deinitialize()
+{
+	if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+	{
+		Registry->OnAttachmentsChanged.Remove(AttachmentsChangedHandle);
+	}
+
+	PendingEvents.Empty();
+	DispatchingEvents.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId URobotEventBus::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URobotEventBus, STATGROUP_Tickables);
+}
+
+void URobotEventBus::Tick(float DeltaTime)
+{
+	Flush();
+}
+
+void URobotEventBus::Post(ERobotEventType Type, AAttachablePart* Part, AActor* Instigator)
+{
+	FRobotEvent Event;
+	Event.Type = Type;
+	Event.Part = Part;
+	Event.Instigator = Instigator;
+	Post(Event);
+}
+
+void URobotEventBus::Post(const FRobotEvent& Event)
+{
+	// Nobody would hear it
+	if (!OnEvents.IsBound())
+	{
+		return;
+	}
+
+	// Only where the cursor ended up matters, not every part it crossed on the way. The survivor moves
+	// to the end, so it is still ordered after whatever was posted between the two hovers
+	if (Event.Type == ERobotEventType::HoverChanged)
+	{
+		const int32 Index = PendingEvents.IndexOfByPredicate([&Event](const FRobotEvent& Pending)
+		{
+			return Pending.Type == ERobotEventType::HoverChanged && Pending.Instigator == Event.Instigator;
+		});
+		if (Index != INDEX_NONE)
+		{
+			PendingEvents.RemoveAt(Index, 1, EAllowShrinking::No);
+		}
+	}
+
+	PendingEvents.Add(Event);
+}
+
+void URobotEventBus::Flush()
+{
+	// Subscribers may post in response, those events go out in the next round of this loop
+	if (bDispatching)
+	{
+		return;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::EventBus");
+
+	TGuardValue<bool> DispatchGuard(bDispatching, true);
+
+	while (PendingEvents.Num() > 0)
+	{
+		// Swap buffers so both keep their capacity between frames
+		Swap(PendingEvents, DispatchingEvents);
+		OnEvents.Broadcast(DispatchingEvents);
+		DispatchingEvents.Reset();
+	}
+}
+
+void URobotEventBus::HandleAttachmentsChanged(TConstArrayView<FAttachmentChange> Changes)
+{
+	if (!OnEvents.IsBound())
+	{
+		return;
+	}
+
+	for (const FAttachmentChange& Change : Changes)
+	{
+		FRobotEvent& Event = PendingEvents.AddDefaulted_GetRef();
+		Event.Type = ERobotEventType::SocketChanged;
+		Event.Part = Change.Part;
+		Event.Point = Change.NewSocket;
+		Event.OldPoint = Change.OldSocket;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttachmentRegistry.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RobotEventBus.generated.h"
+
+class AAttachablePart;
+class UAttachmentPoint;
+
+enum class ERobotEventType : uint8
+{
+	/** Instigator's cursor moved onto Part, or off every part if Part is null */
+	HoverChanged,
+	PickedUp,
+	Dropped,
+	Attached,
+	/** Instigator stopped dragging Part because someone else put it down, see ARobotSpectatorPawn::ReleaseLostPart */
+	Released,
+	/** Part moved from OldPoint to Point, from any source. Either side may be null */
+	SocketChanged,
+	/** Part was picked up or dropped, from any source */
+	StateChanged
+};
+
+/** One part or socket event. Plain pointers only, so queueing one never allocates */
+struct FRobotEvent
+{
+	ERobotEventType Type = ERobotEventType::HoverChanged;
+	AAttachablePart* Part = nullptr;
+	UAttachmentPoint* Point = nullptr;
+	UAttachmentPoint* OldPoint = nullptr;
+
+	/** Pawn that caused the event, null for socket changes */
+	AActor* Instigator = nullptr;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnRobotEvents, TConstArrayView<FRobotEvent>);
+
+/**
+ * Native event bus for part and socket events. Events are queued as they happen and go out once a
+ * frame, every subscriber gets one call with everything since the last dispatch. Repeated hover
+ * changes from the same pawn within a frame collapse into the last one. Socket changes come from
+ * UAttachmentRegistry, so attaches made by transactions, undo or replication show up as well.
+ * Nothing is queued while nobody is subscribed, and the queues keep their capacity between frames.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotEventBus : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return PendingEvents.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+
+	void Post(ERobotEventType Type, AAttachablePart* Part, AActor* Instigator = nullptr);
+	void Post(const FRobotEvent& Event);
+
+	/** Dispatch now instead of at the end of the frame */
+	void Flush();
+
+	FOnRobotEvents OnEvents;
+
+	int32 GetNumPending() const { return PendingEvents.Num(); }
+
+private:
+	void HandleAttachmentsChanged(TConstArrayView<FAttachmentChange> Changes);
+
+	// Events waiting for the next dispatch, and the buffer being dispatched right now
+	TArray<FRobotEvent> PendingEvents;
+	TArray<FRobotEvent> DispatchingEvents;
+	bool bDispatching = false;
+
+	FDelegateHandle AttachmentsChangedHandle;
+};
@@ -0,0 +1,291 @@
+#include "RobotFleetRenderer.h"
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "RobotAbuse.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarRobotFleetInstancing(
+	TEXT("robot.Fleet.Instancing"),
+	false,
+	TEXT("Draw idle attached robot parts as shared instances instead of one mesh component per part."));
+
+static FAutoConsoleCommandWithWorld CmdRobotFleetStats(
+	TEXT("robot.Fleet.Stats"),
+	TEXT("Log registered primitive components and fleet instance counts for the current world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		int32 NumPrimitives = 0;
+		for (TObjectIterator<UPrimitiveComponent> It; It; ++It)
+		{
+			if (It->GetWorld() == World && It->IsRegistered())
+			{
+				NumPrimitives++;
+			}
+		}
+
+		const URobotFleetRenderer* Fleet = UWorld::GetSubsystem<URobotFleetRenderer>(World);
+		UE_LOG(LogRobotAbuse, Display, TEXT("Fleet: %d registered primitive components, %d instanced parts in %d batches"),
+			NumPrimitives, Fleet ? Fleet->GetNumInstances() : 0, Fleet ? Fleet->GetNumBatches() : 0);
+	}));
+
+bool URobotFleetRenderer::IsFleetModeEnabled()
+{
+	return CVarRobotFleetInstancing.GetValueOnGameThread();
+}
+
+void URobotFleetRenderer::Deinitialize()
+{
+	for (const TPair<const AAttachablePart*, FSlot>& Pair : PartSlots)
+	{
+		if (AAttachablePart* Part = const_cast<AAttachablePart*>(Pair.Key))
+		{
+			Part->bInstancedByFleet = false;
+		}
+	}
+
+	for (const TPair<USceneComponent*, FRobotWatch>& Pair : WatchedRobots)
+	{
+		if (IsValid(Pair.Key))
+		{
+			Pair.Key->TransformUpdated.Remove(Pair.Value.Handle);
+		}
+	}
+
+	WatchedRobots.Empty();
+	PartSlots.Empty();
+	Batches.Empty();
+	BatchLookup.Empty();
+	BatchComponents.Empty();
+	HostActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool URobotFleetRenderer::Demote(AAttachablePart* Part)
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::FleetDemote");
+
+	if (!IsFleetModeEnabled() || !IsValid(Part) || Part->bInstancedByFleet || !Part->IsAttached())
+	{
+		return false;
+	}
+
+	// Only single-mesh parts can be represented by one instance. Parts on the dynamic material fallback
+	// would get a batch each and their material does not read the instance custom data either
+	UStaticMeshComponent* Mesh = Part->GetMeshComponent();
+	if (!Mesh || !Mesh->GetStaticMesh() || !Mesh->IsRegistered() || Part->GetNumHighlightMeshes() != 1 || Part->UsesHighlightFallback())
+	{
+		return false;
+	}
+
+	const AActor* Robot = Part->GetAttachmentPoint()->GetOwner();
+	USceneComponent* RobotRoot = Robot ? Robot->GetRootComponent() : nullptr;
+	if (!RobotRoot)
+	{
+		return false;
+	}
+
+	const int32 BatchIndex = FindOrAddBatch(Mesh->GetStaticMesh(), Mesh->GetMaterials());
+	if (BatchIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FBatch& Batch = Batches[BatchIndex];
+	const int32 InstanceIndex = Batch.Component->AddInstance(Mesh->GetComponentTransform(), /*bWorldSpace*/ true);
+	Batch.Component->SetCustomDataValue(InstanceIndex, 0, Part->GetCurrentEmissive(), true);
+
+	check(InstanceIndex == Batch.InstanceParts.Num());
+	Batch.InstanceParts.Add(Part);
+	PartSlots.Add(Part, { BatchIndex, InstanceIndex, RobotRoot });
+	WatchRobot(RobotRoot, Part);
+
+	// Drop the render proxy and physics body, the actor and its attachment stay as they are
+	Mesh->UnregisterComponent();
+	Part->SetActorTickEnabled(false);
+	Part->bInstancedByFleet = true;
+
+	INC_DWORD_STAT(STAT_RobotFleetInstances);
+	return true;
+}
+
+void URobotFleetRenderer::Promote(AAttachablePart* Part)
+{
+	FSlot Slot;
+	if (!Part || !PartSlots.RemoveAndCopyValue(Part, Slot))
+	{
+		return;
+	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::FleetPromote");
+
+	RemoveInstance(Slot);
+	UnwatchRobot(Slot.RobotRoot, Part);
+
+	Part->bInstancedByFleet = false;
+	Part->SetActorTickEnabled(true);
+
+	if (UStaticMeshComponent* Mesh = Part->GetMeshComponent())
+	{
+		Mesh->RegisterComponent();
+	}
+
+	DEC_DWORD_STAT(STAT_RobotFleetInstances);
+}
+
+AAttachablePart* URobotFleetRenderer::PromoteFromHit(const FHitResult& Hit)
+{
+	UInstancedStaticMeshComponent* Component = Cast<UInstancedStaticMeshComponent>(Hit.GetComponent());
+	if (!Component || Component->GetOwner() != HostActor || Hit.Item == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	for (const FBatch& Batch : Batches)
+	{
+		if (Batch.Component != Component || !Batch.InstanceParts.IsValidIndex(Hit.Item))
+		{
+			continue;
+		}
+
+		// The hit can be from an earlier trace, and a removal since then swaps another part into its
+		// index. Only trust the index if the instance there now is the one the trace touched
+		FTransform InstanceTransform;
+		Component->GetInstanceTransform(Hit.Item, InstanceTransform, /*bWorldSpace*/ true);
+		const FBox InstanceBounds = Component->GetStaticMesh()->GetBounds().GetBox().TransformBy(InstanceTransform);
+		if (!InstanceBounds.ExpandBy(1.0f).IsInside(Hit.ImpactPoint))
+		{
+			return nullptr;
+		}
+
+		AAttachablePart* Part = Batch.InstanceParts[Hit.Item];
+		Promote(Part);
+		return Part;
+	}
+
+	return nullptr;
+}
+
+void URobotFleetRenderer::SetInstanceEmissive(const AAttachablePart* Part, float Value)
+{
+	if (const FSlot* Slot = PartSlots.Find(Part))
+	{
+		Batches[Slot->Batch].Component->SetCustomDataValue(Slot->Instance, 0, Value, true);
+	}
+}
+
+int32 URobotFleetRenderer::FindOrAddBatch(UStaticMesh* Mesh, TConstArrayView<UMaterialInterface*> Materials)
+{
+	FBatchKey Key;
+	Key.Mesh = Mesh;
+	Key.Materials.Append(Materials.GetData(), Materials.Num());
+
+	if (const int32* Existing = BatchLookup.Find(Key))
+	{
+		return *Existing;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return INDEX_NONE;
+	}
+
+	if (!HostActor)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Name = TEXT("RobotFleetInstances");
+		SpawnParams.ObjectFlags |= RF_Transient;
+		HostActor = World->SpawnActor<AActor>(SpawnParams);
+
+		USceneComponent* Root = NewObject<USceneComponent>(HostActor, TEXT("Root"));
+		HostActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(HostActor);
+	Component->SetStaticMesh(Mesh);
+	for (int32 i = 0; i < Materials.Num(); i++)
+	{
+		Component->SetMaterial(i, Materials[i]);
+	}
+
+	// Instances stay clickable so the cursor trace can find the part behind them
+	Component->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	Component->SetCollisionResponseToAllChannels(ECR_Block);
+	Component->SetGenerateOverlapEvents(false);
+	Component->SetNumCustomDataFloats(1);
+	Component->bSupportRemoveAtSwap = true;
+	Component->SetupAttachment(HostActor->GetRootComponent());
+	Component->RegisterComponent();
+
+	BatchComponents.Add(Component);
+
+	const int32 BatchIndex = Batches.AddDefaulted();
+	Batches[BatchIndex].Component = Component;
+	BatchLookup.Add(MoveTemp(Key), BatchIndex);
+	return BatchIndex;
+}
+
+void URobotFleetRenderer::RemoveInstance(const FSlot& Slot)
+{
+	FBatch& Batch = Batches[Slot.Batch];
+	const int32 LastIndex = Batch.InstanceParts.Num() - 1;
+
+	// The component removes with a swap, mirror it so indices keep matching
+	Batch.Component->RemoveInstance(Slot.Instance);
+	Batch.InstanceParts.RemoveAtSwap(Slot.Instance, EAllowShrinking::No);
+
+	if (Slot.Instance != LastIndex)
+	{
+		PartSlots[Batch.InstanceParts[Slot.Instance]].Instance = Slot.Instance;
+	}
+}
+
+void URobotFleetRenderer::WatchRobot(USceneComponent* RobotRoot, AAttachablePart* Part)
+{
+	FRobotWatch& Watch = WatchedRobots.FindOrAdd(RobotRoot);
+	if (!Watch.Handle.IsValid())
+	{
+		Watch.Handle = RobotRoot->TransformUpdated.AddUObject(this, &URobotFleetRenderer::HandleRobotMoved);
+	}
+	Watch.Parts.Add(Part);
+}
+
+void URobotFleetRenderer::UnwatchRobot(USceneComponent* RobotRoot, AAttachablePart* Part)
+{
+	FRobotWatch* Watch = WatchedRobots.Find(RobotRoot);
+	if (!Watch)
+	{
+		return;
+	}
+
+	Watch->Parts.RemoveSwap(Part, EAllowShrinking::No);
+	if (Watch->Parts.Num() == 0)
+	{
+		if (IsValid(RobotRoot))
+		{
+			RobotRoot->TransformUpdated.Remove(Watch->Handle);
+		}
+		WatchedRobots.Remove(RobotRoot);
+	}
+}
+
+void URobotFleetRenderer::HandleRobotMoved(USceneComponent* RobotRoot, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	const FRobotWatch* Watch = WatchedRobots.Find(RobotRoot);
+	if (!Watch)
+	{
+		return;
+	}
+
+	// Moved by anything, not just a torso drag: the instances would stay behind, so give the parts back their meshes
+	const TArray<AAttachablePart*> Parts = Watch->Parts;
+	for (AAttachablePart* Part : Parts)
+	{
+		Promote(Part);
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RobotFleetRenderer.generated.h"
+
+class AAttachablePart;
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class USceneComponent;
+class UStaticMesh;
+struct FHitResult;
+enum class EUpdateTransformFlags : int32;
+enum class ETeleportType : uint8;
+
+/**
+ * Fleet mode: draws idle attached parts as instances of shared instanced static mesh components.
+ * A demoted part keeps its actor but its mesh is unregistered, so it costs no scene proxy and no
+ * physics body. Its emissive state lives in per-instance custom data slot 0, which the part's
+ * material must read through a PerInstanceCustomData node; parts still highlighting through the
+ * dynamic material fallback are never demoted. The part is promoted back to its own mesh as soon
+ * as it is hovered, picked up or its robot's root moves for any reason.
+ * Enabled with robot.Fleet.Instancing.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotFleetRenderer : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static bool IsFleetModeEnabled();
+
+	/** Move an idle attached part into its instance batch. Returns false if the part does not qualify */
+	bool Demote(AAttachablePart* Part);
+
+	/** Give a part its own mesh back. No-op for parts that are not instanced */
+	void Promote(AAttachablePart* Part);
+
+	/** If the hit is one of our instances, promote the part behind it and return it */
+	AAttachablePart* PromoteFromHit(const FHitResult& Hit);
+
+	/** Write a demoted part's emissive strength into its instance custom data */
+	void SetInstanceEmissive(const AAttachablePart* Part, float Value);
+
+	int32 GetNumInstances() const { return PartSlots.Num(); }
+	int32 GetNumBatches() const { return Batches.Num(); }
+
+private:
+	struct FBatch
+	{
+		UInstancedStaticMeshComponent* Component = nullptr;
+		TArray<AAttachablePart*> InstanceParts;
+	};
+
+	struct FSlot
+	{
+		int32 Batch = INDEX_NONE;
+		int32 Instance = INDEX_NONE;
+		USceneComponent* RobotRoot = nullptr;
+	};
+
+	/** Demoted parts of one robot, promoted together when its root moves */
+	struct FRobotWatch
+	{
+		FDelegateHandle Handle;
+		TArray<AAttachablePart*> Parts;
+	};
+
+	int32 FindOrAddBatch(UStaticMesh* Mesh, TConstArrayView<UMaterialInterface*> Materials);
+	void RemoveInstance(const FSlot& Slot);
+
+	void WatchRobot(USceneComponent* RobotRoot, AAttachablePart* Part);
+	void UnwatchRobot(USceneComponent* RobotRoot, AAttachablePart* Part);
+	void HandleRobotMoved(USceneComponent* RobotRoot, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	// Owns the instance components
+	UPROPERTY()
+	AActor* HostActor;
+
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> BatchComponents;
+
+	TArray<FBatch> Batches;
+
+	// Parts only share a batch if they draw the same mesh with the same materials
+	struct FBatchKey
+	{
+		UStaticMesh* Mesh = nullptr;
+		TArray<UMaterialInterface*, TInlineAllocator<4>> Materials;
+
+		friend bool operator==(const FBatchKey& A, const FBatchKey& B) { return A.Mesh == B.Mesh && A.Materials == B.Materials; }
+		friend uint32 GetTypeHash(const FBatchKey& Key)
+		{
+			uint32 Hash = GetTypeHash(Key.Mesh);
+			for (const UMaterialInterface* Material : Key.Materials)
+			{
+				Hash = HashCombineFast(Hash, GetTypeHash(Material));
+			}
+			return Hash;
+		}
+	};
+
+	TMap<FBatchKey, int32> BatchLookup;
+
+	TMap<const AAttachablePart*, FSlot> PartSlots;
+
+	TMap<USceneComponent*, FRobotWatch> WatchedRobots;
+};
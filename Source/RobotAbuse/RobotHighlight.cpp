@@ -0,0 +1,120 @@
+#include "RobotHighlight.h"
+#include "RobotAbuse.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/Actor.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+namespace RobotHighlight
+{
+	/** True if Material has Parameter as an ordinary scalar, not one bound to custom primitive data */
+	static bool NeedsFallback(UMaterialInterface* Material, FName Parameter)
+	{
+		FMaterialParameterMetadata Metadata;
+		if (!Material->GetParameterValue(EMaterialParameterType::Scalar, FMemoryImageMaterialParameterInfo(Parameter), Metadata))
+		{
+			return false;
+		}
+
+		return Metadata.PrimitiveDataIndex == INDEX_NONE;
+	}
+
+	static void Reset(FName FallbackParameter, FRobotHighlightMeshes& OutMeshes)
+	{
+		DEC_DWORD_STAT_BY(STAT_RobotMIDsAvoided, OutMeshes.NumMIDsAvoided);
+
+		OutMeshes.Meshes.Reset();
+		OutMeshes.FallbackMaterials.Reset();
+		OutMeshes.FallbackParameter = FallbackParameter;
+		OutMeshes.NumMIDsAvoided = 0;
+	}
+
+	static void AddMesh(UMeshComponent* Mesh, UObject* Outer, FRobotHighlightMeshes& OutMeshes)
+	{
+		OutMeshes.Meshes.Add(Mesh);
+
+		for (int32 Slot = 0; Slot < Mesh->GetNumMaterials(); Slot++)
+		{
+			UMaterialInterface* Material = Mesh->GetMaterial(Slot);
+			if (!Material)
+			{
+				continue;
+			}
+
+			if (UMaterialInstanceDynamic* Existing = Cast<UMaterialInstanceDynamic>(Material))
+			{
+				// Already given an instance by an earlier collect
+				if (Existing->GetOuter() == Outer)
+				{
+					OutMeshes.FallbackMaterials.Add(Existing);
+					continue;
+				}
+			}
+
+			if (!OutMeshes.FallbackParameter.IsNone() && NeedsFallback(Material, OutMeshes.FallbackParameter))
+			{
+				UMaterialInstanceDynamic* Instance = UMaterialInstanceDynamic::Create(Material, Outer);
+				Mesh->SetMaterial(Slot, Instance);
+				OutMeshes.FallbackMaterials.Add(Instance);
+			}
+			else
+			{
+				// Each slot used to get its own UMaterialInstanceDynamic
+				OutMeshes.NumMIDsAvoided++;
+			}
+		}
+	}
+
+	void CollectMeshes(AActor* Owner, FName FallbackParameter, FRobotHighlightMeshes& OutMeshes)
+	{
+		Reset(FallbackParameter, OutMeshes);
+
+		if (!Owner)
+		{
+			return;
+		}
+
+		TArray<UStaticMeshComponent*> MeshComponents;
+		Owner->GetComponents<UStaticMeshComponent>(MeshComponents);
+
+		for (UStaticMeshComponent* Mesh : MeshComponents)
+		{
+			if (Mesh)
+			{
+				AddMesh(Mesh, Owner, OutMeshes);
+			}
+		}
+
+		INC_DWORD_STAT_BY(STAT_RobotMIDsAvoided, OutMeshes.NumMIDsAvoided);
+	}
+
+	void CollectMesh(UMeshComponent* Mesh, UObject* Outer, FName FallbackParameter, FRobotHighlightMeshes& OutMeshes)
+	{
+		Reset(FallbackParameter, OutMeshes);
+
+		if (Mesh)
+		{
+			AddMesh(Mesh, Outer, OutMeshes);
+		}
+
+		INC_DWORD_STAT_BY(STAT_RobotMIDsAvoided, OutMeshes.NumMIDsAvoided);
+	}
+
+	void SetEmissive(const FRobotHighlightMeshes& Meshes, int32 DataIndex, float Value)
+	{
+		for (UPrimitiveComponent* Mesh : Meshes.Meshes)
+		{
+			if (Mesh)
+			{
+				Mesh->SetCustomPrimitiveDataFloat(DataIndex, Value);
+			}
+		}
+
+		for (UMaterialInstanceDynamic* Material : Meshes.FallbackMaterials)
+		{
+			if (Material)
+			{
+				Material->SetScalarParameterValue(Meshes.FallbackParameter, Value);
+			}
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RobotHighlight.generated.h"
+
+class AActor;
+class UMaterialInstanceDynamic;
+class UMeshComponent;
+class UPrimitiveComponent;
+
+/** The meshes of one owner that glow when it is highlighted */
+USTRUCT()
+struct ROBOTABUSE_API FRobotHighlightMeshes
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UPrimitiveComponent*> Meshes;
+
+	/** Dynamic instances for slots whose material still reads FallbackParameter instead of custom primitive data */
+	UPROPERTY()
+	TArray<UMaterialInstanceDynamic*> FallbackMaterials;
+
+	FName FallbackParameter;
+
+	/** Slots counted in STAT_RobotMIDsAvoided, taken back out when the meshes are collected again */
+	int32 NumMIDsAvoided = 0;
+
+	int32 Num() const { return Meshes.Num(); }
+};
+
+/**
+ * Shared highlight path for robot meshes.
+ * Emissive strength is written to a custom primitive data slot that the robot materials read,
+ * so highlighting needs no dynamic material instances and meshes keep batching together.
+ * Slots whose material still exposes FallbackParameter as a plain scalar get a dynamic
+ * instance as before, so content that has not been switched over keeps highlighting.
+ */
+namespace RobotHighlight
+{
+	/** Collect the static meshes of an actor that should glow when it is highlighted */
+	ROBOTABUSE_API void CollectMeshes(AActor* Owner, FName FallbackParameter, FRobotHighlightMeshes& OutMeshes);
+
+	/** Collect a single mesh, for components that highlight one visual rather than their whole owner */
+	ROBOTABUSE_API void CollectMesh(UMeshComponent* Mesh, UObject* Outer, FName FallbackParameter, FRobotHighlightMeshes& OutMeshes);
+
+	/** Write the emissive strength into DataIndex on every mesh - one primitive data write each, plus any fallback instances */
+	ROBOTABUSE_API void SetEmissive(const FRobotHighlightMeshes& Meshes, int32 DataIndex, float Value);
+}
@@ -0,0 +1,239 @@
+#include "RobotLoadDriver.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "RobotSpectatorPawn.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static FAutoConsoleCommandWithWorldAndArgs CmdRobotLoadTestStart(
+	TEXT("robot.LoadTest.Start"),
+	TEXT("Drive synthetic users through the interaction code. Args: [Users=1] [ClicksPerSecond=2] [Seed=0]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (URobotLoadDriver* Driver = UWorld::GetSubsystem<URobotLoadDriver>(World))
+		{
+			FRobotLoadParams Params;
+			Params.NumUsers = Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : Params.NumUsers;
+			Params.ClicksPerSecond = Args.IsValidIndex(1) ? FCString::Atof(*Args[1]) : Params.ClicksPerSecond;
+			Params.Seed = Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : Params.Seed;
+			Driver->Start(Params);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CmdRobotLoadTestStop(
+	TEXT("robot.LoadTest.Stop"),
+	TEXT("Stop the synthetic users and log throughput and latency."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (URobotLoadDriver* Driver = UWorld::GetSubsystem<URobotLoadDriver>(World))
+		{
+			Driver->Stop();
+			Driver->LogStats();
+		}
+	}));
+
+void URobotLoadDriver::Deinitialize()
+{
+	// The world is going away with the virtual users in it, nothing to destroy
+	Pawns.Reset();
+	Users.Reset();
+	Parts.Reset();
+	Sockets.Reset();
+	bRunning = false;
+
+	Super::Deinitialize();
+}
+
+TStatId URobotLoadDriver::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URobotLoadDriver, STATGROUP_Tickables);
+}
+
+// ===== Session =====
+
+void URobotLoadDriver::Start(const FRobotLoadParams& InParams)
+{
+	Stop();
+
+	UWorld* World = GetWorld();
+	Params = InParams;
+	Stats = FRobotLoadStats();
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (AAttachablePart* Part = Cast<AAttachablePart>(*It))
+		{
+			Parts.Add(Part);
+		}
+
+		TInlineComponentArray<UAttachmentPoint*> ActorSockets(*It);
+		Sockets.Append(ActorSockets);
+	}
+
+	if (Parts.Num() == 0)
+	{
+		UE_LOG(LogRobotAbuse, Warning, TEXT("Load test needs at least one part in the world"));
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	for (int32 UserIndex = 0; UserIndex < Params.NumUsers; UserIndex++)
+	{
+		ARobotSpectatorPawn* Pawn = World->SpawnActor<ARobotSpectatorPawn>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+		if (!Pawn)
+		{
+			continue;
+		}
+
+		// The driver ticks the pawn itself so every step can be timed
+		Pawn->SetActorTickEnabled(false);
+		Pawns.Add(Pawn);
+
+		FVirtualUser& User = Users.AddDefaulted_GetRef();
+		User.Pawn = Pawn;
+		User.Random.Initialize(Params.Seed + UserIndex);
+		User.Cursor = Parts[User.Random.RandHelper(Parts.Num())]->GetActorLocation();
+		User.NextClickTime = User.Random.FRandRange(0.0f, 1.0f / FMath::Max(Params.ClicksPerSecond, 0.01f));
+		PickGoal(User);
+	}
+
+	bRunning = Users.Num() > 0;
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("Load test started: %d users, %.1f clicks/s each, seed %d, %d parts, %d sockets"),
+		Users.Num(), Params.ClicksPerSecond, Params.Seed, Parts.Num(), Sockets.Num());
+}
+
+void URobotLoadDriver::Stop()
+{
+	for (ARobotSpectatorPawn* Pawn : Pawns)
+	{
+		if (IsValid(Pawn))
+		{
+			Pawn->Destroy();
+		}
+	}
+
+	Pawns.Reset();
+	Users.Reset();
+	Parts.Reset();
+	Sockets.Reset();
+	bRunning = false;
+}
+
+void URobotLoadDriver::LogStats() const
+{
+	const double WallSeconds = Stats.StepSeconds + Stats.ClickSeconds;
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("Load test: %lld frames, %.1f s simulated, %lld steps, %lld clicks (%lld pickups, %lld attaches, %lld drops)"),
+		Stats.Frames, Stats.SimulatedSeconds, Stats.Steps, Stats.Clicks, Stats.PickUps, Stats.Attaches, Stats.Drops);
+	UE_LOG(LogRobotAbuse, Log, TEXT("Load test: step %.2f us avg / %.2f us max, click %.2f us avg / %.2f us max, %.0f steps/s, checksum %08x"),
+		Stats.GetAverageStepUs(), Stats.MaxStepSeconds * 1.0e6, Stats.GetAverageClickUs(), Stats.MaxClickSeconds * 1.0e6,
+		WallSeconds > 0.0 ? Stats.Steps / WallSeconds : 0.0, Stats.Checksum);
+}
+
+// ===== Virtual Users =====
+
+void URobotLoadDriver::Tick(float DeltaTime)
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::LoadDriver");
+
+	Stats.Frames++;
+	Stats.SimulatedSeconds += DeltaTime;
+
+	for (int32 UserIndex = 0; UserIndex < Users.Num(); UserIndex++)
+	{
+		FVirtualUser& User = Users[UserIndex];
+		if (IsValid(User.Pawn))
+		{
+			StepUser(User, UserIndex, DeltaTime);
+		}
+	}
+}
+
+void URobotLoadDriver::StepUser(FVirtualUser& User, int32 UserIndex, float DeltaTime)
+{
+	// Glide towards the goal, then click once the user is due
+	const FVector ToGoal = User.Goal - User.Cursor;
+	const float MaxMove = Params.CursorSpeed * DeltaTime;
+	const bool bAtGoal = ToGoal.SizeSquared() <= FMath::Square(MaxMove);
+	User.Cursor = bAtGoal ? User.Goal : User.Cursor + ToGoal.GetSafeNormal() * MaxMove;
+
+	User.Pawn->SetSyntheticCursor(User.Cursor + FVector(0.0f, 0.0f, Params.CursorHeight), FVector::DownVector);
+
+	const double Start = FPlatformTime::Seconds();
+	User.Pawn->Tick(DeltaTime);
+	const double Seconds = FPlatformTime::Seconds() - Start;
+
+	Stats.Steps++;
+	Stats.StepSeconds += Seconds;
+	Stats.MaxStepSeconds = FMath::Max(Stats.MaxStepSeconds, Seconds);
+
+	if (bAtGoal && Stats.SimulatedSeconds >= User.NextClickTime)
+	{
+		ClickUser(User, UserIndex);
+		User.NextClickTime = Stats.SimulatedSeconds + 1.0f / FMath::Max(Params.ClicksPerSecond, 0.01f);
+		PickGoal(User);
+	}
+}
+
+void URobotLoadDriver::ClickUser(FVirtualUser& User, int32 UserIndex)
+{
+	AActor* DraggedBefore = User.Pawn->GetDraggedActor();
+
+	const double Start = FPlatformTime::Seconds();
+	User.Pawn->SimulateClick();
+	const double Seconds = FPlatformTime::Seconds() - Start;
+
+	Stats.Clicks++;
+	Stats.ClickSeconds += Seconds;
+	Stats.MaxClickSeconds = FMath::Max(Stats.MaxClickSeconds, Seconds);
+
+	AActor* DraggedAfter = User.Pawn->GetDraggedActor();
+
+	// 0 nothing happened, 1 picked up, 2 attached, 3 dropped
+	uint32 Outcome = 0;
+	if (!DraggedBefore && DraggedAfter)
+	{
+		Stats.PickUps++;
+		Outcome = 1;
+	}
+	else if (DraggedBefore && !DraggedAfter)
+	{
+		const AAttachablePart* Part = Cast<AAttachablePart>(DraggedBefore);
+		if (Part && Part->IsAttached())
+		{
+			Stats.Attaches++;
+			Outcome = 2;
+		}
+		else
+		{
+			Stats.Drops++;
+			Outcome = 3;
+		}
+	}
+
+	Stats.Checksum = HashCombine(Stats.Checksum, HashCombine(GetTypeHash(UserIndex), HashCombine(GetTypeHash(Stats.Frames), Outcome)));
+}
+
+void URobotLoadDriver::PickGoal(FVirtualUser& User) const
+{
+	// Holding something: head for a socket to attach it, otherwise for a part to grab
+	if (User.Pawn->GetDraggedActor() && Sockets.Num() > 0)
+	{
+		const UAttachmentPoint* Socket = Sockets[User.Random.RandHelper(Sockets.Num())];
+		if (IsValid(Socket))
+		{
+			User.Goal = Socket->GetComponentLocation();
+			return;
+		}
+	}
+
+	const AAttachablePart* Part = Parts[User.Random.RandHelper(Parts.Num())];
+	User.Goal = IsValid(Part) ? Part->GetActorLocation() : User.Cursor;
+}
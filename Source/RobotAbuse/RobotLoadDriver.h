@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RobotLoadDriver.generated.h"
+
+class AAttachablePart;
+class ARobotSpectatorPawn;
+class UAttachmentPoint;
+
+/** How the virtual users behave. The same seed on the same scene replays the same session */
+struct FRobotLoadParams
+{
+	int32 NumUsers = 1;
+
+	/** Clicks per second per user, each click picks up, attaches or drops */
+	float ClicksPerSecond = 2.0f;
+
+	/** How fast a user's cursor travels over the ground, in units per second */
+	float CursorSpeed = 3000.0f;
+
+	/** Height of the synthetic camera above the cursor point, the ray points straight down */
+	float CursorHeight = 1000.0f;
+
+	int32 Seed = 0;
+};
+
+/** Counters and timings since Start. Latencies are wall-clock time spent inside the pawn */
+struct FRobotLoadStats
+{
+	int64 Frames = 0;
+	int64 Steps = 0;
+	int64 Clicks = 0;
+	int64 PickUps = 0;
+	int64 Attaches = 0;
+	int64 Drops = 0;
+
+	double SimulatedSeconds = 0.0;
+	double StepSeconds = 0.0;
+	double MaxStepSeconds = 0.0;
+	double ClickSeconds = 0.0;
+	double MaxClickSeconds = 0.0;
+
+	/** Hash of every click outcome, equal between two runs when the session replayed exactly */
+	uint32 Checksum = 0;
+
+	double GetAverageStepUs() const { return Steps > 0 ? StepSeconds * 1.0e6 / Steps : 0.0; }
+	double GetAverageClickUs() const { return Clicks > 0 ? ClickSeconds * 1.0e6 / Clicks : 0.0; }
+};
+
+/**
+ * Headless load driver: spawns virtual users as uncontrolled ARobotSpectatorPawns and feeds them
+ * synthetic cursor rays and clicks, so interaction can be load tested without a mouse, a viewport or
+ * rendering. Every user moves its cursor between random parts and sockets from its own seeded stream
+ * and clicks at the configured rate. The driver ticks the pawns itself to time them.
+ * Start from the console with robot.LoadTest.Start [Users] [ClicksPerSecond] [Seed].
+ */
+UCLASS()
+class ROBOTABUSE_API URobotLoadDriver : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return bRunning; }
+	virtual TStatId GetStatId() const override;
+
+	/** Spawn the virtual users and start driving them. Restarts if already running */
+	void Start(const FRobotLoadParams& InParams);
+
+	/** Destroy the virtual users, the stats stay readable until the next Start */
+	void Stop();
+
+	bool IsRunning() const { return bRunning; }
+	const FRobotLoadStats& GetStats() const { return Stats; }
+	void LogStats() const;
+
+private:
+	struct FVirtualUser
+	{
+		ARobotSpectatorPawn* Pawn = nullptr;
+		FRandomStream Random;
+		FVector Cursor = FVector::ZeroVector;
+		FVector Goal = FVector::ZeroVector;
+		float NextClickTime = 0.0f;
+	};
+
+	void StepUser(FVirtualUser& User, int32 UserIndex, float DeltaTime);
+	void ClickUser(FVirtualUser& User, int32 UserIndex);
+	void PickGoal(FVirtualUser& User) const;
+
+	FRobotLoadParams Params;
+	FRobotLoadStats Stats;
+	TArray<FVirtualUser> Users;
+	bool bRunning = false;
+
+	// Everything a user can aim at, gathered once at Start
+	UPROPERTY()
+	TArray<AAttachablePart*> Parts;
+
+	UPROPERTY()
+	TArray<UAttachmentPoint*> Sockets;
+
+	// Keeps the virtual users alive, Users only mirrors these
+	UPROPERTY()
+	TArray<ARobotSpectatorPawn*> Pawns;
+};
@@ -0,0 +1,285 @@
+#include "RobotMassProcessors.h"
+#include "RobotMassSubsystem.h"
+#include "RobotMassTypes.h"
+#include "AttachmentPoint.h"
+#include "MassExecutionContext.h"
+#include "Engine/World.h"
+
+// ===== Compatibility =====
+
+URobotPartCompatibilityProcessor::URobotPartCompatibilityProcessor()
+	: EntityQuery(*this)
+	, SocketQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+}
+
+void URobotPartCompatibilityProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FRobotPartFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FRobotPartRequestFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FRobotPartRequestTag>(EMassFragmentPresence::All);
+
+	SocketQuery.AddRequirement<FRobotSocketFragment>(EMassFragmentAccess::ReadOnly);
+}
+
+void URobotPartCompatibilityProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	EntityQuery.ParallelForEachEntityChunk(Context, [&EntityManager](FMassExecutionContext& Context)
+	{
+		const TConstArrayView<FRobotPartFragment> Parts = Context.GetFragmentView<FRobotPartFragment>();
+		const TArrayView<FRobotPartRequestFragment> Requests = Context.GetMutableFragmentView<FRobotPartRequestFragment>();
+
+		for (int32 i = 0; i < Context.GetNumEntities(); i++)
+		{
+			FRobotPartRequestFragment& Request = Requests[i];
+			if (Request.Request != ERobotPartRequest::Attach)
+			{
+				continue;
+			}
+
+			// Sockets are only read here, nothing writes them until the state pass
+			const FRobotSocketFragment* Socket = EntityManager.IsEntityValid(Request.TargetSocket)
+				? EntityManager.GetFragmentDataPtr<FRobotSocketFragment>(Request.TargetSocket)
+				: nullptr;
+
+			Request.bCompatible = Socket
+				&& !Socket->Part.IsSet()
+				&& RobotPartCategories::AreCompatible(Socket->AcceptedMask, Parts[i].CategoryMask);
+		}
+	});
+}
+
+// ===== State Transitions =====
+
+URobotPartStateProcessor::URobotPartStateProcessor()
+	: EntityQuery(*this)
+	, SocketQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+	ExecutionOrder.ExecuteAfter.Add(URobotPartCompatibilityProcessor::StaticClass()->GetFName());
+}
+
+void URobotPartStateProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FRobotPartFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FRobotPartRequestFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FRobotPartRequestTag>(EMassFragmentPresence::All);
+
+	SocketQuery.AddRequirement<FRobotSocketFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void URobotPartStateProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	auto ReleaseSocket = [&EntityManager](FRobotPartFragment& Part)
+	{
+		if (Part.Socket.IsSet() && EntityManager.IsEntityValid(Part.Socket))
+		{
+			EntityManager.GetFragmentDataChecked<FRobotSocketFragment>(Part.Socket).Part.Reset();
+		}
+		Part.Socket.Reset();
+	};
+
+	EntityQuery.ForEachEntityChunk(Context, [&EntityManager, &ReleaseSocket](FMassExecutionContext& Context)
+	{
+		const TArrayView<FRobotPartFragment> Parts = Context.GetMutableFragmentView<FRobotPartFragment>();
+		const TArrayView<FRobotPartRequestFragment> Requests = Context.GetMutableFragmentView<FRobotPartRequestFragment>();
+		const bool bChunkHasActors = Context.DoesArchetypeHaveTag<FRobotPartProxyTag>();
+
+		for (int32 i = 0; i < Context.GetNumEntities(); i++)
+		{
+			FRobotPartFragment& Part = Parts[i];
+			FRobotPartRequestFragment& Request = Requests[i];
+			const FMassEntityHandle Entity = Context.GetEntity(i);
+
+			Context.Defer().RemoveTag<FRobotPartRequestTag>(Entity);
+			if (Request.Request == ERobotPartRequest::None)
+			{
+				continue;
+			}
+
+			const EPartState OldState = Part.State;
+			const FMassEntityHandle OldSocket = Part.Socket;
+
+			switch (Request.Request)
+			{
+			case ERobotPartRequest::Attach:
+			{
+				// A stale or unset socket handle is rejected like an incompatible socket. Two parts may have
+				// passed the parallel check for the same socket, first one wins
+				FRobotSocketFragment* Socket = Request.bCompatible && EntityManager.IsEntityValid(Request.TargetSocket)
+					? EntityManager.GetFragmentDataPtr<FRobotSocketFragment>(Request.TargetSocket)
+					: nullptr;
+				if (Socket && !Socket->Part.IsSet())
+				{
+					ReleaseSocket(Part);
+					Socket->Part = Entity;
+					Part.Socket = Request.TargetSocket;
+					Part.State = EPartState::ATTACHED;
+				}
+				break;
+			}
+			case ERobotPartRequest::Detach:
+				ReleaseSocket(Part);
+				Part.State = EPartState::DETACHED;
+				break;
+			case ERobotPartRequest::PickUp:
+				ReleaseSocket(Part);
+				Part.State = EPartState::HELD;
+				break;
+			case ERobotPartRequest::Drop:
+				ReleaseSocket(Part);
+				Part.State = EPartState::DETACHED;
+				break;
+			default:
+				break;
+			}
+
+			Request = FRobotPartRequestFragment();
+
+			// Parts without an actor have nothing to catch up, a new actor starts from the current state.
+			// A flag rather than a tag: deferred commands only land after the visual sync has run
+			if ((Part.State != OldState || Part.Socket != OldSocket) && bChunkHasActors)
+			{
+				Part.bVisualDirty = true;
+			}
+		}
+	});
+}
+
+// ===== Range =====
+
+URobotPartRangeProcessor::URobotPartRangeProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+	ExecutionOrder.ExecuteAfter.Add(URobotPartStateProcessor::StaticClass()->GetFName());
+}
+
+void URobotPartRangeProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FRobotLocationFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddTagRequirement<FRobotPartProxyTag>(EMassFragmentPresence::None);
+
+	// Sockets have a location too, only parts get actors
+	EntityQuery.AddRequirement<FRobotPartFragment>(EMassFragmentAccess::ReadOnly);
+}
+
+void URobotPartRangeProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	const URobotMassSubsystem* Subsystem = UWorld::GetSubsystem<URobotMassSubsystem>(EntityManager.GetWorld());
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	const FVector ViewerLocation = Subsystem->GetViewerLocation();
+	const float ActorRadiusSq = FMath::Square(Subsystem->ActorRadius);
+
+	EntityQuery.ParallelForEachEntityChunk(Context, [ViewerLocation, ActorRadiusSq](FMassExecutionContext& Context)
+	{
+		const TConstArrayView<FRobotLocationFragment> Locations = Context.GetFragmentView<FRobotLocationFragment>();
+
+		for (int32 i = 0; i < Context.GetNumEntities(); i++)
+		{
+			if (FVector::DistSquared(Locations[i].Location, ViewerLocation) <= ActorRadiusSq)
+			{
+				Context.Defer().AddTag<FRobotPartProxyTag>(Context.GetEntity(i));
+			}
+		}
+	});
+}
+
+// ===== Visual Sync =====
+
+URobotPartVisualSyncProcessor::URobotPartVisualSyncProcessor()
+	: EntityQuery(*this)
+	, SocketQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	bRequiresGameThreadExecution = true;
+	ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+	ExecutionOrder.ExecuteAfter.Add(URobotPartRangeProcessor::StaticClass()->GetFName());
+}
+
+void URobotPartVisualSyncProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FRobotPartFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FRobotLocationFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FRobotPartActorFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FRobotPartProxyTag>(EMassFragmentPresence::All);
+
+	// Player changes taken back from the actors relink sockets
+	SocketQuery.AddRequirement<FRobotSocketFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void URobotPartVisualSyncProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	URobotMassSubsystem* Subsystem = UWorld::GetSubsystem<URobotMassSubsystem>(EntityManager.GetWorld());
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	const FVector ViewerLocation = Subsystem->GetViewerLocation();
+	const float ActorRadiusSq = FMath::Square(Subsystem->ActorRadius);
+
+	EntityQuery.ForEachEntityChunk(Context, [&EntityManager, Subsystem, ViewerLocation, ActorRadiusSq](FMassExecutionContext& Context)
+	{
+		const TArrayView<FRobotPartFragment> Parts = Context.GetMutableFragmentView<FRobotPartFragment>();
+		const TArrayView<FRobotLocationFragment> Locations = Context.GetMutableFragmentView<FRobotLocationFragment>();
+		const TArrayView<FRobotPartActorFragment> Actors = Context.GetMutableFragmentView<FRobotPartActorFragment>();
+
+		for (int32 i = 0; i < Context.GetNumEntities(); i++)
+		{
+			FRobotPartFragment& Part = Parts[i];
+			FRobotLocationFragment& Location = Locations[i];
+			AAttachablePart* Actor = Actors[i].Actor.Get();
+			const FMassEntityHandle Entity = Context.GetEntity(i);
+
+			const bool bInRange = FVector::DistSquared(Location.Location, ViewerLocation) <= ActorRadiusSq;
+
+			if (!Actor)
+			{
+				Actor = bInRange ? Subsystem->SpawnPartActor(Part, Location.Location) : nullptr;
+				Actors[i].Actor = Actor;
+				Part.bVisualDirty = false;
+				if (!Actor)
+				{
+					// Left the radius before it got one, or the spawn failed
+					Context.Defer().RemoveTag<FRobotPartProxyTag>(Entity);
+				}
+				continue;
+			}
+
+			bool bActorChanged = false;
+			if (Part.bVisualDirty)
+			{
+				// The simulation moved first, bring the actor in line
+				Subsystem->ApplyStateToActor(Part, *Actor);
+				Part.bVisualDirty = false;
+			}
+			else
+			{
+				// Otherwise only take over what the player changed on the actor
+				bActorChanged = Subsystem->ApplyActorToState(*Actor, Entity, Part);
+			}
+
+			if (bActorChanged || Actor->IsHeld() || Actor->IsFalling())
+			{
+				Location.Location = Actor->GetActorLocation();
+			}
+
+			// Held parts keep their actor no matter where they are dragged
+			if (!bInRange && Part.State != EPartState::HELD)
+			{
+				Subsystem->ReleasePartActor(*Actor);
+				Actors[i].Actor.Reset();
+				Context.Defer().RemoveTag<FRobotPartProxyTag>(Entity);
+			}
+		}
+	});
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "RobotMassProcessors.generated.h"
+
+/**
+ * Checks every pending attach request against its target socket. Read-only on the sockets, so it
+ * runs chunks in parallel. Claiming the socket is left to URobotPartStateProcessor.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotPartCompatibilityProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	URobotPartCompatibilityProcessor();
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+
+	// Never iterated, declares the read of the target sockets so the state pass cannot overlap it
+	FMassEntityQuery SocketQuery;
+};
+
+/**
+ * Applies pending requests: claims and releases sockets and moves parts between EPartState values.
+ * Writes to socket entities, so chunks are processed serially. Changed parts that have an actor get
+ * the visual dirty tag.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotPartStateProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	URobotPartStateProcessor();
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+	FMassEntityQuery SocketQuery;
+};
+
+/**
+ * Finds parts without an actor that came within the subsystem's actor radius of the viewer and tags
+ * them for the visual sync. Read-only on the parts, so it runs chunks in parallel off the game thread.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotPartRangeProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	URobotPartRangeProcessor();
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ * Keeps actors only where they are needed, visiting only parts tagged as proxies. Tagged parts get an
+ * AAttachablePart, idle ones that drift out of range lose it and the tag. Dirty parts push their new
+ * state to the actor; otherwise changes the player made on the actor are taken back into the part
+ * and its socket link. Runs on the game thread.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotPartVisualSyncProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	URobotPartVisualSyncProcessor();
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+	FMassEntityQuery SocketQuery;
+};
@@ -0,0 +1,331 @@
+#include "RobotMassSubsystem.h"
+#include "RobotMassProcessors.h"
+#include "RobotMassTypes.h"
+#include "AttachmentJournal.h"
+#include "AttachmentPoint.h"
+#include "RobotPartPool.h"
+#include "MassEntitySubsystem.h"
+#include "MassEntityManager.h"
+#include "MassExecutor.h"
+#include "MassProcessingContext.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarRobotMassEnable(
+	TEXT("robot.Mass.Enable"),
+	false,
+	TEXT("Create the Mass entity backend for robot parts and sockets. Read when a world starts."));
+
+bool URobotMassSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return CVarRobotMassEnable.GetValueOnGameThread() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void URobotMassSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	UMassEntitySubsystem* EntitySubsystem = Collection.InitializeDependency<UMassEntitySubsystem>();
+	check(EntitySubsystem);
+	EntityManager = EntitySubsystem->GetMutableEntityManager().AsShared();
+
+	PartArchetype = EntityManager->CreateArchetype({
+		FRobotPartFragment::StaticStruct(),
+		FRobotPartRequestFragment::StaticStruct(),
+		FRobotLocationFragment::StaticStruct(),
+		FRobotPartActorFragment::StaticStruct() });
+
+	SocketArchetype = EntityManager->CreateArchetype({
+		FRobotSocketFragment::StaticStruct(),
+		FRobotLocationFragment::StaticStruct() });
+
+	// Order matters: check compatibility in parallel, apply serially, find the parts that need an actor
+	// in parallel, then sync only those on the game thread
+	Processors.Add(NewObject<URobotPartCompatibilityProcessor>(this));
+	Processors.Add(NewObject<URobotPartStateProcessor>(this));
+	Processors.Add(NewObject<URobotPartRangeProcessor>(this));
+	Processors.Add(NewObject<URobotPartVisualSyncProcessor>(this));
+
+	for (UMassProcessor* Processor : Processors)
+	{
+		Processor->CallInitialize(this, EntityManager.ToSharedRef());
+	}
+}
+
+void URobotMassSubsystem::Deinitialize()
+{
+	Processors.Empty();
+	PartClasses.Empty();
+	BoundSockets.Empty();
+	EntityManager.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId URobotMassSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URobotMassSubsystem, STATGROUP_Tickables);
+}
+
+void URobotMassSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!EntityManager.IsValid())
+	{
+		return;
+	}
+
+	UpdateViewerLocation();
+
+	FMassProcessingContext ProcessingContext(*EntityManager, DeltaTime);
+	UE::Mass::Executor::RunProcessorsView(Processors, ProcessingContext);
+}
+
+// ===== Entities =====
+
+void URobotMassSubsystem::CreateSockets(TConstArrayView<FVector> Locations, EArmType AcceptedArmType, TArray<FMassEntityHandle>& OutSockets)
+{
+	TArray<FMassEntityHandle> Created;
+	TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext =
+		EntityManager->BatchCreateEntities(SocketArchetype, Locations.Num(), Created);
+
+	const FPartCategoryMask AcceptedMask = RobotPartCategories::SocketMaskFromArmType(AcceptedArmType);
+	for (int32 i = 0; i < Created.Num(); i++)
+	{
+		EntityManager->GetFragmentDataChecked<FRobotSocketFragment>(Created[i]).AcceptedMask = AcceptedMask;
+		EntityManager->GetFragmentDataChecked<FRobotLocationFragment>(Created[i]).Location = Locations[i];
+	}
+
+	OutSockets.Append(Created);
+}
+
+void URobotMassSubsystem::CreateParts(TSubclassOf<AAttachablePart> PartClass, TConstArrayView<FVector> Locations, EArmType ArmType, TArray<FMassEntityHandle>& OutParts)
+{
+	int32 ClassIndex = PartClasses.Find(PartClass);
+	if (ClassIndex == INDEX_NONE)
+	{
+		ClassIndex = PartClasses.Add(PartClass);
+	}
+
+	// Spawned actors take the class defaults plus ArmType, so categories on the class win like they do on the actor
+	const AAttachablePart* Defaults = PartClass ? PartClass->GetDefaultObject<AAttachablePart>() : nullptr;
+	const FPartCategoryMask CategoryMask = Defaults && Defaults->Categories.Num() > 0
+		? Defaults->GetCategoryMask()
+		: RobotPartCategories::PartMaskFromArmType(ArmType);
+
+	TArray<FMassEntityHandle> Created;
+	TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext =
+		EntityManager->BatchCreateEntities(PartArchetype, Locations.Num(), Created);
+
+	for (int32 i = 0; i < Created.Num(); i++)
+	{
+		FRobotPartFragment& Part = EntityManager->GetFragmentDataChecked<FRobotPartFragment>(Created[i]);
+		Part.ArmType = ArmType;
+		Part.CategoryMask = CategoryMask;
+		Part.ClassIndex = ClassIndex;
+		EntityManager->GetFragmentDataChecked<FRobotLocationFragment>(Created[i]).Location = Locations[i];
+	}
+
+	OutParts.Append(Created);
+}
+
+void URobotMassSubsystem::BindSocket(FMassEntityHandle Socket, UAttachmentPoint* Point)
+{
+	if (EntityManager->IsEntityValid(Socket))
+	{
+		FRobotSocketFragment& Fragment = EntityManager->GetFragmentDataChecked<FRobotSocketFragment>(Socket);
+		if (const UAttachmentPoint* OldPoint = Fragment.Point.Get())
+		{
+			BoundSockets.Remove(OldPoint);
+		}
+
+		Fragment.Point = Point;
+		if (Point)
+		{
+			Fragment.AcceptedMask = Point->GetAcceptedMask();
+			BoundSockets.Add(Point, Socket);
+		}
+	}
+}
+
+void URobotMassSubsystem::RefreshSocketMask(const UAttachmentPoint* Point)
+{
+	const FMassEntityHandle* Socket = BoundSockets.Find(Point);
+	if (Socket && EntityManager->IsEntityValid(*Socket))
+	{
+		EntityManager->GetFragmentDataChecked<FRobotSocketFragment>(*Socket).AcceptedMask = Point->GetAcceptedMask();
+	}
+}
+
+// ===== Requests =====
+
+void URobotMassSubsystem::RequestAttach(FMassEntityHandle Part, FMassEntityHandle Socket)
+{
+	QueueRequest(Part, ERobotPartRequest::Attach, Socket);
+}
+
+void URobotMassSubsystem::RequestDetach(FMassEntityHandle Part)
+{
+	QueueRequest(Part, ERobotPartRequest::Detach);
+}
+
+void URobotMassSubsystem::RequestPickUp(FMassEntityHandle Part)
+{
+	QueueRequest(Part, ERobotPartRequest::PickUp);
+}
+
+void URobotMassSubsystem::RequestDrop(FMassEntityHandle Part)
+{
+	QueueRequest(Part, ERobotPartRequest::Drop);
+}
+
+void URobotMassSubsystem::QueueRequest(FMassEntityHandle Part, ERobotPartRequest Request, FMassEntityHandle Socket)
+{
+	if (!EntityManager.IsValid() || !EntityManager->IsEntityValid(Part))
+	{
+		return;
+	}
+
+	// Tag first, moving the entity to its tagged archetype invalidates fragment references
+	EntityManager->AddTagToEntity(Part, FRobotPartRequestTag::StaticStruct());
+
+	// Latest request per tick wins, the processors run before anyone can observe the earlier one
+	FRobotPartRequestFragment& Fragment = EntityManager->GetFragmentDataChecked<FRobotPartRequestFragment>(Part);
+	Fragment.Request = Request;
+	Fragment.TargetSocket = Socket;
+	Fragment.bCompatible = false;
+}
+
+EPartState URobotMassSubsystem::GetPartState(FMassEntityHandle Part) const
+{
+	if (!EntityManager.IsValid() || !EntityManager->IsEntityValid(Part))
+	{
+		return EPartState::DETACHED;
+	}
+	return EntityManager->GetFragmentDataChecked<FRobotPartFragment>(Part).State;
+}
+
+FMassEntityHandle URobotMassSubsystem::GetPartSocket(FMassEntityHandle Part) const
+{
+	if (!EntityManager.IsValid() || !EntityManager->IsEntityValid(Part))
+	{
+		return FMassEntityHandle();
+	}
+	return EntityManager->GetFragmentDataChecked<FRobotPartFragment>(Part).Socket;
+}
+
+// ===== Actor Bridge =====
+
+AAttachablePart* URobotMassSubsystem::SpawnPartActor(const FRobotPartFragment& Part, const FVector& Location)
+{
+	UWorld* World = GetWorld();
+	if (!World || !PartClasses.IsValidIndex(Part.ClassIndex) || !PartClasses[Part.ClassIndex])
+	{
+		return nullptr;
+	}
+
+	// Actors come and go as the viewer moves, the pool keeps that from spawning every time
+	URobotPartPool* Pool = UWorld::GetSubsystem<URobotPartPool>(World);
+	AAttachablePart* Actor = Pool ? Pool->Acquire(PartClasses[Part.ClassIndex], FTransform(Location)) : nullptr;
+
+	if (Actor)
+	{
+		Actor->ArmType = Part.ArmType;
+		ApplyStateToActor(Part, *Actor);
+		NumPartActors++;
+	}
+	return Actor;
+}
+
+void URobotMassSubsystem::ApplyStateToActor(const FRobotPartFragment& Part, AAttachablePart& Actor) const
+{
+	// The proxy only mirrors the simulation, the change was not made on the actor
+	FAttachmentJournalSuppressScope NoJournal(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()));
+
+	if (Part.State == EPartState::ATTACHED)
+	{
+		const FRobotSocketFragment* Socket = EntityManager->IsEntityValid(Part.Socket)
+			? EntityManager->GetFragmentDataPtr<FRobotSocketFragment>(Part.Socket)
+			: nullptr;
+		UAttachmentPoint* Point = Socket ? Socket->Point.Get() : nullptr;
+
+		// Without a real socket component the actor just stays where the entity is
+		if (Point && Actor.GetAttachmentPoint() != Point)
+		{
+			Actor.TryAttachTo_Implementation(Point);
+		}
+		return;
+	}
+
+	if (Actor.IsAttached())
+	{
+		Actor.DetachFromPoint();
+	}
+
+	if (Part.State == EPartState::HELD)
+	{
+		Actor.PickUp();
+	}
+	else if (Actor.IsHeld())
+	{
+		Actor.Drop();
+	}
+}
+
+bool URobotMassSubsystem::ApplyActorToState(const AAttachablePart& Actor, FMassEntityHandle Entity, FRobotPartFragment& Part)
+{
+	FRobotSocketFragment* OldSocket = EntityManager->IsEntityValid(Part.Socket)
+		? EntityManager->GetFragmentDataPtr<FRobotSocketFragment>(Part.Socket)
+		: nullptr;
+
+	const UAttachmentPoint* Point = Actor.GetAttachmentPoint();
+	const UAttachmentPoint* OldPoint = OldSocket ? OldSocket->Point.Get() : nullptr;
+	if (Actor.CurrentState == Part.State && Point == OldPoint)
+	{
+		return false;
+	}
+
+	if (OldSocket && OldSocket->Part == Entity)
+	{
+		OldSocket->Part.Reset();
+	}
+	Part.Socket.Reset();
+
+	// A socket without an entity is outside the simulation, the part just counts as attached
+	if (const FMassEntityHandle* NewSocket = Point ? BoundSockets.Find(Point) : nullptr)
+	{
+		if (FRobotSocketFragment* Socket = EntityManager->GetFragmentDataPtr<FRobotSocketFragment>(*NewSocket))
+		{
+			Socket->Part = Entity;
+			Part.Socket = *NewSocket;
+		}
+	}
+
+	Part.State = Actor.CurrentState;
+	return true;
+}
+
+void URobotMassSubsystem::ReleasePartActor(AAttachablePart& Actor)
+{
+	NumPartActors--;
+
+	if (URobotPartPool* Pool = UWorld::GetSubsystem<URobotPartPool>(GetWorld()))
+	{
+		Pool->Release(&Actor);
+	}
+	else
+	{
+		Actor.Destroy();
+	}
+}
+
+void URobotMassSubsystem::UpdateViewerLocation()
+{
+	if (const APlayerController* PC = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr)
+	{
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewerLocation, ViewRotation);
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "MassArchetypeTypes.h"
+#include "AttachablePart.h"
+#include "RobotMassTypes.h"
+#include "RobotMassSubsystem.generated.h"
+
+class UMassProcessor;
+
+/**
+ * Optional data-oriented backend for large fleets (robot.Mass.Enable, read at world start).
+ * Parts and sockets live as Mass entities; attach/detach/pickup/drop are queued as requests and
+ * resolved once per tick by the processors in RobotMassProcessors.h. Actors only exist for parts
+ * near the viewer or being held, so the per-tick cost stays flat with fleet size.
+ */
+UCLASS()
+class ROBOTABUSE_API URobotMassSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// ===== Entities =====
+
+	void CreateSockets(TConstArrayView<FVector> Locations, EArmType AcceptedArmType, TArray<FMassEntityHandle>& OutSockets);
+	void CreateParts(TSubclassOf<AAttachablePart> PartClass, TConstArrayView<FVector> Locations, EArmType ArmType, TArray<FMassEntityHandle>& OutParts);
+
+	/** Bind a socket entity to the real component when its robot exists as an actor */
+	void BindSocket(FMassEntityHandle Socket, UAttachmentPoint* Point);
+
+	/** Copy a bound socket's accepted mask again after it changed */
+	void RefreshSocketMask(const UAttachmentPoint* Point);
+
+	// ===== Requests, resolved on the next tick =====
+
+	void RequestAttach(FMassEntityHandle Part, FMassEntityHandle Socket);
+	void RequestDetach(FMassEntityHandle Part);
+	void RequestPickUp(FMassEntityHandle Part);
+	void RequestDrop(FMassEntityHandle Part);
+
+	EPartState GetPartState(FMassEntityHandle Part) const;
+	FMassEntityHandle GetPartSocket(FMassEntityHandle Part) const;
+
+	// ===== Actor Bridge, used by the visual sync processor =====
+
+	FVector GetViewerLocation() const { return ViewerLocation; }
+	AAttachablePart* SpawnPartActor(const FRobotPartFragment& Part, const FVector& Location);
+	void ApplyStateToActor(const FRobotPartFragment& Part, AAttachablePart& Actor) const;
+	void ReleasePartActor(AAttachablePart& Actor);
+
+	/** Take over a change the player made on the actor, socket link included. Returns false if there was none */
+	bool ApplyActorToState(const AAttachablePart& Actor, FMassEntityHandle Entity, FRobotPartFragment& Part);
+
+	int32 GetNumPartActors() const { return NumPartActors; }
+
+	/** Parts closer than this to the viewer are backed by an actor */
+	UPROPERTY(EditAnywhere, Category = "Mass")
+	float ActorRadius = 5000.0f;
+
+private:
+	void QueueRequest(FMassEntityHandle Part, ERobotPartRequest Request, FMassEntityHandle Socket = FMassEntityHandle());
+	void UpdateViewerLocation();
+
+	UPROPERTY()
+	TArray<UMassProcessor*> Processors;
+
+	UPROPERTY()
+	TArray<TSubclassOf<AAttachablePart>> PartClasses;
+
+	TSharedPtr<FMassEntityManager> EntityManager;
+
+	FMassArchetypeHandle PartArchetype;
+	FMassArchetypeHandle SocketArchetype;
+
+	FVector ViewerLocation = FVector::ZeroVector;
+
+	// Socket entity of each bound socket component, for changes that come from the actor side
+	TMap<TObjectKey<UAttachmentPoint>, FMassEntityHandle> BoundSockets;
+
+	int32 NumPartActors = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "AttachablePart.h"
+#include "RobotMassTypes.generated.h"
+
+class UAttachmentPoint;
+
+/** What the simulation has been asked to do with a part this tick */
+UENUM()
+enum class ERobotPartRequest : uint8
+{
+	None,
+	Attach,
+	Detach,
+	PickUp,
+	Drop
+};
+
+/** State of one robot part. Mass stores each fragment type in its own column, so this is already SoA */
+USTRUCT()
+struct ROBOTABUSE_API FRobotPartFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	EPartState State = EPartState::DETACHED;
+	EArmType ArmType = EArmType::Universal;
+
+	// Same mask the actor's GetCategoryMask returns, checked with RobotPartCategories::AreCompatible
+	FPartCategoryMask CategoryMask = 0;
+
+	// Socket entity the part sits in, unset while detached or held
+	FMassEntityHandle Socket;
+
+	// Index into URobotMassSubsystem's part class table, used when an actor has to be spawned
+	int32 ClassIndex = INDEX_NONE;
+
+	// Set by the state pass when a part with an actor changed, the visual sync in the same tick catches the actor up
+	bool bVisualDirty = false;
+};
+
+/** Pending transition, consumed by the compatibility and state processors */
+USTRUCT()
+struct ROBOTABUSE_API FRobotPartRequestFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	ERobotPartRequest Request = ERobotPartRequest::None;
+	FMassEntityHandle TargetSocket;
+
+	// Filled in by the compatibility pass
+	bool bCompatible = false;
+};
+
+/** World placement of a part or socket */
+USTRUCT()
+struct ROBOTABUSE_API FRobotLocationFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+};
+
+/** Actor currently standing in for the entity, if any */
+USTRUCT()
+struct ROBOTABUSE_API FRobotPartActorFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	TWeakObjectPtr<AAttachablePart> Actor;
+};
+
+/** One socket on a robot */
+USTRUCT()
+struct ROBOTABUSE_API FRobotSocketFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FPartCategoryMask AcceptedMask = RobotPartCategories::Left | RobotPartCategories::Right | RobotPartCategories::Arm;
+	FMassEntityHandle Part;
+
+	// Real socket component when the robot exists as an actor
+	TWeakObjectPtr<UAttachmentPoint> Point;
+};
+
+/** Part with a pending request, so the request passes only visit those */
+USTRUCT()
+struct ROBOTABUSE_API FRobotPartRequestTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/** Part that has, or is about to get, an actor. Only these are visited on the game thread */
+USTRUCT()
+struct ROBOTABUSE_API FRobotPartProxyTag : public FMassTag
+{
+	GENERATED_BODY()
+};
@@ -0,0 +1,147 @@
+#include "RobotPartPool.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "RobotAssetPreloader.h"
+#include "Engine/World.h"
+
+void URobotPartPool::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TArray<FSoftObjectPath> ToLoad;
+	for (const FRobotPartPoolPrewarm& Entry : PrewarmCounts)
+	{
+		if (!Entry.PartClass.IsNull() && Entry.Count > 0)
+		{
+			ToLoad.Add(Entry.PartClass.ToSoftObjectPath());
+		}
+	}
+
+	if (ToLoad.Num() > 0)
+	{
+		PrewarmLoadHandle = RobotAssets::LoadAsync(MoveTemp(ToLoad), FStreamableDelegate::CreateUObject(this, &URobotPartPool::PrewarmConfigured), TEXT("RobotPartPool"));
+	}
+}
+
+void URobotPartPool::PrewarmConfigured()
+{
+	for (const FRobotPartPoolPrewarm& Entry : PrewarmCounts)
+	{
+		if (UClass* PartClass = Entry.PartClass.Get())
+		{
+			Prewarm(PartClass, Entry.Count);
+		}
+	}
+}
+
+void URobotPartPool::Deinitialize()
+{
+	if (PrewarmLoadHandle.IsValid())
+	{
+		PrewarmLoadHandle->CancelHandle();
+		PrewarmLoadHandle.Reset();
+	}
+
+	// The parked actors go away with the world
+	for (const TPair<UClass*, FRobotPartPoolBucket>& Bucket : Buckets)
+	{
+		DEC_DWORD_STAT_BY(STAT_RobotPooledParts, Bucket.Value.Parts.Num());
+	}
+	Buckets.Empty();
+
+	Super::Deinitialize();
+}
+
+AAttachablePart* URobotPartPool::Acquire(TSubclassOf<AAttachablePart> PartClass, const FTransform& Transform)
+{
+	UClass* Class = PartClass ? PartClass.Get() : AAttachablePart::StaticClass();
+
+	if (FRobotPartPoolBucket* Bucket = Buckets.Find(Class))
+	{
+		while (Bucket->Parts.Num() > 0)
+		{
+			AAttachablePart* Part = Bucket->Parts.Pop(EAllowShrinking::No);
+			DEC_DWORD_STAT(STAT_RobotPooledParts);
+
+			// Something else may have destroyed a parked part, e.g. a level unload
+			if (IsValid(Part))
+			{
+				Part->ReactivateFromPool(Transform);
+				return Part;
+			}
+		}
+	}
+
+	INC_DWORD_STAT(STAT_RobotPoolMisses);
+	return SpawnPart(Class, Transform);
+}
+
+void URobotPartPool::Release(AAttachablePart* Part)
+{
+	if (!IsValid(Part) || Part->IsPooled())
+	{
+		return;
+	}
+
+	// Arms made by a UChildActorComponent belong to it, it destroys or re-creates them whenever it likes
+	if (Part->IsChildActor())
+	{
+		return;
+	}
+
+	FRobotPartPoolBucket& Bucket = Buckets.FindOrAdd(Part->GetClass());
+	if (Bucket.Parts.Num() >= MaxFreePerClass)
+	{
+		Part->Destroy();
+		return;
+	}
+
+	Part->DeactivateForPool();
+	Bucket.Parts.Add(Part);
+	INC_DWORD_STAT(STAT_RobotPooledParts);
+}
+
+void URobotPartPool::Prewarm(TSubclassOf<AAttachablePart> PartClass, int32 Count)
+{
+	UClass* Class = PartClass ? PartClass.Get() : AAttachablePart::StaticClass();
+	FRobotPartPoolBucket& Bucket = Buckets.FindOrAdd(Class);
+
+	const int32 NumToSpawn = FMath::Min(Count, MaxFreePerClass) - Bucket.Parts.Num();
+	if (NumToSpawn <= 0)
+	{
+		return;
+	}
+
+	Bucket.Parts.Reserve(Bucket.Parts.Num() + NumToSpawn);
+
+	for (int32 i = 0; i < NumToSpawn; i++)
+	{
+		if (AAttachablePart* Part = SpawnPart(Class, FTransform::Identity))
+		{
+			Part->DeactivateForPool();
+			Bucket.Parts.Add(Part);
+			INC_DWORD_STAT(STAT_RobotPooledParts);
+		}
+	}
+
+	UE_LOG(LogRobotAbuse, Verbose, TEXT("Prewarmed %d %s"), NumToSpawn, *Class->GetName());
+}
+
+int32 URobotPartPool::GetNumFree(TSubclassOf<AAttachablePart> PartClass) const
+{
+	const FRobotPartPoolBucket* Bucket = Buckets.Find(PartClass ? PartClass.Get() : AAttachablePart::StaticClass());
+	return Bucket ? Bucket->Parts.Num() : 0;
+}
+
+AAttachablePart* URobotPartPool::SpawnPart(UClass* PartClass, const FTransform& Transform) const
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return World->SpawnActor<AAttachablePart>(PartClass, Transform, SpawnParams);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RobotPartPool.generated.h"
+
+class AAttachablePart;
+struct FStreamableHandle;
+
+/** How many parts of one class to park when the world begins play */
+USTRUCT()
+struct FRobotPartPoolPrewarm
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	TSoftClassPtr<AAttachablePart> PartClass;
+
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	int32 Count = 0;
+};
+
+USTRUCT()
+struct FRobotPartPoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AAttachablePart*> Parts;
+};
+
+/**
+ * Per-class free lists of deactivated AAttachablePart actors. Released parts are hidden, lose
+ * collision and leave the registry instead of being destroyed, so replacing arms in steady state
+ * spawns nothing and leaves nothing for the garbage collector.
+ * Prewarm sizes come from [/Script/RobotAbuse.RobotPartPool] in DefaultGame.ini, the classes are
+ * streamed in after begin play and prewarmed once they arrive.
+ */
+UCLASS(Config = Game)
+class ROBOTABUSE_API URobotPartPool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** A ready part of PartClass at Transform, reused if one is parked, spawned otherwise */
+	AAttachablePart* Acquire(TSubclassOf<AAttachablePart> PartClass, const FTransform& Transform);
+
+	/** Detach and park a part. Parts over MaxFreePerClass are destroyed instead */
+	void Release(AAttachablePart* Part);
+
+	/** Spawn and park parts until Count of PartClass are free */
+	void Prewarm(TSubclassOf<AAttachablePart> PartClass, int32 Count);
+
+	int32 GetNumFree(TSubclassOf<AAttachablePart> PartClass) const;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Pool")
+	TArray<FRobotPartPoolPrewarm> PrewarmCounts;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Pool")
+	int32 MaxFreePerClass = 256;
+
+private:
+	void PrewarmConfigured();
+	AAttachablePart* SpawnPart(UClass* PartClass, const FTransform& Transform) const;
+
+	TSharedPtr<FStreamableHandle> PrewarmLoadHandle;
+
+	UPROPERTY()
+	TMap<UClass*, FRobotPartPoolBucket> Buckets;
+};
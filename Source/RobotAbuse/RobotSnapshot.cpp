@@ -0,0 +1,333 @@
+#include "RobotSnapshot.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "AttachmentTransaction.h"
+#include "RobotSpectatorPawn.h"
+#include "Async/MappedFileHandle.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "Snapshots are written and mapped as little-endian");
+
+static FAutoConsoleCommandWithWorldAndArgs CmdRobotSnapshotSave(
+	TEXT("robot.Snapshot.Save"),
+	TEXT("Save every part's socket and state to Saved/Snapshots. Args: [Name=Default]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const FString Path = RobotSnapshot::GetDefaultPath(Args.IsValidIndex(0) ? Args[0] : TEXT("Default"));
+		if (RobotSnapshot::SaveToFile(World, Path))
+		{
+			UE_LOG(LogRobotAbuse, Log, TEXT("Snapshot saved to %s"), *Path);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs CmdRobotSnapshotLoad(
+	TEXT("robot.Snapshot.Load"),
+	TEXT("Restore a snapshot from Saved/Snapshots. Args: [Name=Default]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const FString Path = RobotSnapshot::GetDefaultPath(Args.IsValidIndex(0) ? Args[0] : TEXT("Default"));
+		const double Start = FPlatformTime::Seconds();
+		const int32 NumChanged = RobotSnapshot::RestoreFromFile(World, Path);
+		if (NumChanged != INDEX_NONE)
+		{
+			UE_LOG(LogRobotAbuse, Log, TEXT("Snapshot %s restored, %d parts changed in %.2f ms"),
+				*Path, NumChanged, (FPlatformTime::Seconds() - Start) * 1000.0);
+		}
+	}));
+
+namespace RobotSnapshot
+{
+	static constexpr uint32 SectionAlignment = 8;
+
+	/** Loose parts closer than this to their saved location are left where they are */
+	static constexpr float LocationTolerance = 0.1f;
+
+	/** Header of Bytes if it is a complete snapshot of a version this build reads, nullptr otherwise */
+	static const FRobotSnapshotHeader* ValidateSnapshot(TConstArrayView<uint8> Bytes)
+	{
+		if (Bytes.Num() < (int32)sizeof(FRobotSnapshotHeader))
+		{
+			return nullptr;
+		}
+
+		const FRobotSnapshotHeader* Header = reinterpret_cast<const FRobotSnapshotHeader*>(Bytes.GetData());
+		if (Header->Magic != FRobotSnapshotHeader::ExpectedMagic || Header->Version != FRobotSnapshotHeader::CurrentVersion
+			|| Header->HeaderSize != sizeof(FRobotSnapshotHeader) || Header->TotalSize != (uint32)Bytes.Num())
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("Snapshot: unknown format or version"));
+			return nullptr;
+		}
+
+		const uint64 Size = Bytes.Num();
+		const bool bSectionsFit = Header->NameOffsetsOffset + uint64(Header->NumNames) * sizeof(uint32) <= Size
+			&& Header->NamesOffset + uint64(Header->NameBytes) <= Size
+			&& Header->PartsOffset + uint64(Header->NumParts) * sizeof(FRobotSnapshotPart) <= Size
+			&& Header->PartsOffset % alignof(FRobotSnapshotPart) == 0
+			&& Header->NameOffsetsOffset % alignof(uint32) == 0
+			&& (Header->NameBytes == 0 || Bytes[Header->NamesOffset + Header->NameBytes - 1] == 0);
+
+		if (!bSectionsFit || FCrc::MemCrc32(Bytes.GetData() + sizeof(FRobotSnapshotHeader), Size - sizeof(FRobotSnapshotHeader)) != Header->PayloadCrc)
+		{
+			UE_LOG(LogRobotAbuse, Warning, TEXT("Snapshot: corrupt data"));
+			return nullptr;
+		}
+
+		return Header;
+	}
+}
+
+bool RobotSnapshot::Save(UWorld* World, TArray<uint8>& OutBytes)
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::SnapshotSave");
+
+	if (!World)
+	{
+		return false;
+	}
+
+	TArray<FRobotSnapshotPart> Parts;
+	TArray<uint32> NameOffsets;
+	TArray<ANSICHAR> Names;
+	TMap<FName, uint32> NameIndices;
+
+	auto AddName = [&](FName Name) -> uint32
+	{
+		if (const uint32* Found = NameIndices.Find(Name))
+		{
+			return *Found;
+		}
+
+		const uint32 Index = NameOffsets.Add(Names.Num());
+		const FTCHARToUTF8 Utf8(*Name.ToString());
+		Names.Append(reinterpret_cast<const ANSICHAR*>(Utf8.Get()), Utf8.Length());
+		Names.Add('\0');
+		NameIndices.Add(Name, Index);
+		return Index;
+	};
+
+	for (TActorIterator<AAttachablePart> It(World); It; ++It)
+	{
+		AAttachablePart* Part = *It;
+		if (Part->IsPooled())
+		{
+			continue;
+		}
+
+		FRobotSnapshotPart& Record = Parts.AddDefaulted_GetRef();
+		Record.PartName = AddName(Part->GetFName());
+
+		const UAttachmentPoint* Point = Part->GetAttachmentPoint();
+		if (Point && Point->GetOwner())
+		{
+			Record.State = static_cast<uint8>(EPartState::ATTACHED);
+			Record.RobotName = AddName(Point->GetOwner()->GetFName());
+			Record.PointName = AddName(Point->GetFName());
+		}
+		else
+		{
+			Record.State = static_cast<uint8>(EPartState::DETACHED);
+			Record.Location = FVector3f(Part->GetActorLocation());
+		}
+	}
+
+	if (Parts.Num() == 0)
+	{
+		return false;
+	}
+
+	FRobotSnapshotHeader Header;
+	Header.NumNames = NameOffsets.Num();
+	Header.NameBytes = Names.Num();
+	Header.NumParts = Parts.Num();
+
+	uint32 Offset = Align(sizeof(FRobotSnapshotHeader), SectionAlignment);
+	Header.NameOffsetsOffset = Offset;
+	Offset = Align(Offset + NameOffsets.Num() * sizeof(uint32), SectionAlignment);
+	Header.NamesOffset = Offset;
+	Offset = Align(Offset + Names.Num(), SectionAlignment);
+	Header.PartsOffset = Offset;
+	Offset += Parts.Num() * sizeof(FRobotSnapshotPart);
+	Header.TotalSize = Offset;
+
+	OutBytes.Reset();
+	OutBytes.SetNumZeroed(Offset);
+	FMemory::Memcpy(OutBytes.GetData() + Header.NameOffsetsOffset, NameOffsets.GetData(), NameOffsets.Num() * sizeof(uint32));
+	FMemory::Memcpy(OutBytes.GetData() + Header.NamesOffset, Names.GetData(), Names.Num());
+	FMemory::Memcpy(OutBytes.GetData() + Header.PartsOffset, Parts.GetData(), Parts.Num() * sizeof(FRobotSnapshotPart));
+
+	Header.PayloadCrc = FCrc::MemCrc32(OutBytes.GetData() + sizeof(FRobotSnapshotHeader), Offset - sizeof(FRobotSnapshotHeader));
+	FMemory::Memcpy(OutBytes.GetData(), &Header, sizeof(FRobotSnapshotHeader));
+
+	return true;
+}
+
+int32 RobotSnapshot::Restore(UWorld* World, TConstArrayView<uint8> Bytes)
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::SnapshotRestore");
+
+	const FRobotSnapshotHeader* Header = ValidateSnapshot(Bytes);
+	if (!World || !Header)
+	{
+		return INDEX_NONE;
+	}
+
+	// Read in place, sections are aligned in the file
+	const uint8* Base = Bytes.GetData();
+	const uint32* NameOffsets = reinterpret_cast<const uint32*>(Base + Header->NameOffsetsOffset);
+	const ANSICHAR* NameBlob = reinterpret_cast<const ANSICHAR*>(Base + Header->NamesOffset);
+	TConstArrayView<FRobotSnapshotPart> Records(reinterpret_cast<const FRobotSnapshotPart*>(Base + Header->PartsOffset), Header->NumParts);
+
+	TArray<FName> Names;
+	Names.Reserve(Header->NumNames);
+	for (uint32 Index = 0; Index < Header->NumNames; Index++)
+	{
+		const uint32 NameOffset = NameOffsets[Index];
+		Names.Add(NameOffset < Header->NameBytes ? FName(UTF8_TO_TCHAR(NameBlob + NameOffset)) : NAME_None);
+	}
+
+	auto GetName = [&Names](uint32 Index) { return Names.IsValidIndex(Index) ? Names[Index] : NAME_None; };
+
+	// One pass over the world instead of a lookup per record
+	TMap<FName, AActor*> Actors;
+	TArray<ARobotSpectatorPawn*, TInlineAllocator<4>> Pawns;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		Actors.Add(It->GetFName(), *It);
+		if (ARobotSpectatorPawn* Pawn = Cast<ARobotSpectatorPawn>(*It))
+		{
+			Pawns.Add(Pawn);
+		}
+	}
+
+	struct FLoosePart
+	{
+		AAttachablePart* Part;
+		FVector Location;
+	};
+	TArray<FLoosePart> LooseParts;
+	TArray<TPair<AAttachablePart*, UAttachmentPoint*>> Attaches;
+	FAttachmentTransaction Transaction;
+	Transaction.Reserve(Records.Num() * 2);
+
+	int32 NumUnresolved = 0;
+	for (const FRobotSnapshotPart& Record : Records)
+	{
+		AAttachablePart* Part = Cast<AAttachablePart>(Actors.FindRef(GetName(Record.PartName)));
+		if (!Part || Part->IsPooled())
+		{
+			NumUnresolved++;
+			continue;
+		}
+
+		UAttachmentPoint* Target = nullptr;
+		if (Record.State == static_cast<uint8>(EPartState::ATTACHED))
+		{
+			Target = UAttachmentPoint::FindByName(Actors.FindRef(GetName(Record.RobotName)), GetName(Record.PointName));
+			if (!Target)
+			{
+				NumUnresolved++;
+				continue;
+			}
+		}
+
+		if (Target && Part->GetAttachmentPoint() == Target)
+		{
+			continue;
+		}
+
+		// A loose part already lying where it was saved is not touched
+		const FVector Location(Record.Location);
+		if (!Target && !Part->GetAttachmentPoint() && !Part->IsHeld()
+			&& FVector::DistSquared(Part->GetActorLocation(), Location) <= FMath::Square(LocationTolerance))
+		{
+			continue;
+		}
+
+		// Everything leaves its socket first, so parts trading places validate against the final occupancy
+		if (Part->GetAttachmentPoint())
+		{
+			Transaction.Detach(Part);
+		}
+
+		if (Target)
+		{
+			Attaches.Emplace(Part, Target);
+		}
+		else
+		{
+			LooseParts.Add({ Part, Location });
+		}
+	}
+
+	for (const TPair<AAttachablePart*, UAttachmentPoint*>& Attach : Attaches)
+	{
+		Transaction.Attach(Attach.Key, Attach.Value);
+	}
+
+	Transaction.Commit(World);
+
+	int32 NumChanged = LooseParts.Num();
+	for (const FAttachmentOp& Op : Transaction.GetOps())
+	{
+		NumChanged += Op.Type == EAttachmentOpType::Attach && Op.bApplied ? 1 : 0;
+	}
+
+	for (const FLoosePart& Loose : LooseParts)
+	{
+		// Saved where it was lying, so it is put back there rather than dropped again
+		Loose.Part->PlaceAt(Loose.Location);
+
+		// Whoever drags the part lets go of it, so no pawn is left holding a part that lies on the floor
+		for (ARobotSpectatorPawn* Pawn : Pawns)
+		{
+			Pawn->ReleasePart(Loose.Part);
+		}
+	}
+
+	if (NumUnresolved > 0)
+	{
+		UE_LOG(LogRobotAbuse, Warning, TEXT("Snapshot: %d of %d parts or sockets are not in this world"), NumUnresolved, Records.Num());
+	}
+
+	return NumChanged;
+}
+
+bool RobotSnapshot::SaveToFile(UWorld* World, const FString& Path)
+{
+	TArray<uint8> Bytes;
+	return Save(World, Bytes) && FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+int32 RobotSnapshot::RestoreFromFile(UWorld* World, const FString& Path)
+{
+	// Mapped files are read straight from the page cache, no copy
+	TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (Handle)
+	{
+		TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Handle->GetFileSize()));
+		if (Region)
+		{
+			return Restore(World, TConstArrayView<uint8>(Region->GetMappedPtr(), (int32)Region->GetMappedSize()));
+		}
+	}
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		UE_LOG(LogRobotAbuse, Warning, TEXT("Snapshot: cannot read %s"), *Path);
+		return INDEX_NONE;
+	}
+	return Restore(World, Bytes);
+}
+
+FString RobotSnapshot::GetDefaultPath(const FString& Name)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Snapshots") / (Name + TEXT(".robosnap"));
+}
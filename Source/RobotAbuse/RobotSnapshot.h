@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/**
+ * Binary snapshot of every part's socket and state, for saving and restoring a whole yard.
+ *
+ * Layout, little-endian, every section 8-byte aligned so a memory-mapped file is read in place:
+ *   FRobotSnapshotHeader
+ *   uint32 NameOffsets[NumNames]     byte offset of each name inside the string blob
+ *   char   Names[NameBytes]          null-terminated UTF-8 actor and socket names
+ *   FRobotSnapshotPart Parts[NumParts]
+ *
+ * Actors are referred to by name, sockets by their robot's name and component name, so a
+ * snapshot restores into any load of the same level or the same generated stress layout.
+ */
+struct FRobotSnapshotHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x50414E53; // "SNAP"
+	static constexpr uint16 CurrentVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+	uint16 Version = CurrentVersion;
+	uint16 HeaderSize = sizeof(FRobotSnapshotHeader);
+
+	uint32 NumNames = 0;
+	uint32 NameBytes = 0;
+	uint32 NumParts = 0;
+
+	uint32 NameOffsetsOffset = 0;
+	uint32 NamesOffset = 0;
+	uint32 PartsOffset = 0;
+
+	/** CRC of everything after the header */
+	uint32 PayloadCrc = 0;
+	uint32 TotalSize = 0;
+};
+
+/** One part. Held parts are saved as dropped where they are */
+struct FRobotSnapshotPart
+{
+	static constexpr uint32 NoName = MAX_uint32;
+
+	uint32 PartName = NoName;
+	uint32 RobotName = NoName;
+	uint32 PointName = NoName;
+
+	/** EPartState */
+	uint8 State = 0;
+	uint8 Padding[3] = {};
+
+	/** World location for parts that are not attached */
+	FVector3f Location = FVector3f::ZeroVector;
+};
+
+static_assert(sizeof(FRobotSnapshotHeader) == 40, "Snapshot header layout is part of the file format");
+static_assert(sizeof(FRobotSnapshotPart) == 28, "Snapshot part layout is part of the file format");
+
+namespace RobotSnapshot
+{
+	/** Write the state of every part in World. Returns false if there was nothing to save */
+	ROBOTABUSE_API bool Save(UWorld* World, TArray<uint8>& OutBytes);
+
+	/**
+	 * Put every part back into its saved socket or location. All socket changes go through one
+	 * FAttachmentTransaction. Returns the number of parts changed, INDEX_NONE if Bytes is not a valid snapshot
+	 */
+	ROBOTABUSE_API int32 Restore(UWorld* World, TConstArrayView<uint8> Bytes);
+
+	ROBOTABUSE_API bool SaveToFile(UWorld* World, const FString& Path);
+
+	/** Memory-maps the file where the platform supports it, otherwise reads it */
+	ROBOTABUSE_API int32 RestoreFromFile(UWorld* World, const FString& Path);
+
+	/** Saved/Snapshots/<Name>.robosnap */
+	ROBOTABUSE_API FString GetDefaultPath(const FString& Name);
+}
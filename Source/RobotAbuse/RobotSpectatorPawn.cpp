@@ -1,33 +1,135 @@
 ﻿#include "RobotSpectatorPawn.h"
+#include "RobotAbuse.h"
 #include "AttachablePart.h"
+#include "AttachmentJournal.h"
 #include "AttachmentPoint.h"
-#include "IClickable.h"
-#include "IHoverable.h"
-#include "IDraggable.h"
-#include "IAttachable.h"
+#include "AttachmentPointSubsystem.h"
+#include "InteractionTarget.h"
+#include "RobotAttachmentState.h"
+#include "RobotAssetPreloader.h"
+#include "RobotEventBus.h"
+#include "RobotFleetRenderer.h"
+#include "RobotStatusPanel.h"
 #include "Blueprint/UserWidget.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "SceneView.h"
+
+ARobotSpectatorPawn::ARobotSpectatorPawn(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Spectator pawns are local by default. This one replicates so its owner can send part actions
+	// to the server, its movement stays on the client
+	bReplicates = true;
+	SetReplicatingMovement(false);
+}
 
 void ARobotSpectatorPawn::BeginPlay()
 {
 	Super::BeginPlay();
 
+	ResumeHover();
+
+	// Virtual users from the load driver have no controller, they only get synthetic input
 	CachedPC = Cast<APlayerController>(GetController());
-	check(CachedPC);
+	if (!CachedPC)
+	{
+		return;
+	}
 	
 	CachedPC->bShowMouseCursor = true;
-	CachedPC->bEnableClickEvents = true;
-	CachedPC->bEnableMouseOverEvents = true;
 
-	if (UClass* WidgetClass = LoadClass<UUserWidget>(nullptr, TEXT("/Game/Widgets/WBP_ArmStatus.WBP_ArmStatus_C")))
+	// Engine cursor events would run their own trace every tick, all interaction goes through CursorQuery
+	CachedPC->bEnableClickEvents = false;
+	CachedPC->bEnableMouseOverEvents = false;
+
+	// Only local players have UI to feed, virtual users and remote players stay off the bus
+	if (!CachedPC->IsLocalController())
 	{
-		UUserWidget* Widget = CreateWidget<UUserWidget>(CachedPC, WidgetClass);
-		if (Widget)
-		{
-			Widget->AddToViewport();
-		}
+		return;
+	}
+
+	URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(GetWorld());
+	if (EventBus && bBroadcastPartStateChanged)
+	{
+		RobotEventsHandle = EventBus->OnEvents.AddUObject(this, &ARobotSpectatorPawn::HandleRobotEvents);
+	}
+
+	if (SRobotStatusPanel::IsEnabled())
+	{
+		AddStatusPanel();
+	}
+
+	// The player can interact before the widget shows up
+	if (!LegacyStatusWidgetClass.IsNull())
+	{
+		LegacyStatusWidgetHandle = RobotAssets::LoadAsync({ LegacyStatusWidgetClass.ToSoftObjectPath() },
+			FStreamableDelegate::CreateUObject(this, &ARobotSpectatorPawn::AddLegacyStatusWidget), TEXT("LegacyStatusWidget"));
+	}
+}
+
+void ARobotSpectatorPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	RemoveStatusPanel();
+
+	if (LegacyStatusWidgetHandle.IsValid())
+	{
+		LegacyStatusWidgetHandle->CancelHandle();
+		LegacyStatusWidgetHandle.Reset();
+	}
+
+	if (URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(GetWorld()))
+	{
+		EventBus->OnEvents.Remove(RobotEventsHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// ===== UI =====
+
+void ARobotSpectatorPawn::AddStatusPanel()
+{
+	ULocalPlayer* LocalPlayer = CachedPC->GetLocalPlayer();
+	if (!LocalPlayer || !LocalPlayer->ViewportClient)
+	{
+		return;
+	}
+
+	StatusPanel = SNew(SRobotStatusPanel)
+		.World(GetWorld())
+		.Owner(this);
+
+	LocalPlayer->ViewportClient->AddViewportWidgetForPlayer(LocalPlayer, StatusPanel.ToSharedRef(), 10);
+}
+
+void ARobotSpectatorPawn::RemoveStatusPanel()
+{
+	if (!StatusPanel)
+	{
+		return;
+	}
+
+	ULocalPlayer* LocalPlayer = CachedPC ? CachedPC->GetLocalPlayer() : nullptr;
+	if (LocalPlayer && LocalPlayer->ViewportClient)
+	{
+		LocalPlayer->ViewportClient->RemoveViewportWidgetForPlayer(LocalPlayer, StatusPanel.ToSharedRef());
+	}
+	StatusPanel.Reset();
+}
+
+void ARobotSpectatorPawn::AddLegacyStatusWidget()
+{
+	UClass* WidgetClass = LegacyStatusWidgetClass.Get();
+	if (!WidgetClass || !CachedPC || !HasActorBegunPlay())
+	{
+		return;
+	}
+
+	if (UUserWidget* Widget = CreateWidget<UUserWidget>(CachedPC, WidgetClass))
+	{
+		Widget->AddToViewport();
 	}
-	
-	StartHighlightTimer();
 }
 
 void ARobotSpectatorPawn::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -37,26 +139,105 @@ void ARobotSpectatorPawn::SetupPlayerInputComponent(UInputComponent* PlayerInput
 	// Parent class already handles movement input
 	// Added custom interaction
 	PlayerInputComponent->BindAction("MouseClick", IE_Pressed, this, &ARobotSpectatorPawn::OnMouseClick);
+	PlayerInputComponent->BindAction("Undo", IE_Pressed, this, &ARobotSpectatorPawn::OnUndo);
+	PlayerInputComponent->BindAction("Redo", IE_Pressed, this, &ARobotSpectatorPawn::OnRedo);
 }
 
 void ARobotSpectatorPawn::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	CursorQuery.Update(CachedPC);
+
+	ReleaseLostPart();
+
 	if (DraggedActor)
 	{
-		UpdateDraggedActor();
+		// The late tick moves the part once the camera is final, so it is not drawn a frame behind the cursor
+		if (!UsesLateDrag())
+		{
+			UpdateDraggedActor(DeltaTime);
+		}
+	}
+	else if (bHoverEnabled)
+	{
+		UpdateHighlights();
+	}
+}
+
+// ===== Late Drag =====
+
+void ARobotSpectatorPawn::RegisterActorTickFunctions(bool bRegister)
+{
+	Super::RegisterActorTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		if (PrimaryActorTick.bCanEverTick)
+		{
+			LateDragTick.Target = this;
+			LateDragTick.bCanEverTick = true;
+			LateDragTick.TickGroup = TG_LastDemotable;
+			LateDragTick.RegisterTickFunction(GetLevel());
+			LateDragTick.AddPrerequisite(this, PrimaryActorTick);
+		}
+	}
+	else if (LateDragTick.IsTickFunctionRegistered())
+	{
+		LateDragTick.UnRegisterTickFunction();
+	}
+}
+
+bool ARobotSpectatorPawn::UsesLateDrag() const
+{
+	// Pawns ticked by hand (load driver virtual users) have the actor tick off and keep the single update
+	return FDragInputFilter::IsLowLatencyEnabled()
+		&& LateDragTick.IsTickFunctionRegistered()
+		&& PrimaryActorTick.IsTickFunctionEnabled();
+}
+
+void ARobotSpectatorPawn::LateTick(float DeltaTime)
+{
+	if (!DraggedActor || !UsesLateDrag())
+	{
+		return;
 	}
+
+	ROBOT_TRACE_SCOPE("RobotAbuse::LateDrag");
+
+	// Sample the cursor again, straight from the platform, now that the view for this frame is final
+	CursorQuery.Update(CachedPC, true);
+	UpdateDraggedActor(DeltaTime);
+}
+
+// ===== Synthetic Input =====
+
+void ARobotSpectatorPawn::SetSyntheticCursor(const FVector& Origin, const FVector& Direction)
+{
+	CursorQuery.SetRayOverride(GetWorld(), Origin, Direction);
+}
+
+void ARobotSpectatorPawn::ClearSyntheticCursor()
+{
+	CursorQuery.ClearRayOverride();
 }
 
 void ARobotSpectatorPawn::OnMouseClick()
 {
-	if (!CachedPC) return;
+	ROBOT_TRACE_SCOPE("RobotAbuse::Click");
+
+	if (!HasCursor()) return;
 
-	FHitResult Hit;
-	CachedPC->GetHitResultUnderCursor(ECC_Visibility, false, Hit);
+	CursorQuery.Update(CachedPC);
+	const FHitResult& Hit = CursorQuery.GetHit(EInteractionQueryType::Click);
 
-	UE_LOG(LogTemp, Display, TEXT("Click Test"));
+	// Whatever happens below changes what is under the cursor
+	CursorQuery.Invalidate();
+
+	UE_LOG(LogRobotAbuse, VeryVerbose, TEXT("Mouse click"));
+
+	// Whatever the click changes is this pawn's step in the history
+	FAttachmentJournalInstigatorScope JournalInstigator(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()), this);
 
 	// If already dragging something
 	if (DraggedActor)
@@ -66,25 +247,43 @@ void ARobotSpectatorPawn::OnMouseClick()
 		USceneComponent* Parent = HitComponent ? HitComponent->GetAttachParent() : nullptr;
 		UAttachmentPoint* Point = Cast<UAttachmentPoint>(Parent);
 
-		if (Point)
+		// Missed the socket visual: take the socket drag assist is highlighting, the click should do what it shows.
+		// Only without a suggestion fall back to the closest compatible socket right next to the part
+		if (!Point)
+		{
+			Point = DragAssist.GetSuggestion();
+		}
+		if (!Point)
+		{
+			Point = FindSnapPoint();
+		}
+
+		if (Point && IsNetClient())
+		{
+			// The server validates the attach, the part stays in hand until the replicated attach arrives
+			if (AAttachablePart* Part = Cast<AAttachablePart>(DraggedActor))
+			{
+				ServerAttach(Part, Point->GetOwner(), Point->GetFName());
+			}
+		}
+		else if (Point)
 		{
 			// Try to attach - let the object handle the logic
-			if (DraggedActor->Implements<UAttachable>())
+			if (DraggedTarget.Has(EInteractionCapability::Attachable))
 			{
-				bool bAttached = IAttachable::Execute_TryAttachTo(DraggedActor, Point);
+				bool bAttached = DraggedTarget.TryAttachTo(Point);
 
 				if (bAttached)
 				{
-					// Success - stop dragging and broadcast event
+					// Success - stop dragging and post event
 					if (AAttachablePart* Part = Cast<AAttachablePart>(DraggedActor))
 					{
-						FString Message = FString::Printf(TEXT("Attached %s"), *Part->GetName());
-						OnPartStateChanged.Broadcast(Part);
+						PostPartEvent(ERobotEventType::Attached, Part);
 					}
 
-					DraggedActor = nullptr;
+					SetDraggedActor(nullptr);
 					InitialDragDistance = 0.0f;
-					StartHighlightTimer();
+					ResumeHover();
 				}
 				// If failed, keep dragging (wrong socket type)
 			}
@@ -92,55 +291,106 @@ void ARobotSpectatorPawn::OnMouseClick()
 		else
 		{
 			// Clicked empty space - drop
-			if (DraggedActor->Implements<UDraggable>())
+			if (DraggedTarget.Has(EInteractionCapability::Draggable))
 			{
-				IDraggable::Execute_OnDropped(DraggedActor);
+				DraggedTarget.OnDropped();
 
-				// Broadcast UI event, only updates if the current thing dragging is part 
+				// Post UI event, only updates if the current thing dragging is part 
 				if (AAttachablePart* Part = Cast<AAttachablePart>(DraggedActor))
 				{
-					FString Message = FString::Printf(TEXT("Dropped %s"), *Part->GetName());
-					OnPartStateChanged.Broadcast(Part);
+					SendDrop(Part);
+					PostPartEvent(ERobotEventType::Dropped, Part);
 				}
 			}
 
-			DraggedActor = nullptr;
+			SetDraggedActor(nullptr);
 			InitialDragDistance = 0.0f;
-			StartHighlightTimer();
+			ResumeHover();
 		}
 	}
 	// Not dragging, try to pick up
-	else if (AActor* HitActor = Hit.GetActor())
+	else if (AActor* HitActor = ResolveHitActor(Hit))
 	{
 		HandleNewClick(HitActor);
 	}
 }
 
+void ARobotSpectatorPawn::OnUndo()
+{
+	if (IsNetClient())
+	{
+		ServerUndo(false);
+	}
+	else if (UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()))
+	{
+		// Alone the whole history is ours, in a session only our own steps are
+		if (GetNetMode() == NM_Standalone)
+		{
+			Journal->Undo();
+		}
+		else
+		{
+			Journal->UndoBy(this);
+		}
+	}
+}
+
+void ARobotSpectatorPawn::OnRedo()
+{
+	if (IsNetClient())
+	{
+		ServerUndo(true);
+	}
+	else if (UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()))
+	{
+		if (GetNetMode() == NM_Standalone)
+		{
+			Journal->Redo();
+		}
+		else
+		{
+			Journal->RedoBy(this);
+		}
+	}
+}
+
 // = Interaction Functions =
 
 void ARobotSpectatorPawn::HandleNewClick(AActor* Actor)
 {
-	if (Actor->Implements<UClickable>())
+	FInteractionTarget Target;
+	Target.Set(Actor);
+
+	if (Target.Has(EInteractionCapability::Clickable))
 	{
-		StopHighlightTimer();
+		AAttachablePart* ClickedPart = Cast<AAttachablePart>(Actor);
+		if (ClickedPart && !CanSendPickUp(ClickedPart))
+		{
+			return;
+		}
+
+		SuspendHover();
 		// Call click interface - part handles pickup itself via OnClicked
-		IClickable::Execute_OnClicked(Actor);
+		Target.OnClicked();
 
-		// Calculate drag distance from camera to object
-		FVector CameraLocation;
-		FRotator CameraRotation;
-		CachedPC->GetPlayerViewPoint(CameraLocation, CameraRotation);
+		// Calculate drag distance from camera to object, synthetic input has no camera so use its ray
+		FVector CameraLocation = CursorQuery.GetRayOrigin();
+		if (!CursorQuery.HasRayOverride())
+		{
+			FRotator CameraRotation;
+			CachedPC->GetPlayerViewPoint(CameraLocation, CameraRotation);
+		}
 		float Distance = FVector::Dist(CameraLocation, Actor->GetActorLocation());
 
 		// Start dragging
-		DraggedActor = Actor;
+		SetDraggedActor(Actor);
 		InitialDragDistance = Distance;
 
-		// Broadcast UI event
-		if (AAttachablePart* Part = Cast<AAttachablePart>(Actor))
+		// Post UI event
+		if (ClickedPart)
 		{
-			FString Message = FString::Printf(TEXT("Picked up %s"), *Part->GetName());
-			OnPartStateChanged.Broadcast(Part);
+			SendPickUp(ClickedPart);
+			PostPartEvent(ERobotEventType::PickedUp, ClickedPart);
 		}
 	}
 }
@@ -149,119 +399,411 @@ void ARobotSpectatorPawn::StopDragging()
 {
 	if (DraggedActor)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Stopped dragging: %s"), *DraggedActor->GetName());
+		UE_LOG(LogRobotAbuse, Verbose, TEXT("Stopped dragging: %s"), *DraggedActor->GetName());
+	}
+
+	SetDraggedActor(nullptr);
+}
+
+AActor* ARobotSpectatorPawn::ResolveHitActor(const FHitResult& Hit)
+{
+	// Fleet instances stand in for idle parts, touching one brings the real part back
+	if (URobotFleetRenderer* Fleet = UWorld::GetSubsystem<URobotFleetRenderer>(GetWorld()))
+	{
+		if (AAttachablePart* Part = Fleet->PromoteFromHit(Hit))
+		{
+			// The instance the hit points at is gone, a still cursor has to trace the real mesh next time
+			CursorQuery.Invalidate();
+			return Part;
+		}
+	}
+
+	return Hit.GetActor();
+}
+
+void ARobotSpectatorPawn::SetDraggedActor(AActor* Actor)
+{
+	if (Actor != DraggedActor)
+	{
+		DragAssist.Clear();
+		DragFilter.Reset();
+	}
+
+	DraggedActor = Actor;
+	DraggedTarget.Set(Actor);
+}
+
+void ARobotSpectatorPawn::SetHoveredTarget(UObject* Target)
+{
+	HoveredTarget = Target;
+	HoverTarget.Set(Target);
+}
+
+UAttachmentPoint* ARobotSpectatorPawn::FindSnapPoint() const
+{
+	AAttachablePart* Part = Cast<AAttachablePart>(DraggedActor);
+	if (!Part)
+	{
+		return nullptr;
 	}
 
-	DraggedActor = nullptr;
+	const UAttachmentPointSubsystem* Subsystem = UWorld::GetSubsystem<UAttachmentPointSubsystem>(GetWorld());
+	return Subsystem ? Subsystem->FindNearestCompatiblePoint(Part, Part->GetActorLocation(), DropSnapRadius) : nullptr;
+}
+
+// ===== Events =====
+
+void ARobotSpectatorPawn::PostPartEvent(ERobotEventType Type, AAttachablePart* Part)
+{
+	if (URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(GetWorld()))
+	{
+		EventBus->Post(Type, Part, this);
+	}
+}
+
+void ARobotSpectatorPawn::HandleRobotEvents(TConstArrayView<FRobotEvent> Events)
+{
+	if (!OnPartStateChanged.IsBound())
+	{
+		return;
+	}
+
+	// The widget shows one part, the last one this pawn touched this frame is the one that sticks
+	for (int32 Index = Events.Num() - 1; Index >= 0; --Index)
+	{
+		if (Events[Index].Instigator == this)
+		{
+			AAttachablePart* Part = Events[Index].Part;
+			OnPartStateChanged.Broadcast(IsValid(Part) ? Part : nullptr);
+			return;
+		}
+	}
 }
 
 // ===== Update Functions =====
 
-void ARobotSpectatorPawn::UpdateDraggedActor()
+void ARobotSpectatorPawn::UpdateDraggedActor(float DeltaTime)
 {
-	if (!CachedPC || !DraggedActor) return;
+	ROBOT_TRACE_SCOPE("RobotAbuse::UpdateDrag");
 
-	// Get the world position and direction from the mouse cursor
-	FVector MouseWorldLocation;
-	FVector MouseWorldDirection;
+	if (!HasCursor() || !DraggedActor) return;
 
-	if (!CachedPC->DeprojectMousePositionToWorld(MouseWorldLocation, MouseWorldDirection))
+	// Get the world position and direction from the mouse cursor
+	if (!CursorQuery.HasRay())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Failed to deproject mouse position"));
+		UE_LOG(LogRobotAbuse, VeryVerbose, TEXT("Failed to deproject mouse position"));
 		return;
 	}
 
+	const FVector& MouseWorldLocation = CursorQuery.GetRayOrigin();
+	const FVector& MouseWorldDirection = CursorQuery.GetRayDirection();
+
+	// In async mode keep a drop target trace in flight, so the attach click can skip its own trace
+	CursorQuery.Prefetch(EInteractionQueryType::DragTarget);
+
 	// Calculate where the dragged object should be:
 	// Start at mouse world position, extend along direction by the initial distance
-	FVector NewLocation = MouseWorldLocation + (MouseWorldDirection * InitialDragDistance);
+	const FVector CursorLocation = MouseWorldLocation + (MouseWorldDirection * InitialDragDistance);
+	FVector NewLocation;
+	const bool bMoved = DragFilter.Filter(CursorLocation, DeltaTime, LowLatencyDragSettings, NewLocation);
 
-	// Tell the dragged object to update its position via interface
-	if (DraggedActor->Implements<UDraggable>())
+	// Tell the dragged object to update its position via interface, natively when possible
+	if (DraggedTarget.Has(EInteractionCapability::Draggable))
 	{
-		IDraggable::Execute_UpdateDragPosition(DraggedActor, NewLocation);
+		// A resting cursor leaves the part's transform alone
+		if (bMoved)
+		{
+			DraggedTarget.UpdateDragPosition(NewLocation);
+
+			if (AAttachablePart* Part = Cast<AAttachablePart>(DraggedActor))
+			{
+				SendDragMove(Part);
+			}
+		}
 	}
 	else
 	{
-		UE_LOG(LogTemp, Error, TEXT("DraggedActor does not implement IDraggable!"));
+		UE_LOG(LogRobotAbuse, Error, TEXT("DraggedActor does not implement IDraggable!"));
 	}
+
+	UpdateDragAssist();
 }
 
-void ARobotSpectatorPawn::StartHighlightTimer()
+void ARobotSpectatorPawn::UpdateDragAssist()
 {
-	if (!GetWorldTimerManager().IsTimerActive(HighlightTimerHandle))
+	AAttachablePart* Part = Cast<AAttachablePart>(DraggedActor);
+	if (!Part || !FDragAssist::IsEnabled())
 	{
-		UE_LOG(LogTemp, Log, TEXT("Starting highlight timer"));
-        
-		// Run UpdateHighlights every 0.1 seconds (10 times per second)
-		GetWorldTimerManager().SetTimer(
-			HighlightTimerHandle,                          
-			this,                                         
-			&ARobotSpectatorPawn::UpdateHighlights,       
-			0.1f,                                       
-			true                                   
-		);
+		DragAssist.Clear();
+		return;
+	}
+
+	FDragAssistView View;
+	View.RayOrigin = CursorQuery.GetRayOrigin();
+	View.RayDirection = CursorQuery.GetRayDirection();
+
+	// Screen distance needs the real camera, synthetic cursors score by distance and angle only
+	const ULocalPlayer* LocalPlayer = CachedPC && !CursorQuery.HasRayOverride() ? CachedPC->GetLocalPlayer() : nullptr;
+	FSceneViewProjectionData Projection;
+	float MouseX = 0.0f;
+	float MouseY = 0.0f;
+
+	if (LocalPlayer && LocalPlayer->ViewportClient
+		&& LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, Projection)
+		&& CachedPC->GetMousePosition(MouseX, MouseY))
+	{
+		const FIntRect ViewRect = Projection.GetConstrainedViewRect();
+		View.bHasProjection = true;
+		View.ViewProjection = Projection.ComputeViewProjectionMatrix();
+		View.ViewMin = FVector2D(ViewRect.Min);
+		View.ViewSize = FVector2D(ViewRect.Size());
+		View.CursorPosition = FVector2D(MouseX, MouseY);
 	}
+
+	DragAssist.Update(Part, View, DragAssistSettings);
 }
 
-void ARobotSpectatorPawn::StopHighlightTimer()
+// ===== Multi-User =====
+
+bool ARobotSpectatorPawn::CanSendPickUp(const AAttachablePart* Part) const
 {
-	if (GetWorldTimerManager().IsTimerActive(HighlightTimerHandle))
+	if (IsNetClient())
 	{
-		UE_LOG(LogTemp, Log, TEXT("Stopping highlight timer"));
-        
-		GetWorldTimerManager().ClearTimer(HighlightTimerHandle);
-        
-		// Clear any current highlight when stopping
-		if (HoveredTarget && HoveredTarget->Implements<UHoverable>())
+		return true;
+	}
+
+	const ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+	return !NetState || NetState->CanPickUp(Part, this);
+}
+
+void ARobotSpectatorPawn::SendPickUp(AAttachablePart* Part)
+{
+	ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+
+	if (IsNetClient())
+	{
+		// Already picked up locally, the server confirms or rolls it back
+		if (NetState)
 		{
-			IHoverable::Execute_OnHoverEnd(HoveredTarget);
+			NetState->BeginPrediction(Part);
 		}
+		ServerPickUp(Part);
+	}
+	else if (NetState)
+	{
+		NetState->RecordPart(Part, this);
+	}
+}
+
+void ARobotSpectatorPawn::SendDrop(AAttachablePart* Part)
+{
+	if (!IsNetClient())
+	{
+		return;
+	}
+
+	if (ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld()))
+	{
+		NetState->BeginPrediction(Part);
+	}
+	ServerDrop(Part, Part->GetActorLocation());
+}
+
+void ARobotSpectatorPawn::SendDragMove(AAttachablePart* Part)
+{
+	ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+	const float Interval = ARobotAttachmentState::GetMoveSendInterval();
+	if ((!NetState && !IsNetClient()) || Interval <= 0.0f)
+	{
+		return;
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (Now < NextDragSendTime)
+	{
+		return;
+	}
+	NextDragSendTime = Now + Interval;
+
+	if (IsNetClient())
+	{
+		ServerMoveHeld(Part, Part->GetActorLocation());
+	}
+	else
+	{
+		NetState->RecordMove(Part);
+	}
+}
+
+void ARobotSpectatorPawn::ReleasePart(AAttachablePart* Part)
+{
+	if (!Part || DraggedActor != Part)
+	{
+		return;
+	}
+
+	if (Part->IsHeld())
+	{
+		Part->Drop();
+	}
+	ReleaseLostPart();
+}
+
+void ARobotSpectatorPawn::ReleaseLostPart()
+{
+	AAttachablePart* Part = Cast<AAttachablePart>(DraggedActor);
+	if (!Part)
+	{
+		return;
+	}
+
+	const ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+	if (Part->IsHeld() && !(NetState && NetState->IsHeldByOther(Part, this)))
+	{
+		return;
+	}
+
+	SetDraggedActor(nullptr);
+	InitialDragDistance = 0.0f;
+	ResumeHover();
+	PostPartEvent(ERobotEventType::Released, Part);
+}
+
+void ARobotSpectatorPawn::ServerPickUp_Implementation(AAttachablePart* Part)
+{
+	ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+	const bool bAccepted = NetState && NetState->CanPickUp(Part, this);
+	FAttachmentJournalInstigatorScope JournalInstigator(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()), this);
+
+	if (bAccepted)
+	{
+		// Same as a local click: detaches if needed, then picks up
+		Part->OnClicked_Implementation();
+		NetState->RecordPart(Part, this);
+	}
+
+	ClientActionResult(Part, bAccepted);
+}
+
+void ARobotSpectatorPawn::ServerDrop_Implementation(AAttachablePart* Part, FVector_NetQuantize10 Location)
+{
+	ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+	const bool bAccepted = NetState && NetState->IsHeldBy(Part, this);
+	FAttachmentJournalInstigatorScope JournalInstigator(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()), this);
+
+	if (bAccepted)
+	{
+		Part->SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+		Part->Drop();
+	}
+
+	ClientActionResult(Part, bAccepted);
+}
+
+void ARobotSpectatorPawn::ServerAttach_Implementation(AAttachablePart* Part, AActor* Robot, FName PointName)
+{
+	ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+	UAttachmentPoint* Point = UAttachmentPoint::FindByName(Robot, PointName);
+	FAttachmentJournalInstigatorScope JournalInstigator(UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()), this);
+
+	// TryAttachTo checks the socket type and occupancy, the part records the result itself
+	const bool bAccepted = NetState && Point && NetState->IsHeldBy(Part, this) && Part->TryAttachTo_Implementation(Point);
+
+	ClientActionResult(Part, bAccepted);
+}
+
+void ARobotSpectatorPawn::ServerMoveHeld_Implementation(AAttachablePart* Part, FVector_NetQuantize10 Location)
+{
+	ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld());
+	if (NetState && NetState->IsHeldBy(Part, this))
+	{
+		Part->SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+		NetState->RecordMove(Part);
+	}
+}
+
+void ARobotSpectatorPawn::ServerUndo_Implementation(bool bRedo)
+{
+	// Only this player's own steps, the replay changes parts like any other action and replicates
+	// through the session state
+	if (UAttachmentJournal* Journal = UWorld::GetSubsystem<UAttachmentJournal>(GetWorld()))
+	{
+		if (bRedo)
+		{
+			Journal->RedoBy(this);
+		}
+		else
+		{
+			Journal->UndoBy(this);
+		}
+	}
+}
+
+void ARobotSpectatorPawn::ClientActionResult_Implementation(AAttachablePart* Part, bool bAccepted)
+{
+	if (!bAccepted)
+	{
+		UE_LOG(LogRobotAbuse, Verbose, TEXT("Server rejected action on %s"), *GetNameSafe(Part));
+	}
+
+	if (ARobotAttachmentState* NetState = ARobotAttachmentState::Get(GetWorld()))
+	{
+		NetState->EndPrediction(Part, bAccepted);
+	}
+}
+
+void ARobotSpectatorPawn::ResumeHover()
+{
+	bHoverEnabled = true;
+}
+
+void ARobotSpectatorPawn::SuspendHover()
+{
+	if (bHoverEnabled)
+	{
+		bHoverEnabled = false;
         
-		HoveredTarget = nullptr;
+		// Clear any current highlight when stopping
+		HoverTarget.OnHoverEnd();
+        
+		SetHoveredTarget(nullptr);
 	}
 }
 
 void ARobotSpectatorPawn::UpdateHighlights()
 {
-	if (!CachedPC) return;
+	ROBOT_TRACE_SCOPE("RobotAbuse::UpdateHover");
+
+	if (!HasCursor()) return;
 
-	FHitResult Hit;
-	CachedPC->GetHitResultUnderCursor(ECC_Visibility, false, Hit);
+	// Reuses this frame's cursor trace, and only traces at all when the cursor or camera moved
+	const FHitResult& Hit = CursorQuery.GetHit(EInteractionQueryType::Hover);
 
 	AActor* NewTarget = nullptr;
 
 	if (!DraggedActor)
 	{
-		if (Hit.GetActor() && Hit.GetActor()->Implements<UClickable>())
+		AActor* HitActor = ResolveHitActor(Hit);
+		if (HitActor && FInteractionClassInfo::Get(HitActor->GetClass()).Has(EInteractionCapability::Clickable))
 		{
-			NewTarget = Hit.GetActor();
+			NewTarget = HitActor;
 		}
 	}
 
 	// Update highlight if changed
 	if (NewTarget != HoveredTarget)
 	{
-		// End hover on old target
-		if (HoveredTarget && HoveredTarget->Implements<UHoverable>())
-		{
-			IHoverable::Execute_OnHoverEnd(HoveredTarget);
-		}
+		ROBOT_CSV_COUNT(HoverChanges);
 
-		// Begin hover on new target
-		if (NewTarget && NewTarget->Implements<UHoverable>())
-		{
-			IHoverable::Execute_OnHoverBegin(NewTarget);
-		}
+		// End hover on old target. A part the fleet takes back changes what is under the cursor
+		HoverTarget.OnHoverEnd();
+		CursorQuery.Invalidate();
 
-		HoveredTarget = NewTarget;
+		// Begin hover on new target
+		SetHoveredTarget(NewTarget);
+		HoverTarget.OnHoverBegin();
 
-		if (AAttachablePart* Part = Cast<AAttachablePart>(NewTarget))
-		{
-			OnPartStateChanged.Broadcast(Part);
-		}
-		else
-		{
-			OnPartStateChanged.Broadcast(nullptr); // Cleared hover
-		}
+		// Null when the hover cleared
+		PostPartEvent(ERobotEventType::HoverChanged, Cast<AAttachablePart>(NewTarget));
 	}
 }
@@ -1,10 +1,19 @@
 ﻿#pragma once
 
 #include "GameFramework/SpectatorPawn.h"
+#include "DragAssist.h"
+#include "InteractionQuery.h"
+#include "InteractionTarget.h"
+#include "LowLatencyDrag.h"
 #include "RobotSpectatorPawn.generated.h"
 
 class AAttachablePart;
+class SRobotStatusPanel;
 class UAttachmentPoint;
+class UUserWidget;
+enum class ERobotEventType : uint8;
+struct FRobotEvent;
+struct FStreamableHandle;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPartStateChanged, AAttachablePart*, Part);
 
@@ -14,38 +23,150 @@ class ROBOTABUSE_API ARobotSpectatorPawn : public ASpectatorPawn
 	GENERATED_BODY()
 
 public:
+	ARobotSpectatorPawn(const FObjectInitializer& ObjectInitializer);
+
+	/** Blueprint adapter over URobotEventBus: at most one call per frame, for the last part this pawn hovered or changed */
 	UPROPERTY(BlueprintAssignable, Category = "UI Events")
 	FOnPartStateChanged OnPartStateChanged;
+
+	// WBP_ArmStatus listens to OnPartStateChanged. Turn off when no Blueprint does, native code subscribes to URobotEventBus
+	UPROPERTY(EditAnywhere, Category = "UI Events")
+	bool bBroadcastPartStateChanged = true;
+
+	// Blueprint status widget to show next to the native panel, e.g. WBP_ArmStatus. Streamed in after BeginPlay when set
+	UPROPERTY(EditAnywhere, Category = "UI")
+	TSoftClassPtr<UUserWidget> LegacyStatusWidgetClass;
 	
 	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
 	virtual void Tick(float DeltaTime) override;
 
+	/** End-of-frame drag update, run by LateDragTick after the camera has moved for the frame */
+	void LateTick(float DeltaTime);
+
+	// ===== Synthetic Input =====
+
+	/** Drive the cursor with a world-space ray instead of the mouse. Works without a player controller */
+	void SetSyntheticCursor(const FVector& Origin, const FVector& Direction);
+	void ClearSyntheticCursor();
+
+	/** Same as a left click at the current cursor */
+	void SimulateClick() { OnMouseClick(); }
+
+	AActor* GetDraggedActor() const { return DraggedActor; }
+	UAttachmentPoint* GetSuggestedSocket() const { return DragAssist.GetSuggestion(); }
+	UObject* GetHoveredTarget() const { return HoveredTarget; }
+
+	/** Drop Part and stop dragging it if this pawn has it, for code that puts parts down itself */
+	void ReleasePart(AAttachablePart* Part);
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void RegisterActorTickFunctions(bool bRegister) override;
 
 	// ===== Input Handlers =====
     
 	void OnMouseClick();
+	void OnUndo();
+	void OnRedo();
 
 	// ===== Interaction Functions =====
     
 	void HandleNewClick(AActor* Actor);
 	void StopDragging();
 
+	// Actor behind a hit, promoting fleet instances back to their part
+	AActor* ResolveHitActor(const FHitResult& Hit);
+
+	// Keep the cached dispatch in sync with the referenced object
+	void SetDraggedActor(AActor* Actor);
+	void SetHoveredTarget(UObject* Target);
+
 	// ===== Update Functions =====
     
-	void UpdateDraggedActor();
+	void UpdateDraggedActor(float DeltaTime);
 	void UpdateHighlights();
 	
-	void StartHighlightTimer();
-	void StopHighlightTimer();
+	void ResumeHover();
+	void SuspendHover();
+
+	UAttachmentPoint* FindSnapPoint() const;
+
+	// ===== UI =====
+
+	void AddStatusPanel();
+	void RemoveStatusPanel();
+	void AddLegacyStatusWidget();
+
+	// ===== Events =====
+
+	void PostPartEvent(ERobotEventType Type, AAttachablePart* Part);
+	void HandleRobotEvents(TConstArrayView<FRobotEvent> Events);
+
+	// ===== Multi-User =====
+
+	// Clients ask the server for every part change, see ARobotAttachmentState
+	bool IsNetClient() const { return GetNetMode() == NM_Client; }
+
+	// Servers pick up on the spot, so they check what ServerPickUp checks before the click acts. Clients predict
+	bool CanSendPickUp(const AAttachablePart* Part) const;
+
+	// Tell the session about a pickup or drop: predicted and sent on clients, recorded on the server
+	void SendPickUp(AAttachablePart* Part);
+	void SendDrop(AAttachablePart* Part);
+	void SendDragMove(AAttachablePart* Part);
+
+	// Stop dragging a part the server attached, took back or gave to someone else, or an undo put down
+	void ReleaseLostPart();
+
+	UFUNCTION(Server, Reliable)
+	void ServerPickUp(AAttachablePart* Part);
+
+	UFUNCTION(Server, Reliable)
+	void ServerDrop(AAttachablePart* Part, FVector_NetQuantize10 Location);
+
+	UFUNCTION(Server, Reliable)
+	void ServerAttach(AAttachablePart* Part, AActor* Robot, FName PointName);
+
+	UFUNCTION(Server, Unreliable)
+	void ServerMoveHeld(AAttachablePart* Part, FVector_NetQuantize10 Location);
+
+	// Undo history is kept on the server, see UAttachmentJournal
+	UFUNCTION(Server, Reliable)
+	void ServerUndo(bool bRedo);
+
+	UFUNCTION(Client, Reliable)
+	void ClientActionResult(AAttachablePart* Part, bool bAccepted);
+
+	// True if there is a cursor to interact with, from the player or from synthetic input
+	bool HasCursor() const { return CachedPC || CursorQuery.HasRayOverride(); }
+
+	// Dropping a part this close to a compatible empty socket attaches it instead
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	float DropSnapRadius = 30.0f;
+
+	// Best-socket suggestion while dragging a part
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	FDragAssistSettings DragAssistSettings;
+
+	void UpdateDragAssist();
+
+	// Prediction and smoothing for the dragged part, see robot.Interaction.LowLatencyDrag
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	FLowLatencyDragSettings LowLatencyDragSettings;
+
+	// True if the drag is applied in LateTick instead of Tick
+	bool UsesLateDrag() const;
 
 private:
 	
 	float InitialDragDistance;
 	
-	// Timer for hover detection
-	FTimerHandle HighlightTimerHandle;
+	// Hover is evaluated every tick from the shared cursor query while not dragging
+	bool bHoverEnabled = false;
+
+	// Single cursor trace shared by hover, click and drag
+	FInteractionQuery CursorQuery;
 	
 	UPROPERTY()
 	APlayerController* CachedPC;
@@ -55,4 +176,21 @@ private:
 
 	UPROPERTY()
 	UObject* HoveredTarget;
+
+	// Resolved interface dispatch for DraggedActor and HoveredTarget
+	FInteractionTarget DraggedTarget;
+	FInteractionTarget HoverTarget;
+
+	FDragAssist DragAssist;
+
+	FDragInputFilter DragFilter;
+	FRobotLateDragTickFunction LateDragTick;
+
+	// World time the next held part location may go out
+	float NextDragSendTime = 0.0f;
+
+	FDelegateHandle RobotEventsHandle;
+
+	TSharedPtr<SRobotStatusPanel> StatusPanel;
+	TSharedPtr<FStreamableHandle> LegacyStatusWidgetHandle;
 };
@@ -0,0 +1,405 @@
+#include "RobotStatusPanel.h"
+#include "RobotAbuse.h"
+#include "AttachmentPoint.h"
+#include "RobotEventBus.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Styling/CoreStyle.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/SInvalidationPanel.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/SHeaderRow.h"
+#include "Widgets/Views/STableRow.h"
+
+#define LOCTEXT_NAMESPACE "RobotStatusPanel"
+
+static TAutoConsoleVariable<bool> CVarRobotStatusPanel(
+	TEXT("robot.UI.StatusPanel"),
+	true,
+	TEXT("Show the native fleet status panel to players. Read when the pawn begins play."));
+
+namespace RobotStatusColumns
+{
+	static const FName Part(TEXT("Part"));
+	static const FName Socket(TEXT("Socket"));
+	static const FName State(TEXT("State"));
+}
+
+/** Row widget. Holds on to its text blocks so a state change rewrites them without regenerating the row */
+class SRobotStatusRow : public SMultiColumnTableRow<FRobotStatusItemPtr>
+{
+public:
+	SLATE_BEGIN_ARGS(SRobotStatusRow) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& OwnerTable, FRobotStatusItemPtr InItem)
+	{
+		Item = InItem;
+		FSuperRowType::Construct(FSuperRowType::FArguments(), OwnerTable);
+	}
+
+	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override
+	{
+		TSharedRef<STextBlock> Text = SNew(STextBlock).Font(FCoreStyle::GetDefaultFontStyle("Regular", 9));
+
+		if (ColumnName == RobotStatusColumns::Part)
+		{
+			NameText = Text;
+		}
+		else if (ColumnName == RobotStatusColumns::Socket)
+		{
+			SocketText = Text;
+		}
+		else
+		{
+			StateText = Text;
+		}
+
+		Refresh();
+		return Text;
+	}
+
+	void Refresh()
+	{
+		// SetText only invalidates when the text actually differs
+		if (NameText)
+		{
+			NameText->SetText(Item->Name);
+		}
+		if (SocketText)
+		{
+			SocketText->SetText(Item->Socket);
+		}
+		if (StateText)
+		{
+			StateText->SetText(AAttachablePart::GetStateDisplayText(Item->State));
+		}
+	}
+
+private:
+	FRobotStatusItemPtr Item;
+	TSharedPtr<STextBlock> NameText;
+	TSharedPtr<STextBlock> SocketText;
+	TSharedPtr<STextBlock> StateText;
+};
+
+bool SRobotStatusPanel::IsEnabled()
+{
+	return CVarRobotStatusPanel.GetValueOnGameThread();
+}
+
+void SRobotStatusPanel::Construct(const FArguments& InArgs)
+{
+	World = InArgs._World;
+	Owner = InArgs._Owner;
+
+	// Laid over the whole viewport, only the panel itself takes the mouse
+	SetVisibility(EVisibility::SelfHitTestInvisible);
+
+	const FSlateFontInfo TitleFont = FCoreStyle::GetDefaultFontStyle("Bold", 11);
+	const FSlateFontInfo BodyFont = FCoreStyle::GetDefaultFontStyle("Regular", 10);
+
+	ChildSlot
+	.HAlign(HAlign_Right)
+	.VAlign(VAlign_Top)
+	.Padding(16.0f)
+	[
+		SNew(SBox)
+		.WidthOverride(420.0f)
+		.HeightOverride(360.0f)
+		[
+			SNew(SInvalidationPanel)
+			[
+				SNew(SBorder)
+				.BorderImage(FCoreStyle::Get().GetBrush("GenericWhiteBox"))
+				.BorderBackgroundColor(FLinearColor(0.0f, 0.0f, 0.0f, 0.6f))
+				.Padding(8.0f)
+				[
+					SNew(SVerticalBox)
+
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					[
+						SAssignNew(CurrentText, STextBlock)
+						.Font(TitleFont)
+					]
+
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					.Padding(0.0f, 4.0f)
+					[
+						SAssignNew(SummaryText, STextBlock)
+						.Font(BodyFont)
+					]
+
+					+ SVerticalBox::Slot()
+					.FillHeight(1.0f)
+					[
+						SAssignNew(ListView, SListView<FRobotStatusItemPtr>)
+						.ListItemsSource(&Items)
+						.OnGenerateRow(this, &SRobotStatusPanel::GenerateRow)
+						.SelectionMode(ESelectionMode::None)
+						.HeaderRow
+						(
+							SNew(SHeaderRow)
+							+ SHeaderRow::Column(RobotStatusColumns::Part).DefaultLabel(LOCTEXT("PartColumn", "Part")).FillWidth(0.4f)
+							+ SHeaderRow::Column(RobotStatusColumns::Socket).DefaultLabel(LOCTEXT("SocketColumn", "Socket")).FillWidth(0.35f)
+							+ SHeaderRow::Column(RobotStatusColumns::State).DefaultLabel(LOCTEXT("StateColumn", "State")).FillWidth(0.25f)
+						)
+					]
+				]
+			]
+		]
+	];
+
+	if (UWorld* InWorld = World.Get())
+	{
+		if (URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(InWorld))
+		{
+			RobotEventsHandle = EventBus->OnEvents.AddSP(this, &SRobotStatusPanel::HandleRobotEvents);
+		}
+
+		ActorSpawnedHandle = InWorld->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateSP(this, &SRobotStatusPanel::HandleActorSpawned));
+		ActorDestroyedHandle = InWorld->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateSP(this, &SRobotStatusPanel::HandleActorDestroyed));
+	}
+
+	RebuildItems();
+	RefreshCurrent();
+}
+
+SRobotStatusPanel::~SRobotStatusPanel()
+{
+	if (UWorld* InWorld = World.Get())
+	{
+		if (URobotEventBus* EventBus = UWorld::GetSubsystem<URobotEventBus>(InWorld))
+		{
+			EventBus->OnEvents.Remove(RobotEventsHandle);
+		}
+
+		InWorld->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		InWorld->RemoveOnActorDestroyedHandler(ActorDestroyedHandle);
+	}
+}
+
+TSharedRef<ITableRow> SRobotStatusPanel::GenerateRow(FRobotStatusItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(SRobotStatusRow, OwnerTable, Item);
+}
+
+// ===== Items =====
+
+void SRobotStatusPanel::RebuildItems()
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::StatusPanelRebuild");
+
+	bRebuildPending = false;
+
+	Items.Reset();
+	ItemIndices.Reset();
+	FMemory::Memzero(StateCounts);
+
+	if (UWorld* InWorld = World.Get())
+	{
+		for (TActorIterator<AAttachablePart> It(InWorld); It; ++It)
+		{
+			AAttachablePart* Part = *It;
+			if (!IsValid(Part) || Part->IsPooled())
+			{
+				continue;
+			}
+
+			AddItem(Part);
+		}
+	}
+
+	if (ListView)
+	{
+		ListView->RequestListRefresh();
+	}
+	RefreshSummary();
+}
+
+void SRobotStatusPanel::ReadItem(FRobotStatusItem& Item, const AAttachablePart* Part)
+{
+	Item.State = Part->CurrentState;
+
+	UAttachmentPoint* Point = Part->GetAttachmentPoint();
+	if (Item.Point.Get() != Point || (Point && Item.Socket.IsEmpty()))
+	{
+		Item.Point = Point;
+		Item.Socket = Point
+			? FText::Format(LOCTEXT("SocketName", "{0}.{1}"), FText::FromString(GetNameSafe(Point->GetOwner())), FText::FromName(Point->GetFName()))
+			: FText::GetEmpty();
+	}
+}
+
+void SRobotStatusPanel::AddItem(AAttachablePart* Part)
+{
+	FRobotStatusItemPtr Item = MakeShared<FRobotStatusItem>();
+	Item->Part = Part;
+	Item->Name = FText::FromString(Part->GetActorNameOrLabel());
+	ReadItem(*Item, Part);
+
+	ItemIndices.Add(Part, Items.Num());
+	Items.Add(Item);
+	StateCounts[(int32)Item->State]++;
+}
+
+bool SRobotStatusPanel::RemoveItem(const AAttachablePart* Part)
+{
+	int32 Index = INDEX_NONE;
+	if (!ItemIndices.RemoveAndCopyValue(Part, Index))
+	{
+		return false;
+	}
+
+	StateCounts[(int32)Items[Index]->State]--;
+	Items.RemoveAtSwap(Index);
+	if (Items.IsValidIndex(Index))
+	{
+		if (const AAttachablePart* Moved = Items[Index]->Part.Get())
+		{
+			ItemIndices.Add(Moved, Index);
+		}
+	}
+	return true;
+}
+
+bool SRobotStatusPanel::UpdateItem(const AAttachablePart* Part)
+{
+	const int32* Index = ItemIndices.Find(Part);
+	if (!Index)
+	{
+		return false;
+	}
+
+	FRobotStatusItem& Item = *Items[*Index];
+	StateCounts[(int32)Item.State]--;
+	ReadItem(Item, Part);
+	StateCounts[(int32)Item.State]++;
+
+	// Rows only exist for the visible items, the others read the new state when they scroll into view
+	if (TSharedPtr<ITableRow> Row = ListView->WidgetFromItem(Items[*Index]))
+	{
+		StaticCastSharedPtr<SRobotStatusRow>(Row)->Refresh();
+	}
+	return true;
+}
+
+// ===== Updates =====
+
+void SRobotStatusPanel::HandleRobotEvents(TConstArrayView<FRobotEvent> Events)
+{
+	const AActor* OwnerActor = Owner.Get();
+	bool bPartsChanged = false;
+	bool bListChanged = false;
+
+	for (const FRobotEvent& Event : Events)
+	{
+		if (OwnerActor && Event.Instigator == OwnerActor)
+		{
+			CurrentPart = Event.Part;
+		}
+
+		if (Event.Type == ERobotEventType::HoverChanged || !IsValid(Event.Part))
+		{
+			continue;
+		}
+
+		// Parked parts leave the list and come back when the pool hands them out again
+		if (Event.Part->IsPooled())
+		{
+			bListChanged |= RemoveItem(Event.Part);
+		}
+		else if (UpdateItem(Event.Part))
+		{
+			bPartsChanged = true;
+		}
+		else if (Event.Type == ERobotEventType::StateChanged)
+		{
+			AddItem(Event.Part);
+			bListChanged = true;
+		}
+		else
+		{
+			RequestRebuild();
+		}
+	}
+
+	if (bListChanged)
+	{
+		ListView->RequestListRefresh();
+	}
+	if (bPartsChanged || bListChanged)
+	{
+		RefreshSummary();
+	}
+	RefreshCurrent();
+}
+
+void SRobotStatusPanel::HandleActorSpawned(AActor* Actor)
+{
+	if (Actor->IsA<AAttachablePart>())
+	{
+		RequestRebuild();
+	}
+}
+
+void SRobotStatusPanel::HandleActorDestroyed(AActor* Actor)
+{
+	if (const AAttachablePart* Part = Cast<AAttachablePart>(Actor))
+	{
+		if (ItemIndices.Contains(Part))
+		{
+			RequestRebuild();
+		}
+	}
+}
+
+void SRobotStatusPanel::RequestRebuild()
+{
+	// A spawner adds thousands of parts in one frame, rebuild once on the next Slate tick
+	if (bRebuildPending)
+	{
+		return;
+	}
+
+	bRebuildPending = true;
+	RegisterActiveTimer(0.0f, FWidgetActiveTimerDelegate::CreateLambda([this](double, float)
+	{
+		if (bRebuildPending)
+		{
+			RebuildItems();
+			RefreshCurrent();
+		}
+		return EActiveTimerReturnType::Stop;
+	}));
+}
+
+void SRobotStatusPanel::RefreshSummary()
+{
+	SummaryText->SetText(FText::Format(LOCTEXT("Summary", "{0} parts: {1} attached, {2} held, {3} detached"),
+		Items.Num(),
+		StateCounts[(int32)EPartState::ATTACHED],
+		StateCounts[(int32)EPartState::HELD],
+		StateCounts[(int32)EPartState::DETACHED]));
+}
+
+void SRobotStatusPanel::RefreshCurrent()
+{
+	const AAttachablePart* Part = CurrentPart.Get();
+	if (!Part)
+	{
+		CurrentText->SetText(LOCTEXT("NoPart", "No part selected"));
+		return;
+	}
+
+	const int32* Index = ItemIndices.Find(Part);
+	const FText& Name = Index ? Items[*Index]->Name : FText::GetEmpty();
+	CurrentText->SetText(FText::Format(LOCTEXT("CurrentPart", "{0}: {1}"), Name, AAttachablePart::GetStateDisplayText(Part->CurrentState)));
+}
+
+#undef LOCTEXT_NAMESPACE
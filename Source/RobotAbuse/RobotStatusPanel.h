@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttachablePart.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+
+class STextBlock;
+class UAttachmentPoint;
+struct FRobotEvent;
+
+/** One row of the status panel, refreshed when its part changes */
+struct FRobotStatusItem
+{
+	TWeakObjectPtr<AAttachablePart> Part;
+	TWeakObjectPtr<UAttachmentPoint> Point;
+	FText Name;
+	FText Socket;
+	EPartState State = EPartState::DETACHED;
+};
+
+typedef TSharedPtr<FRobotStatusItem> FRobotStatusItemPtr;
+
+/**
+ * Native fleet status view: the part the owning pawn last touched, per-state totals, and every part
+ * in the world in a virtualized list, so only the visible rows have widgets.
+ * Nothing polls. Rows, totals and the current part line are rewritten from URobotEventBus events,
+ * and the list is rebuilt once after parts spawn or are destroyed. Everything sits in an
+ * invalidation panel, an idle panel costs no layout or paint work.
+ */
+class ROBOTABUSE_API SRobotStatusPanel : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SRobotStatusPanel)
+		: _World(nullptr)
+		, _Owner(nullptr)
+	{}
+		SLATE_ARGUMENT(UWorld*, World)
+
+		/** Pawn whose hovers and clicks pick the current part */
+		SLATE_ARGUMENT(AActor*, Owner)
+	SLATE_END_ARGS()
+
+	virtual ~SRobotStatusPanel() override;
+
+	void Construct(const FArguments& InArgs);
+
+	/** Whether players get the panel, see robot.UI.StatusPanel */
+	static bool IsEnabled();
+
+	int32 GetNumItems() const { return Items.Num(); }
+	int32 GetNumInState(EPartState State) const { return StateCounts[(int32)State]; }
+
+	/** Rebuild now instead of on the next Slate tick */
+	void RebuildItems();
+
+private:
+	TSharedRef<ITableRow> GenerateRow(FRobotStatusItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable);
+
+	void HandleRobotEvents(TConstArrayView<FRobotEvent> Events);
+	void HandleActorSpawned(AActor* Actor);
+	void HandleActorDestroyed(AActor* Actor);
+
+	// Read Part's state into its row. False if the part has no row yet
+	bool UpdateItem(const AAttachablePart* Part);
+
+	// Rows for parts leaving and coming back from URobotPartPool
+	void AddItem(AAttachablePart* Part);
+	bool RemoveItem(const AAttachablePart* Part);
+	static void ReadItem(FRobotStatusItem& Item, const AAttachablePart* Part);
+
+	void RequestRebuild();
+	void RefreshSummary();
+	void RefreshCurrent();
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<AActor> Owner;
+	TWeakObjectPtr<AAttachablePart> CurrentPart;
+
+	TArray<FRobotStatusItemPtr> Items;
+	TMap<const AAttachablePart*, int32> ItemIndices;
+	int32 StateCounts[3] = {};
+
+	TSharedPtr<SListView<FRobotStatusItemPtr>> ListView;
+	TSharedPtr<STextBlock> SummaryText;
+	TSharedPtr<STextBlock> CurrentText;
+
+	bool bRebuildPending = false;
+
+	FDelegateHandle RobotEventsHandle;
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+};
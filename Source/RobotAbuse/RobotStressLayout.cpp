@@ -0,0 +1,149 @@
+#include "RobotStressLayout.h"
+#include "AttachmentPoint.h"
+#include "RobotTorso.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+void URobotStressLayout::Generate(const FRobotStressParams& InParams)
+{
+	Params = InParams;
+	Robots.Reset(Params.NumRobots);
+
+	// Everything below comes from the seed, so the same params always give the same scene
+	FRandomStream Random(Params.Seed);
+
+	const float TotalWeight = FMath::Max(Params.LeftWeight, 0.0f) + FMath::Max(Params.RightWeight, 0.0f) + FMath::Max(Params.UniversalWeight, 0.0f);
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(FMath::Max(Params.NumRobots, 1))));
+
+	for (int32 RobotIndex = 0; RobotIndex < Params.NumRobots; RobotIndex++)
+	{
+		FRobotStressRobot& Robot = Robots.AddDefaulted_GetRef();
+		Robot.Transform.SetLocation(FVector((RobotIndex % GridSize) * Params.Spacing, (RobotIndex / GridSize) * Params.Spacing, 100.0f));
+		Robot.Sockets.Reserve(Params.SocketsPerRobot);
+
+		for (int32 SocketIndex = 0; SocketIndex < Params.SocketsPerRobot; SocketIndex++)
+		{
+			// Sockets alternate between the two sides and stack upwards, like the arms on BP_Robot
+			const bool bLeftSide = SocketIndex % 2 == 0;
+
+			FRobotStressSocket& Socket = Robot.Sockets.AddDefaulted_GetRef();
+			Socket.RelativeLocation = FVector(0.0f, bLeftSide ? -60.0f : 60.0f, 20.0f * (SocketIndex / 2));
+			Socket.bAttached = Random.FRand() < Params.AttachedRatio;
+
+			if (TotalWeight <= 0.0f)
+			{
+				Socket.AcceptedArmType = bLeftSide ? EArmType::Left : EArmType::Right;
+				continue;
+			}
+
+			const float Pick = Random.FRand() * TotalWeight;
+			if (Pick < Params.LeftWeight)
+			{
+				Socket.AcceptedArmType = EArmType::Left;
+			}
+			else if (Pick < Params.LeftWeight + Params.RightWeight)
+			{
+				Socket.AcceptedArmType = EArmType::Right;
+			}
+			else
+			{
+				Socket.AcceptedArmType = EArmType::Universal;
+			}
+		}
+	}
+}
+
+int32 URobotStressLayout::GetNumSockets() const
+{
+	int32 NumSockets = 0;
+	for (const FRobotStressRobot& Robot : Robots)
+	{
+		NumSockets += Robot.Sockets.Num();
+	}
+	return NumSockets;
+}
+
+void FRobotStressMeshes::LoadDefaults()
+{
+	if (!Robot)
+	{
+		Robot = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	}
+
+	if (!Part)
+	{
+		Part = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	}
+
+	if (!SocketVisual)
+	{
+		SocketVisual = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+	}
+}
+
+FRobotStressAssembly RobotStress::SpawnRobotAssembly(UWorld* World, const FRobotStressRobot& Robot, const FRobotStressMeshes& Meshes,
+	TSubclassOf<ARobotTorso> RobotClass, TSubclassOf<AAttachablePart> PartClass)
+{
+	FRobotStressAssembly Assembly;
+
+	UClass* TorsoClass = RobotClass ? RobotClass.Get() : ARobotTorso::StaticClass();
+	UClass* ArmClass = PartClass ? PartClass.Get() : AAttachablePart::StaticClass();
+
+	Assembly.Robot = World->SpawnActor<ARobotTorso>(TorsoClass, Robot.Transform);
+	if (!Assembly.Robot)
+	{
+		return Assembly;
+	}
+
+	UStaticMeshComponent* RobotMesh = Cast<UStaticMeshComponent>(Assembly.Robot->GetRootComponent());
+	if (RobotMesh && !RobotMesh->GetStaticMesh())
+	{
+		RobotMesh->SetStaticMesh(Meshes.Robot);
+	}
+
+	Assembly.Points.Reserve(Robot.Sockets.Num());
+	Assembly.Parts.Reserve(Robot.Sockets.Num());
+
+	for (const FRobotStressSocket& Socket : Robot.Sockets)
+	{
+		UAttachmentPoint* Point = NewObject<UAttachmentPoint>(Assembly.Robot);
+		Point->AcceptedArmType = Socket.AcceptedArmType;
+		Point->SetupAttachment(Assembly.Robot->GetRootComponent());
+		Point->SetRelativeLocation(Socket.RelativeLocation);
+		Assembly.Robot->AddInstanceComponent(Point);
+
+		// The sphere the player clicks on, found by the point as its first mesh child
+		UStaticMeshComponent* Visual = NewObject<UStaticMeshComponent>(Assembly.Robot);
+		Visual->SetStaticMesh(Meshes.SocketVisual);
+		Visual->SetupAttachment(Point);
+		Visual->SetRelativeScale3D(FVector(0.2f));
+		Assembly.Robot->AddInstanceComponent(Visual);
+
+		Point->RegisterComponent();
+		Visual->RegisterComponent();
+		Assembly.Points.Add(Point);
+
+		const FVector PartLocation = Robot.Transform.TransformPosition(Socket.RelativeLocation * 2.0f);
+		AAttachablePart* Part = World->SpawnActor<AAttachablePart>(ArmClass, PartLocation, FRotator::ZeroRotator);
+		if (Part)
+		{
+			// A universal socket still gets a real arm, alternate sides so both kinds exist
+			Part->ArmType = Socket.AcceptedArmType != EArmType::Universal ? Socket.AcceptedArmType
+				: (Assembly.Parts.Num() % 2 == 0 ? EArmType::Left : EArmType::Right);
+
+			if (UStaticMeshComponent* PartMesh = Part->GetMeshComponent())
+			{
+				if (!PartMesh->GetStaticMesh())
+				{
+					PartMesh->SetStaticMesh(Meshes.Part);
+					PartMesh->SetRelativeScale3D(FVector(0.5f, 0.2f, 0.2f));
+				}
+			}
+		}
+
+		Assembly.Parts.Add(Part);
+	}
+
+	return Assembly;
+}
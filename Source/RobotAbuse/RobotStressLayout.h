@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "AttachablePart.h"
+#include "RobotStressLayout.generated.h"
+
+class ARobotTorso;
+class UAttachmentPoint;
+class UStaticMesh;
+
+/** Knobs for a generated stress scene. Stored in the layout so a scene can be regenerated exactly */
+USTRUCT(BlueprintType)
+struct FRobotStressParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	int32 NumRobots = 100;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	int32 SocketsPerRobot = 2;
+
+	/** Fraction of sockets that start with an arm attached, the other arms lie next to their robot */
+	UPROPERTY(EditAnywhere, Category = "Stress", meta = (ClampMin = "0", ClampMax = "1"))
+	float AttachedRatio = 1.0f;
+
+	/** Relative weights of the socket types, arms always match the socket they were made for */
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	float LeftWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	float RightWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	float UniversalWeight = 0.0f;
+
+	/** Distance between robots on the square grid */
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	float Spacing = 300.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	int32 Seed = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FRobotStressSocket
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	FVector RelativeLocation = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	EArmType AcceptedArmType = EArmType::Universal;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	bool bAttached = true;
+};
+
+USTRUCT(BlueprintType)
+struct FRobotStressRobot
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	FTransform Transform;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	TArray<FRobotStressSocket> Sockets;
+};
+
+/**
+ * A reproducible benchmark scene: a grid of robot assemblies with their sockets and arms.
+ * Written by the RobotStressMap commandlet, spawned by ARobotStressSpawner in a level or by
+ * FRobotTestWorld in automation tests, so profiling and perf tests look at the same scene.
+ */
+UCLASS(BlueprintType)
+class ROBOTABUSE_API URobotStressLayout : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Replace the robots with a fresh grid built from InParams */
+	void Generate(const FRobotStressParams& InParams);
+
+	int32 GetNumSockets() const;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress")
+	FRobotStressParams Params;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress")
+	TArray<FRobotStressRobot> Robots;
+};
+
+/** Meshes an assembly is built from. Missing ones fall back to the engine basic shapes */
+struct ROBOTABUSE_API FRobotStressMeshes
+{
+	UStaticMesh* Robot = nullptr;
+	UStaticMesh* Part = nullptr;
+	UStaticMesh* SocketVisual = nullptr;
+
+	void LoadDefaults();
+};
+
+/** What SpawnRobotAssembly created, parts in socket order */
+struct ROBOTABUSE_API FRobotStressAssembly
+{
+	ARobotTorso* Robot = nullptr;
+	TArray<UAttachmentPoint*> Points;
+	TArray<AAttachablePart*> Parts;
+};
+
+namespace RobotStress
+{
+	/**
+	 * Spawn one robot with its sockets, socket visuals and one matching arm per socket, the BP_Robot
+	 * equivalent in code. Arms are placed next to the robot; attaching the ones marked bAttached is left
+	 * to the caller, since it only works once play has begun.
+	 */
+	ROBOTABUSE_API FRobotStressAssembly SpawnRobotAssembly(UWorld* World, const FRobotStressRobot& Robot, const FRobotStressMeshes& Meshes,
+		TSubclassOf<ARobotTorso> RobotClass = nullptr, TSubclassOf<AAttachablePart> PartClass = nullptr);
+}
@@ -0,0 +1,119 @@
+#include "RobotStressMapCommandlet.h"
+#include "RobotAbuse.h"
+#include "RobotStressLayout.h"
+#include "RobotStressSpawner.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+URobotStressMapCommandlet::URobotStressMapCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+#if WITH_EDITOR
+
+namespace
+{
+	bool SaveAsset(UPackage* Package, UObject* Asset, const FString& Extension)
+	{
+		Package->MarkPackageDirty();
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		SaveArgs.Error = GError;
+
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+		if (!UPackage::SavePackage(Package, Asset, *Filename, SaveArgs))
+		{
+			UE_LOG(LogRobotAbuse, Error, TEXT("Failed to save %s"), *Filename);
+			return false;
+		}
+
+		UE_LOG(LogRobotAbuse, Display, TEXT("Saved %s"), *Filename);
+		return true;
+	}
+}
+
+int32 URobotStressMapCommandlet::Main(const FString& Params)
+{
+	FRobotStressParams StressParams;
+	FParse::Value(*Params, TEXT("Robots="), StressParams.NumRobots);
+	FParse::Value(*Params, TEXT("Sockets="), StressParams.SocketsPerRobot);
+	FParse::Value(*Params, TEXT("Attached="), StressParams.AttachedRatio);
+	FParse::Value(*Params, TEXT("Left="), StressParams.LeftWeight);
+	FParse::Value(*Params, TEXT("Right="), StressParams.RightWeight);
+	FParse::Value(*Params, TEXT("Universal="), StressParams.UniversalWeight);
+	FParse::Value(*Params, TEXT("Spacing="), StressParams.Spacing);
+	FParse::Value(*Params, TEXT("Seed="), StressParams.Seed);
+
+	FString PackagePath = TEXT("/Game/Benchmarks");
+	FParse::Value(*Params, TEXT("Path="), PackagePath);
+
+	FString AssetName = FString::Printf(TEXT("StressLayout_%d"), StressParams.NumRobots);
+	FParse::Value(*Params, TEXT("Name="), AssetName);
+
+	if (StressParams.NumRobots <= 0 || StressParams.SocketsPerRobot < 0)
+	{
+		UE_LOG(LogRobotAbuse, Error, TEXT("Robots must be positive and Sockets must not be negative"));
+		return 1;
+	}
+
+	const FString LayoutPackageName = PackagePath / AssetName;
+	if (!FPackageName::IsValidLongPackageName(LayoutPackageName))
+	{
+		UE_LOG(LogRobotAbuse, Error, TEXT("%s is not a valid package name"), *LayoutPackageName);
+		return 1;
+	}
+
+	UPackage* LayoutPackage = CreatePackage(*LayoutPackageName);
+	URobotStressLayout* Layout = NewObject<URobotStressLayout>(LayoutPackage, *AssetName, RF_Public | RF_Standalone);
+	Layout->Generate(StressParams);
+
+	UE_LOG(LogRobotAbuse, Display, TEXT("Generated %d robots with %d sockets"), Layout->Robots.Num(), Layout->GetNumSockets());
+
+	if (!SaveAsset(LayoutPackage, Layout, FPackageName::GetAssetPackageExtension()))
+	{
+		return 1;
+	}
+
+	if (!FParse::Param(*Params, TEXT("Map")))
+	{
+		return 0;
+	}
+
+	// The map only holds the spawner, the layout stays the single source of the scene
+	const FString MapName = AssetName + TEXT("_Map");
+	UPackage* MapPackage = CreatePackage(*(PackagePath / MapName));
+	UWorld* World = UWorld::CreateWorld(EWorldType::Inactive, false, *MapName, MapPackage);
+	World->SetFlags(RF_Public | RF_Standalone);
+
+	ARobotStressSpawner* Spawner = World->SpawnActor<ARobotStressSpawner>();
+	Spawner->Layout = Layout;
+
+	// Start above the middle of the grid so the whole scene is in view
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(StressParams.NumRobots)));
+	const float Extent = GridSize * StressParams.Spacing;
+	World->SpawnActor<APlayerStart>(FVector(-0.25f * Extent, 0.5f * Extent, 0.5f * Extent), FRotator(-35.0f, 0.0f, 0.0f));
+
+	const bool bSaved = SaveAsset(MapPackage, World, FPackageName::GetMapPackageExtension());
+
+	World->DestroyWorld(false);
+
+	return bSaved ? 0 : 1;
+}
+
+#else
+
+int32 URobotStressMapCommandlet::Main(const FString& Params)
+{
+	UE_LOG(LogRobotAbuse, Error, TEXT("RobotStressMap needs an editor build"));
+	return 1;
+}
+
+#endif // WITH_EDITOR
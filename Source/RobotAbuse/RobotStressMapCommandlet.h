@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RobotStressMapCommandlet.generated.h"
+
+/**
+ * Writes a URobotStressLayout asset, and optionally a map that spawns it, for benchmarks and profiling.
+ *
+ * UnrealEditor-Cmd RobotTraining.uproject -run=RobotStressMap -Robots=1000 -Sockets=2 -Attached=0.5
+ *     -Left=1 -Right=1 -Universal=0 -Spacing=300 -Seed=0 -Path=/Game/Benchmarks -Name=StressLayout_1000 -Map
+ */
+UCLASS()
+class URobotStressMapCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URobotStressMapCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
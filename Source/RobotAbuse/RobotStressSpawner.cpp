@@ -0,0 +1,125 @@
+#include "RobotStressSpawner.h"
+#include "RobotAbuse.h"
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "RobotAssetPreloader.h"
+#include "RobotStressLayout.h"
+#include "RobotTorso.h"
+#include "Components/SceneComponent.h"
+#include "HAL/PlatformTime.h"
+#include "TimerManager.h"
+
+ARobotStressSpawner::ARobotStressSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void ARobotStressSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Spawned robots and parts replicate, clients would only build a second copy
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	if (!Layout)
+	{
+		UE_LOG(LogRobotAbuse, Warning, TEXT("%s has no stress layout to spawn"), *GetName());
+		return;
+	}
+
+	if (URobotStartupTracker* Startup = UWorld::GetSubsystem<URobotStartupTracker>(GetWorld()))
+	{
+		Startup->BeginWork();
+		bStartupWorkPending = true;
+	}
+
+	TArray<FSoftObjectPath> ToLoad;
+	for (const FSoftObjectPath& Path : { RobotClass.ToSoftObjectPath(), PartClass.ToSoftObjectPath(),
+		RobotMesh.ToSoftObjectPath(), PartMesh.ToSoftObjectPath(), SocketVisualMesh.ToSoftObjectPath() })
+	{
+		if (Path.IsValid() && !Path.ResolveObject())
+		{
+			ToLoad.Add(Path);
+		}
+	}
+
+	if (ToLoad.Num() == 0)
+	{
+		SpawnLayout();
+		return;
+	}
+
+	LoadHandle = RobotAssets::LoadAsync(MoveTemp(ToLoad), FStreamableDelegate::CreateUObject(this, &ARobotStressSpawner::SpawnLayout), GetName());
+}
+
+void ARobotStressSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (LoadHandle.IsValid())
+	{
+		LoadHandle->CancelHandle();
+		LoadHandle.Reset();
+	}
+	EndStartupWork();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ARobotStressSpawner::SpawnLayout()
+{
+	ROBOT_TRACE_SCOPE("RobotAbuse::StressSpawn");
+	const double Start = FPlatformTime::Seconds();
+
+	FRobotStressMeshes Meshes;
+	Meshes.Robot = RobotMesh.Get();
+	Meshes.Part = PartMesh.Get();
+	Meshes.SocketVisual = SocketVisualMesh.Get();
+	Meshes.LoadDefaults();
+
+	for (const FRobotStressRobot& Robot : Layout->Robots)
+	{
+		const FRobotStressAssembly Assembly = RobotStress::SpawnRobotAssembly(GetWorld(), Robot, Meshes, RobotClass.Get(), PartClass.Get());
+
+		for (int32 SocketIndex = 0; SocketIndex < Assembly.Parts.Num(); SocketIndex++)
+		{
+			if (Assembly.Parts[SocketIndex] && Robot.Sockets[SocketIndex].bAttached)
+			{
+				PendingAttaches.Attach(Assembly.Parts[SocketIndex], Assembly.Points[SocketIndex]);
+			}
+		}
+	}
+
+	// Actors spawned during the level's BeginPlay only start play after this one, attach once they all have.
+	// After a background load they already have, the timer keeps both paths the same
+	GetWorldTimerManager().SetTimerForNextTick(this, &ARobotStressSpawner::AttachInitialParts);
+
+	UE_LOG(LogRobotAbuse, Log, TEXT("Spawned stress layout %s: %d robots, %d sockets in %.1f ms"),
+		*Layout->GetName(), Layout->Robots.Num(), Layout->GetNumSockets(), (FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+void ARobotStressSpawner::AttachInitialParts()
+{
+	const int32 NumAttached = PendingAttaches.Commit(GetWorld());
+	UE_LOG(LogRobotAbuse, Log, TEXT("Stress layout attached %d of %d arms"), NumAttached, PendingAttaches.Num());
+	PendingAttaches.Reset();
+
+	EndStartupWork();
+}
+
+void ARobotStressSpawner::EndStartupWork()
+{
+	if (!bStartupWorkPending)
+	{
+		return;
+	}
+
+	bStartupWorkPending = false;
+	if (URobotStartupTracker* Startup = UWorld::GetSubsystem<URobotStartupTracker>(GetWorld()))
+	{
+		Startup->EndWork();
+	}
+}
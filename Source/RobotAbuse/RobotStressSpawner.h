@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AttachmentTransaction.h"
+#include "RobotStressSpawner.generated.h"
+
+struct FStreamableHandle;
+
+class AAttachablePart;
+class ARobotTorso;
+class URobotStressLayout;
+class UStaticMesh;
+
+/**
+ * Spawns every robot of a URobotStressLayout when play begins and attaches the arms the layout
+ * marks as attached. Stress maps written by the RobotStressMap commandlet contain just one of these.
+ * The classes and meshes are soft references streamed in after BeginPlay, the map counts as
+ * interactive for URobotStartupTracker once the arms are attached.
+ */
+UCLASS()
+class ROBOTABUSE_API ARobotStressSpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ARobotStressSpawner();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	URobotStressLayout* Layout;
+
+	/** Robot and arm classes, a Blueprint robot works as long as its root is a static mesh */
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	TSoftClassPtr<ARobotTorso> RobotClass;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	TSoftClassPtr<AAttachablePart> PartClass;
+
+	/** Used where the classes bring no mesh of their own, engine basic shapes if empty */
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	TSoftObjectPtr<UStaticMesh> RobotMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	TSoftObjectPtr<UStaticMesh> PartMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Stress")
+	TSoftObjectPtr<UStaticMesh> SocketVisualMesh;
+
+private:
+	void SpawnLayout();
+	void AttachInitialParts();
+	void EndStartupWork();
+
+	TSharedPtr<FStreamableHandle> LoadHandle;
+	bool bStartupWorkPending = false;
+
+	// Initial arms, committed in one batch on the first tick
+	FAttachmentTransaction PendingAttaches;
+};
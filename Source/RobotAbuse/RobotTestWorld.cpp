@@ -0,0 +1,121 @@
+#include "RobotTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "RobotTorso.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "UObject/UObjectGlobals.h"
+
+FRobotTestWorld::FRobotTestWorld()
+{
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("RobotTestWorld"));
+
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+
+	Meshes.LoadDefaults();
+}
+
+FRobotTestWorld::~FRobotTestWorld()
+{
+	if (!World)
+	{
+		return;
+	}
+
+	// Destroying goes through EndPlay, so the parts and sockets leave the subsystems the normal way
+	for (AAttachablePart* Part : Parts)
+	{
+		if (IsValid(Part))
+		{
+			Part->Destroy();
+		}
+	}
+
+	for (ARobotTorso* Robot : Robots)
+	{
+		if (IsValid(Robot))
+		{
+			Robot->Destroy();
+		}
+	}
+
+	World->BeginTearingDown();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	World = nullptr;
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void FRobotTestWorld::Populate(const FRobotStressParams& Params)
+{
+	URobotStressLayout* Layout = NewObject<URobotStressLayout>();
+	Layout->Generate(Params);
+	Populate(*Layout);
+}
+
+void FRobotTestWorld::Populate(const URobotStressLayout& Layout)
+{
+	const int32 NumSockets = Layout.GetNumSockets();
+	Robots.Reserve(Robots.Num() + Layout.Robots.Num());
+	Points.Reserve(Points.Num() + NumSockets);
+	Parts.Reserve(Parts.Num() + NumSockets);
+	HomePoints.Reserve(HomePoints.Num() + NumSockets);
+
+	for (const FRobotStressRobot& RobotLayout : Layout.Robots)
+	{
+		FRobotStressAssembly Assembly = RobotStress::SpawnRobotAssembly(World, RobotLayout, Meshes);
+		if (!Assembly.Robot)
+		{
+			continue;
+		}
+
+		Robots.Add(Assembly.Robot);
+		Points.Append(Assembly.Points);
+
+		for (int32 SocketIndex = 0; SocketIndex < Assembly.Parts.Num(); SocketIndex++)
+		{
+			if (!Assembly.Parts[SocketIndex])
+			{
+				continue;
+			}
+
+			if (RobotLayout.Sockets[SocketIndex].bAttached)
+			{
+				InitiallyAttached.Add(Parts.Num());
+			}
+
+			Parts.Add(Assembly.Parts[SocketIndex]);
+			HomePoints.Add(Assembly.Points[SocketIndex]);
+		}
+	}
+}
+
+void FRobotTestWorld::BeginPlay()
+{
+	if (!World->HasBegunPlay())
+	{
+		World->GetWorldSettings()->NotifyBeginPlay();
+	}
+
+	for (int32 PartIndex : InitiallyAttached)
+	{
+		Parts[PartIndex]->TryAttachTo_Implementation(HomePoints[PartIndex]);
+	}
+	InitiallyAttached.Reset();
+}
+
+void FRobotTestWorld::Tick(float DeltaTime)
+{
+	World->Tick(LEVELTICK_All, DeltaTime);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "RobotStressLayout.h"
+
+class AAttachablePart;
+class ARobotTorso;
+class UAttachmentPoint;
+class UWorld;
+
+/**
+ * Standalone game world filled with robots, sockets and arms for automation and benchmark tests.
+ * Scenes come from a URobotStressLayout, either a saved one or one generated on the fly, and are
+ * spawned with engine basic shapes so everything runs under -nullrhi without project content.
+ * The world is destroyed with the helper.
+ */
+class ROBOTABUSE_API FRobotTestWorld
+{
+public:
+	FRobotTestWorld();
+	~FRobotTestWorld();
+
+	FRobotTestWorld(const FRobotTestWorld&) = delete;
+	FRobotTestWorld& operator=(const FRobotTestWorld&) = delete;
+
+	/** Spawn the robots, sockets and parts. Call before BeginPlay so startup can be measured on its own */
+	void Populate(const FRobotStressParams& Params);
+	void Populate(const URobotStressLayout& Layout);
+
+	/** Dispatch BeginPlay to everything spawned so far and attach the initial arms */
+	void BeginPlay();
+
+	void Tick(float DeltaTime);
+
+	UWorld* GetWorld() const { return World; }
+
+	const TArray<ARobotTorso*>& GetRobots() const { return Robots; }
+	const TArray<UAttachmentPoint*>& GetPoints() const { return Points; }
+	const TArray<AAttachablePart*>& GetParts() const { return Parts; }
+
+	/** Socket each part was spawned for, same order as GetParts */
+	const TArray<UAttachmentPoint*>& GetHomePoints() const { return HomePoints; }
+
+private:
+	UWorld* World = nullptr;
+	FRobotStressMeshes Meshes;
+
+	TArray<ARobotTorso*> Robots;
+	TArray<UAttachmentPoint*> Points;
+	TArray<AAttachablePart*> Parts;
+	TArray<UAttachmentPoint*> HomePoints;
+
+	// Parts that get attached once play has begun
+	TArray<int32> InitiallyAttached;
+};
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -1,13 +1,24 @@
 ﻿#include "RobotTorso.h"
+#include "RobotAbuse.h"
 
 #include "AttachablePart.h"
+#include "AttachmentPoint.h"
+#include "AttachmentRegistry.h"
+#include "RobotDefinitions.h"
+#include "RobotHighlight.h"
+#include "RobotStressLayout.h"
 #include "Components/StaticMeshComponent.h"
-#include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
 
 ARobotTorso::ARobotTorso()
 {
 	PrimaryActorTick.bCanEverTick = false;
 
+	// Parts in a multi-user session name their socket by robot, so spawned robots must resolve on clients.
+	// Only nearby ones need to, robots further than NetCullDistanceSquared are left out along with their parts
+	bReplicates = true;
+
 	RootMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("RootMesh"));
 	RootComponent = RootMesh;
 }
@@ -19,68 +30,132 @@ void ARobotTorso::BeginPlay()
 	SetEmissiveIncludingAttachedParts(NormalEmissive);
 }
 
-void ARobotTorso::SetupMaterials()
+void ARobotTorso::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	DynamicMaterials.Empty();
-    
-	// Get all mesh components
-	TArray<UStaticMeshComponent*> MeshComponents;
-	GetComponents<UStaticMeshComponent>(MeshComponents);
-    
-	for (UStaticMeshComponent* Mesh : MeshComponents)
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ARobotTorso, Definition, COND_InitialOnly);
+}
+
+void ARobotTorso::PostNetInit()
+{
+	// Sockets are instance components and never replicate, build them before they would begin play with the robot
+	BuildFromReplicatedDefinition();
+
+	Super::PostNetInit();
+}
+
+void ARobotTorso::OnRep_Definition()
+{
+	// An asset the client had not loaded resolves later, PostNetInit has passed by then
+	if (IsActorInitialized())
 	{
-		if (Mesh)
-		{
-			for (int32 i = 0; i < Mesh->GetNumMaterials(); i++)
-			{
-				UMaterialInterface* BaseMat = Mesh->GetMaterial(i);
-				if (BaseMat)
-				{
-					UMaterialInstanceDynamic* DynMat = UMaterialInstanceDynamic::Create(BaseMat, this);
-					Mesh->SetMaterial(i, DynMat);
-					DynamicMaterials.Add(DynMat);
-				}
-			}
-		}
+		BuildFromReplicatedDefinition();
 	}
 }
 
-void ARobotTorso::SetEmissive(float Value)
+void ARobotTorso::BuildFromReplicatedDefinition()
 {
-	for (UMaterialInstanceDynamic* Mat : DynamicMaterials)
+	if (!Definition || bBuiltFromDefinition)
 	{
-		if (Mat)
+		return;
+	}
+
+	FRobotStressMeshes DefaultMeshes;
+	DefaultMeshes.LoadDefaults();
+
+	// Registering after the robot began play begins play for the sockets too
+	TArray<UAttachmentPoint*, TInlineAllocator<4>> Points;
+	BuildFromDefinition(*Definition, DefaultMeshes, Points);
+}
+
+void ARobotTorso::BuildFromDefinition(const URobotDefinition& InDefinition, const FRobotStressMeshes& DefaultMeshes, TArray<UAttachmentPoint*, TInlineAllocator<4>>& OutPoints)
+{
+	Definition = &InDefinition;
+	bBuiltFromDefinition = true;
+
+	if (!RootMesh->GetStaticMesh())
+	{
+		UStaticMesh* Mesh = InDefinition.Mesh.Get();
+		RootMesh->SetStaticMesh(Mesh ? Mesh : DefaultMeshes.Robot);
+	}
+
+	UStaticMesh* SocketMesh = InDefinition.SocketVisualMesh.Get();
+	if (!SocketMesh)
+	{
+		SocketMesh = DefaultMeshes.SocketVisual;
+	}
+
+	for (int32 Index = 0; Index < InDefinition.Sockets.Num(); Index++)
+	{
+		const FRobotSocketDefinition& Socket = InDefinition.Sockets[Index];
+
+		// Names are how the server and clients agree on a socket, a second one with the same name would replace the first
+		const FName PointName = InDefinition.GetSocketName(Index);
+		if (FindObjectFast<UObject>(this, PointName))
 		{
-			Mat->SetScalarParameterValue(EmissiveParameterName, Value);
+			UE_LOG(LogRobotAbuse, Warning, TEXT("%s: socket name %s is used twice, the second socket is skipped"), *InDefinition.GetName(), *PointName.ToString());
+			OutPoints.Add(nullptr);
+			continue;
 		}
+
+		UAttachmentPoint* Point = NewObject<UAttachmentPoint>(this, PointName);
+		Point->AcceptedArmType = Socket.AcceptedArmType;
+		Point->AcceptedCategories = Socket.AcceptedCategories;
+		Point->SetupAttachment(RootMesh);
+		Point->SetRelativeLocation(Socket.RelativeLocation);
+		AddInstanceComponent(Point);
+
+		UStaticMeshComponent* Visual = NewObject<UStaticMeshComponent>(this);
+		Visual->SetStaticMesh(SocketMesh);
+		Visual->SetupAttachment(Point);
+		Visual->SetRelativeScale3D(FVector(0.2f));
+		AddInstanceComponent(Visual);
+		Point->SetAttachmentVisual(Visual);
+
+		Point->RegisterComponent();
+		Visual->RegisterComponent();
+		OutPoints.Add(Point);
 	}
 }
 
+void ARobotTorso::SetupMaterials()
+{
+	RobotHighlight::CollectMeshes(this, EmissiveParameterName, HighlightMeshes);
+}
+
+void ARobotTorso::SetEmissive(float Value)
+{
+	RobotHighlight::SetEmissive(HighlightMeshes, EmissiveDataIndex, Value);
+}
+
 void ARobotTorso::SetEmissiveIncludingAttachedParts(float Value)
 {
+	ROBOT_TRACE_SCOPE("RobotAbuse::SetRobotEmissive");
+
 	// Set emissive on torso
 	SetEmissive(Value);
     
-	// Get all attached actors (the arms)
-	TArray<AActor*> AttachedActors;
-	GetAttachedActors(AttachedActors);
-    
-	for (AActor* AttachedActor : AttachedActors)
+	// Arms come straight from the registry instead of walking the attached actors
+	UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld());
+	if (!Registry)
 	{
-		// Check if it's an attachable part
-		if (AAttachablePart* Part = Cast<AAttachablePart>(AttachedActor))
+		return;
+	}
+
+	const bool bHighlight = Value > NormalEmissive;
+	Registry->ForEachPartOfRobot(this, [bHighlight](AAttachablePart* Part, UAttachmentPoint*)
+	{
+		// Tell the part to highlight itself
+		if (bHighlight)
 		{
-			// Tell the part to highlight itself
-			if (Value > NormalEmissive)
-			{
-				Part->OnHoverBegin_Implementation();
-			}
-			else
-			{
-				Part->OnHoverEnd_Implementation();
-			}
+			Part->OnHoverBegin_Implementation();
 		}
-	}
+		else
+		{
+			Part->OnHoverEnd_Implementation();
+		}
+	});
 }
 
 void ARobotTorso::OnHoverBegin_Implementation()
@@ -95,11 +170,21 @@ void ARobotTorso::OnHoverEnd_Implementation()
 
 void ARobotTorso::OnClicked_Implementation()
 {
+	// The whole robot is about to move, instanced arms would be left behind
+	if (UAttachmentRegistry* Registry = UWorld::GetSubsystem<UAttachmentRegistry>(GetWorld()))
+	{
+		Registry->ForEachPartOfRobot(this, [](AAttachablePart* Part, UAttachmentPoint*)
+		{
+			Part->PromoteFromFleet();
+		});
+	}
+
 	SetEmissiveIncludingAttachedParts(HighlightEmissive);
 }
 
 void ARobotTorso::OnDropped_Implementation()
 {
+	// Hover end lets each arm go back to the fleet once it is idle again
 	SetEmissiveIncludingAttachedParts(NormalEmissive);
 }
 
@@ -3,9 +3,14 @@
 #include "IClickable.h"
 #include "IDraggable.h"
 #include "IHoverable.h"
+#include "RobotHighlight.h"
 #include "GameFramework/Actor.h"
 #include "RobotTorso.generated.h"
 
+class UAttachmentPoint;
+class URobotDefinition;
+struct FRobotStressMeshes;
+
 UCLASS()
 class ROBOTABUSE_API ARobotTorso : public AActor, public IClickable, public IHoverable, public IDraggable
 {
@@ -15,6 +20,17 @@ public:
 	ARobotTorso();
 
 	virtual void BeginPlay() override;
+	virtual void PostNetInit() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/**
+	 * Set the mesh and add a socket component per socket of InDefinition, before the robot finishes spawning.
+	 * The definition replicates and clients build the same sockets from it. OutPoints follows the definition's
+	 * socket order, null where a socket was skipped because its name is taken
+	 */
+	void BuildFromDefinition(const URobotDefinition& InDefinition, const FRobotStressMeshes& DefaultMeshes, TArray<UAttachmentPoint*, TInlineAllocator<4>>& OutPoints);
+
+	const URobotDefinition* GetDefinition() const { return Definition; }
 	
 	virtual void OnHoverBegin_Implementation() override;
 	virtual void OnHoverEnd_Implementation() override;
@@ -27,7 +43,11 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UStaticMeshComponent* RootMesh;
 
-	// Visual config
+	// Visual config - custom primitive data slot the robot material reads its emissive strength from
+	UPROPERTY(EditAnywhere, Category = "Visual")
+	int32 EmissiveDataIndex = 0;
+
+	// Scalar parameter set through a dynamic material instance on materials not yet reading the slot above
 	UPROPERTY(EditAnywhere, Category = "Visual")
 	FName EmissiveParameterName = "EmissiveStrength";
 
@@ -39,7 +59,18 @@ protected:
 
 private:
 	UPROPERTY()
-	TArray<UMaterialInstanceDynamic*> DynamicMaterials;
+	FRobotHighlightMeshes HighlightMeshes;
+
+	// What the robot was built from, null for robots placed in the level or built in code
+	UPROPERTY(ReplicatedUsing = OnRep_Definition)
+	const URobotDefinition* Definition = nullptr;
+
+	bool bBuiltFromDefinition = false;
+
+	UFUNCTION()
+	void OnRep_Definition();
+
+	void BuildFromReplicatedDefinition();
 
 	void SetupMaterials();
 	void SetEmissive(float Value);